@@ -0,0 +1,451 @@
+#ifndef ANY_ANGLE_INCLUDE_GUARD_HPP
+#define ANY_ANGLE_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Any-angle planning on grids: Theta* and Lazy Theta* with line of sight traced through a packed
+/// occupancy bitmap, so paths run straight between cell centres instead of along 8 headings.
+
+#include "global_planner/grid_search.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace global
+{
+    /// \brief one bit per grid cell, set if the cell is blocked (Occupied or Inflation). Each row starts on a
+    /// new 64-bit word, so a run of cells along a row is tested a word at a time. A transposed copy does the
+    /// same for runs along a column, which steep segments are made of.
+    class OccupancyBits
+    {
+    public:
+        // \brief packs the cell types of a grid
+        // \param grid: any grid type exposing the grid index API
+        template<typename GridT>
+        explicit OccupancyBits(const GridT & grid)
+        {
+            const auto dims = grid.return_grid_dimensions();
+            width = dims.at(0);
+            height = dims.at(1);
+            stride = (width + 63) / 64;
+            words.assign(static_cast<size_t>(stride) * height, 0);
+            columns_stride = (height + 63) / 64;
+            columns.assign(static_cast<size_t>(columns_stride) * width, 0);
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    set(x, y, grid.celltype(x, y) != map::Free);
+                }
+            }
+        }
+
+        // \brief applies cell type changes
+        // \param changes: cells with updated celltype (eg: the return of Grid::update_grid)
+        void update(const std::vector<Cell> & changes)
+        {
+            for (const auto & cell : changes)
+            {
+                set(cell.index.x, cell.index.y, cell.celltype != map::Free);
+            }
+        }
+
+        // \returns whether a cell is blocked
+        bool blocked(const int & x, const int & y) const
+        {
+            return (words[static_cast<size_t>(y) * stride + (x >> 6)] >> (x & 63)) & 1ULL;
+        }
+
+        // \brief checks that the segment between two cell centres only crosses free cells. The walk is a
+        // supercover DDA: every cell the segment touches counts, including both cells beside a corner it
+        // passes through exactly.
+        // \param x0, y0: grid coordinates of the first cell
+        // \param x1, y1: grid coordinates of the second cell
+        // \returns true if every cell on the segment is free
+        bool line_of_sight(const int & x0, const int & y0, const int & x1, const int & y1) const
+        {
+            if (std::abs(y1 - y0) > std::abs(x1 - x0))
+            {
+                // Steep: walk the transposed bitmap, where the long runs are along its rows
+                return walk(columns, columns_stride, y0, x0, y1, x1);
+            }
+            return walk(words, stride, x0, y0, x1, y1);
+        }
+
+        // \returns the width and height of the grid in cells
+        std::vector<int> return_grid_dimensions() const
+        {
+            return {width, height};
+        }
+
+    private:
+        // \brief sets or clears the bit of a cell in both bitmaps
+        void set(const int & x, const int & y, const bool & value)
+        {
+            set_bit(words[static_cast<size_t>(y) * stride + (x >> 6)], x & 63, value);
+            set_bit(columns[static_cast<size_t>(x) * columns_stride + (y >> 6)], y & 63, value);
+        }
+
+        static void set_bit(uint64_t & word, const int & bit, const bool & value)
+        {
+            word = value ? (word | (1ULL << bit)) : (word & ~(1ULL << bit));
+        }
+
+        // \brief supercover DDA over a bitmap whose rows are along u (|u1 - u0| >= |v1 - v0|). The cells of each
+        // row form one run, found by solving for where the segment crosses into the next row, and tested a word
+        // at a time.
+        static bool walk(const std::vector<uint64_t> & bitmap, const int & row_words, const int & u0, const int & v0,
+                         const int & u1, const int & v1)
+        {
+            const long au = std::abs(u1 - u0);
+            const long av = std::abs(v1 - v0);
+            const int su = u1 > u0 ? 1 : -1;
+            const int sv = v1 > v0 ? 1 : -1;
+
+            int v = v0;
+            int run_start = u0;
+            for (long iv = 0; iv < av; iv++)
+            {
+                // First step along u whose cell border lies at or past the next row's border:
+                // smallest iu with (1 + 2 iu) av >= (1 + 2 iv) au
+                const long crossing = std::max(0L, ((1 + 2 * iv) * au - av + 2 * av - 1) / (2 * av));
+                int u = u0 + su * static_cast<int>(crossing);
+                int next_start = u;
+                if ((1 + 2 * crossing) * av == (1 + 2 * iv) * au)
+                {
+                    // Through a corner: the cell beside it in this row, then the one beside it in the next row
+                    u += su;
+                }
+                if (run_blocked(bitmap, row_words, v, run_start, u))
+                {
+                    return false;
+                }
+                run_start = next_start;
+                v += sv;
+            }
+            return !run_blocked(bitmap, row_words, v, run_start, u1);
+        }
+
+        // \returns whether any cell between ua and ub (in either order) on row v of a bitmap is blocked
+        static bool run_blocked(const std::vector<uint64_t> & bitmap, const int & row_words, const int & v,
+                                const int & ua, const int & ub)
+        {
+            const int lo = std::min(ua, ub);
+            const int hi = std::max(ua, ub);
+            const uint64_t * row = &bitmap[static_cast<size_t>(v) * row_words];
+            for (int w = lo >> 6; w <= hi >> 6; w++)
+            {
+                uint64_t mask = ~0ULL;
+                if (w == lo >> 6)
+                {
+                    mask &= ~0ULL << (lo & 63);
+                }
+                if (w == hi >> 6)
+                {
+                    mask &= ~0ULL >> (63 - (hi & 63));
+                }
+                if (row[w] & mask)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int width = 0;
+        int height = 0;
+        // Words per row
+        int stride = 0;
+        std::vector<uint64_t> words;
+        // Transposed bitmap: one row of words per grid column
+        int columns_stride = 0;
+        std::vector<uint64_t> columns;
+    };
+
+    /// \brief Theta* (Nash et al. 2007) or Lazy Theta* (Nash, Koenig and Tovey 2010) on any grid type exposing the
+    /// grid index API. Cells expand to their 8 neighbours like GridSearch, without cutting blocked corners, but a
+    /// neighbour in line of sight of the current cell's parent takes that parent directly, and edges cost the
+    /// Euclidean distance between centres.
+    /// Theta* checks line of sight on every relaxation. Lazy Theta* assumes it and checks once per expanded cell,
+    /// falling back to the best expanded neighbour as parent when it fails.
+    template<typename GridT>
+    class AnyAngleSearch
+    {
+    public:
+        // \param grid_: the grid to plan on. Must outlive this object.
+        // \param lazy_: use Lazy Theta* instead of Theta*
+        explicit AnyAngleSearch(const GridT & grid_, const bool & lazy_ = true) : grid(grid_), bits(grid_), lazy(lazy_)
+        {
+            const auto dims = grid.return_grid_dimensions();
+            width = dims.at(0);
+            height = dims.at(1);
+            if (width < 1 or height < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): AnyAngleSearch::AnyAngleSearch(const GridT & grid_, const bool & lazy_)");
+            }
+            resolution = grid.return_cell(0, 0).resolution;
+
+            const size_t size = static_cast<size_t>(width) * height;
+            gcost.resize(size);
+            parent.resize(size);
+            opened.assign(size, 0);
+            closed.assign(size, 0);
+        }
+
+        // \brief Plans a path on the grid.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \returns: the path as a vector of Nodes, one per turning point. If the goal is unreachable, the path to
+        // the closest expanded cell.
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal)
+        {
+            // A new stamp invalidates all previous search state without clearing the arrays
+            stamp++;
+            expansions = 0;
+            sight_checks = 0;
+            cost = std::numeric_limits<double>::infinity();
+
+            const Index s = grid.world2grid(Cell(start, resolution));
+            g = grid.world2grid(Cell(goal, resolution));
+            const int s_idx = map::grid2rowmajor(s.x, s.y, width);
+            const int g_idx = map::grid2rowmajor(g.x, g.y, width);
+
+            OpenList open_list;
+            gcost.at(s_idx) = 0.0;
+            parent.at(s_idx) = -1;
+            opened.at(s_idx) = stamp;
+            const double h0 = distance(s.x, s.y, g.x, g.y);
+            open_list.push(GridEntry{h0, h0, 0.0, s_idx, s.x, s.y});
+
+            // Fall back to the closest expanded cell if the goal is never reached
+            int best_idx = s_idx;
+            double best_h = h0;
+            bool found = false;
+
+            while (!open_list.empty())
+            {
+                const GridEntry current = open_list.top();
+                open_list.pop();
+
+                if (closed[current.idx] == stamp or current.gcost > gcost[current.idx])
+                {
+                    continue;
+                }
+                if (lazy)
+                {
+                    set_vertex(current);
+                }
+                closed[current.idx] = stamp;
+                expansions++;
+
+                if (current.hcost < best_h)
+                {
+                    best_h = current.hcost;
+                    best_idx = current.idx;
+                }
+
+                // END condition
+                if (current.idx == g_idx)
+                {
+                    if (verbose)
+                    {
+                        std::cout << "Goal found after " << expansions << " Iterations!" << std::endl;
+                    }
+                    cost = gcost[current.idx];
+                    found = true;
+                    break;
+                }
+
+                for (const auto & offset : map::OFFSETS_8)
+                {
+                    const int nx = current.x + offset.dx;
+                    const int ny = current.y + offset.dy;
+                    if (nx < 0 or nx >= width or ny < 0 or ny >= height or bits.blocked(nx, ny))
+                    {
+                        continue;
+                    }
+                    // Diagonal moves may not cut a blocked corner, so every parent link is in line of sight
+                    if (offset.dx != 0 and offset.dy != 0 and
+                        (bits.blocked(current.x + offset.dx, current.y) or bits.blocked(current.x, current.y + offset.dy)))
+                    {
+                        continue;
+                    }
+                    const int nidx = map::grid2rowmajor(nx, ny, width);
+                    if (closed[nidx] == stamp)
+                    {
+                        continue;
+                    }
+                    relax(current, nidx, nx, ny, open_list);
+                }
+            }
+
+            if (!found and verbose)
+            {
+                std::cout << "No valid path! returning most complete path" << std::endl;
+            }
+            return trace_path(found ? g_idx : best_idx);
+        }
+
+        // \brief applies cell type changes to the line of sight bitmap. Call after the grid changes.
+        // \param changes: cells with updated celltype (eg: the return of Grid::update_grid)
+        void update(const std::vector<Cell> & changes)
+        {
+            bits.update(changes);
+        }
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const
+        {
+            return cost;
+        }
+
+        // \returns the number of cells expanded by the last plan
+        int return_expansions() const
+        {
+            return expansions;
+        }
+
+        // \returns the number of line of sight checks made by the last plan
+        int return_sight_checks() const
+        {
+            return sight_checks;
+        }
+
+        // \brief turns the progress messages printed by each plan on or off (on by default)
+        void set_verbose(const bool & verbose_)
+        {
+            verbose = verbose_;
+        }
+
+    private:
+        using OpenList = std::priority_queue <GridEntry, std::vector<GridEntry>, GridEntryComparator >;
+
+        // \returns the Euclidean distance between two cells in world units
+        double distance(const int & x1, const int & y1, const int & x2, const int & y2) const
+        {
+            return std::hypot(static_cast<double>(x1 - x2), static_cast<double>(y1 - y2)) * resolution;
+        }
+
+        // \brief counted line of sight check between two cells given by row-major index and coordinates
+        bool line_of_sight(const int & idx, const int & x, const int & y)
+        {
+            sight_checks++;
+            return bits.line_of_sight(idx % width, idx / width, x, y);
+        }
+
+        // \brief offers a neighbour the parent of current (if in line of sight, or always in Lazy Theta*),
+        // otherwise current itself, and pushes it if its g cost improves
+        void relax(const GridEntry & current, const int & nidx, const int & nx, const int & ny, OpenList & open_list)
+        {
+            int from = current.idx;
+            double tentative = current.gcost + distance(current.x, current.y, nx, ny);
+            const int grandparent = parent[current.idx];
+            if (grandparent != -1 and (lazy or line_of_sight(grandparent, nx, ny)))
+            {
+                from = grandparent;
+                tentative = gcost[grandparent] + distance(grandparent % width, grandparent / width, nx, ny);
+            }
+
+            if (opened[nidx] != stamp or tentative < gcost[nidx])
+            {
+                opened[nidx] = stamp;
+                gcost[nidx] = tentative;
+                parent[nidx] = from;
+                const double h = distance(nx, ny, g.x, g.y);
+                open_list.push(GridEntry{tentative + h, h, tentative, nidx, nx, ny});
+            }
+        }
+
+        // \brief Lazy Theta*: checks line of sight from the parent assumed on relaxation. If it is blocked, the
+        // parent becomes the expanded neighbour with the lowest g cost plus distance. There is always one, the
+        // cell whose expansion generated this one.
+        void set_vertex(const GridEntry & current)
+        {
+            const int p = parent[current.idx];
+            if (p == -1 or line_of_sight(p, current.x, current.y))
+            {
+                return;
+            }
+
+            double best = std::numeric_limits<double>::infinity();
+            int best_parent = p;
+            for (const auto & offset : map::OFFSETS_8)
+            {
+                const int nx = current.x + offset.dx;
+                const int ny = current.y + offset.dy;
+                if (nx < 0 or nx >= width or ny < 0 or ny >= height)
+                {
+                    continue;
+                }
+                const int nidx = map::grid2rowmajor(nx, ny, width);
+                if (closed[nidx] != stamp)
+                {
+                    continue;
+                }
+                if (offset.dx != 0 and offset.dy != 0 and
+                    (bits.blocked(current.x + offset.dx, current.y) or bits.blocked(current.x, current.y + offset.dy)))
+                {
+                    continue;
+                }
+                const double candidate = gcost[nidx] + distance(nx, ny, current.x, current.y);
+                if (candidate < best)
+                {
+                    best = candidate;
+                    best_parent = nidx;
+                }
+            }
+            parent[current.idx] = best_parent;
+            gcost[current.idx] = best;
+        }
+
+        // \brief returns the path from the start to idx as Nodes with row-major IDs
+        std::vector<Node> trace_path(const int & idx) const
+        {
+            std::vector<Node> path;
+            for (int i = idx; i != -1; i = parent[i])
+            {
+                const int x = i % width;
+                const int y = i / width;
+                Node node;
+                node.cell = grid.return_cell(x, y);
+                node.id = i;
+                node.gcost = gcost[i];
+                node.hcost = distance(x, y, g.x, g.y);
+                node.fcost = node.gcost + node.hcost;
+                if (!path.empty())
+                {
+                    path.back().parent_id = node.id;
+                }
+                path.push_back(node);
+            }
+            std::reverse(path.begin(), path.end());
+
+            if (verbose)
+            {
+                std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+            }
+            return path;
+        }
+
+        const GridT & grid;
+        OccupancyBits bits;
+        bool lazy = true;
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+
+        // Search state in row-major order, valid for a cell only if its stamp matches the current one
+        std::vector<double> gcost;
+        std::vector<int> parent;
+        std::vector<uint32_t> opened;
+        std::vector<uint32_t> closed;
+        uint32_t stamp = 0;
+        Index g;
+
+        double cost = std::numeric_limits<double>::infinity();
+        int expansions = 0;
+        int sight_checks = 0;
+        bool verbose = true;
+    };
+}
+
+#endif
@@ -0,0 +1,416 @@
+#ifndef ARASTAR_INCLUDE_GUARD_HPP
+#define ARASTAR_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Anytime Repairing A* (ARA*, Likhachev et al. 2003) on the grid index API. Returns an epsilon-suboptimal
+/// path quickly, then lowers epsilon and reuses the previous search effort until epsilon reaches 1 or the
+/// wall-clock budget runs out.
+
+#include "global_planner/grid_search.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace global
+{
+    // \brief called with each improved path and its suboptimality bound
+    using ARASolutionCallback = std::function<void(const std::vector<Node> & path, const double & bound)>;
+
+    /// \brief ARA* on any grid type exposing the grid index API, with the same policies as GridSearch.
+    /// Search state lives in flat arrays ordered by a map::GridIndexer and is reused between plans.
+    /// On a TiledGrid the arrays are PagedArrays in tile order, as in GridSearch.
+    /// \tparam Conn: neighbourhood (Connect4, Connect8, Connect16)
+    /// \tparam Cost: cost model (UniformCost, OctileCost, WeightedCost)
+    template<typename GridT, typename Conn = Connect8, typename Cost = OctileCost>
+    class ARAstar
+    {
+    public:
+        // \param grid_: the grid to plan on. Must outlive this object.
+        // \param initial_epsilon_: heuristic inflation of the first search (>= 1)
+        // \param epsilon_step_: amount epsilon is lowered by between searches (> 0)
+        ARAstar(const GridT & grid_, const double & initial_epsilon_ = 3.0, const double & epsilon_step_ = 0.5)
+            : grid(grid_)
+        {
+            if (initial_epsilon_ < 1.0 or epsilon_step_ <= 0.0)
+            {
+                throw std::invalid_argument("epsilon must be at least 1 and its step positive!\
+                                             \n  where(): ARAstar::ARAstar(...)");
+            }
+            initial_epsilon = initial_epsilon_;
+            epsilon_step = epsilon_step_;
+
+            const auto dims = grid.return_grid_dimensions();
+            width = dims.at(0);
+            height = dims.at(1);
+            if (width < 1 or height < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): ARAstar::ARAstar(...)");
+            }
+            resolution = grid.return_cell(0, 0).resolution;
+            indexer = map::GridIndexer(width, height, search_layout(grid));
+
+            const size_t size = indexer.size();
+            gcost.resize(size);
+            parent.resize(size);
+            seen.assign(size, 0);
+            closed.assign(size, 0);
+            open.assign(size, 0);
+            incons.assign(size, 0);
+        }
+
+        // \brief Plans a path within a wall-clock budget. The first search runs at the initial epsilon, then
+        // each search lowers epsilon until the path is optimal (bound 1) or the deadline passes.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param budget: wall-clock time allowed for planning
+        // \param on_solution: optional, called with every improved path as soon as it is found
+        // \returns: the best path found, empty if the goal was not reached in time or is unreachable
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const std::chrono::microseconds & budget,
+                               const ARASolutionCallback & on_solution = nullptr)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + budget;
+
+            // A new stamp invalidates all previous search state without clearing the arrays
+            stamp++;
+            expansions = 0;
+            searches = 0;
+            cost = std::numeric_limits<double>::infinity();
+            bound = std::numeric_limits<double>::infinity();
+            open_list.clear();
+            incons_list.clear();
+
+            const Index s = grid.world2grid(Cell(start, resolution));
+            goal_index = grid.world2grid(Cell(goal, resolution));
+            const int s_idx = indexer.index(s.x, s.y);
+            g_idx = indexer.index(goal_index.x, goal_index.y);
+            stamp_closed();
+
+            visit(s_idx);
+            gcost[s_idx] = 0.0;
+            epsilon = initial_epsilon;
+            open[s_idx] = stamp;
+            push(s_idx, s.x, s.y);
+
+            std::vector<Node> path;
+            while (true)
+            {
+                searches++;
+                const bool finished = improve_path(deadline);
+                const double goal_g = seen[g_idx] == stamp ? gcost[g_idx] : std::numeric_limits<double>::infinity();
+
+                // A search cut short still leaves a valid parent chain no longer than gcost(goal)
+                if (goal_g < cost)
+                {
+                    cost = goal_g;
+                    path = trace_path();
+                }
+                if (!finished)
+                {
+                    break;
+                }
+
+                // Suboptimality bound of the current solution
+                const double lowest = lower_bound();
+                bound = lowest > 0.0 ? std::min(epsilon, cost / lowest) : 1.0;
+                if (goal_g < std::numeric_limits<double>::infinity() and on_solution)
+                {
+                    on_solution(path, bound);
+                }
+
+                if (bound <= 1.0 or goal_g == std::numeric_limits<double>::infinity() or
+                    std::chrono::steady_clock::now() >= deadline)
+                {
+                    break;
+                }
+
+                // Lower epsilon, move INCONS into OPEN and re-key OPEN
+                epsilon = std::max(1.0, epsilon - epsilon_step);
+                stamp_closed();
+                rekey();
+            }
+
+            if (cost == std::numeric_limits<double>::infinity())
+            {
+                std::cout << "No valid path found in time!" << std::endl;
+            } else
+            {
+                std::cout << "ARA*: path cost " << cost << " within " << bound << " of optimal after "
+                          << searches << " searches and " << expansions << " expansions." << std::endl;
+            }
+            return path;
+        }
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const
+        {
+            return cost;
+        }
+
+        // \returns the suboptimality bound of the last planned path: its cost is at most bound times the optimum.
+        // Infinity if no search completed before the deadline.
+        double return_bound() const
+        {
+            return bound;
+        }
+
+        // \returns the epsilon of the last search
+        double return_epsilon() const
+        {
+            return epsilon;
+        }
+
+        // \returns the number of cells expanded by the last plan, over all its searches
+        int return_expansions() const
+        {
+            return expansions;
+        }
+
+    private:
+        // \brief open list entry keyed by g + epsilon * h. Stale entries are skipped when popped.
+        struct ARAEntry
+        {
+            double key;
+            double gcost;
+            int idx;
+            int x;
+            int y;
+        };
+
+        // \brief min-heap order for std::push_heap/std::pop_heap. Ties go to the deeper entry, like the
+        // lowest h cost first rule of GridEntryComparator.
+        static bool entry_after(const ARAEntry & e1, const ARAEntry & e2)
+        {
+            if (rigid2d::almost_equal(e1.key, e2.key))
+            {
+                return e1.gcost < e2.gcost;
+            }
+            return e1.key > e2.key;
+        }
+
+        // Step costs of Conn's moves under Cost, in grid units
+        static constexpr std::array<double, Conn::size> STEPS = step_table<Conn, Cost>();
+
+        // \brief expands cells in key order until the goal's key is the lowest
+        // \returns false if the deadline passed first
+        bool improve_path(const std::chrono::steady_clock::time_point & deadline)
+        {
+            while (true)
+            {
+                // Drop stale entries
+                while (!open_list.empty() and !is_valid(open_list.front()))
+                {
+                    std::pop_heap(open_list.begin(), open_list.end(), entry_after);
+                    open_list.pop_back();
+                }
+                if (open_list.empty() or (seen[g_idx] == stamp and gcost[g_idx] <= open_list.front().key))
+                {
+                    return true;
+                }
+
+                // The clock is only read every few expansions
+                if ((expansions & 0xff) == 0 and std::chrono::steady_clock::now() >= deadline)
+                {
+                    return false;
+                }
+
+                std::pop_heap(open_list.begin(), open_list.end(), entry_after);
+                const ARAEntry current = open_list.back();
+                open_list.pop_back();
+                open[current.idx] = 0;
+                closed[current.idx] = closed_stamp;
+                expansions++;
+
+                for (int k = 0; k < Conn::size; k++)
+                {
+                    const GridMove & move = Conn::moves[k];
+                    const int nx = current.x + move.dx;
+                    const int ny = current.y + move.dy;
+                    if (nx < 0 or nx >= width or ny < 0 or ny >= height)
+                    {
+                        continue;
+                    }
+                    const double weight = Cost::weights[static_cast<uint8_t>(grid.celltype(nx, ny))];
+                    if (weight == 0.0)
+                    {
+                        continue;
+                    }
+                    if (move.has_via and
+                        (Cost::weights[static_cast<uint8_t>(grid.celltype(current.x + move.via1_dx, current.y + move.via1_dy))] == 0.0 or
+                         Cost::weights[static_cast<uint8_t>(grid.celltype(current.x + move.via2_dx, current.y + move.via2_dy))] == 0.0))
+                    {
+                        continue;
+                    }
+
+                    const int nidx = indexer.index(nx, ny);
+                    const double tentative = current.gcost + STEPS[k] * weight * resolution;
+                    if (seen[nidx] == stamp and tentative >= gcost[nidx])
+                    {
+                        continue;
+                    }
+                    visit(nidx);
+                    gcost[nidx] = tentative;
+                    parent[nidx] = current.idx;
+
+                    if (closed[nidx] != closed_stamp)
+                    {
+                        open[nidx] = stamp;
+                        push(nidx, nx, ny);
+                    } else if (incons[nidx] != stamp)
+                    // Closed in this search: revisited by the next one
+                    {
+                        incons[nidx] = stamp;
+                        incons_list.push_back(nidx);
+                    }
+                }
+            }
+        }
+
+        // \brief lower bound on the optimal cost: min g + h over OPEN and INCONS
+        double lower_bound() const
+        {
+            double lowest = std::numeric_limits<double>::infinity();
+            for (const auto & entry : open_list)
+            {
+                if (is_valid(entry))
+                {
+                    lowest = std::min(lowest, entry.gcost + heuristic(entry.x, entry.y));
+                }
+            }
+            for (const int idx : incons_list)
+            {
+                int x = 0;
+                int y = 0;
+                indexer.coords(idx, x, y);
+                lowest = std::min(lowest, gcost[idx] + heuristic(x, y));
+            }
+            // The goal itself is never expanded, so its own g + h (= g) also bounds the optimum
+            if (seen[g_idx] == stamp)
+            {
+                lowest = std::min(lowest, gcost[g_idx]);
+            }
+            return lowest;
+        }
+
+        // \brief rebuilds OPEN with the current epsilon, adding the INCONS cells
+        void rekey()
+        {
+            std::vector<ARAEntry> entries;
+            entries.swap(open_list);
+            for (const auto & entry : entries)
+            {
+                if (is_valid(entry))
+                {
+                    push(entry.idx, entry.x, entry.y);
+                }
+            }
+            for (const int idx : incons_list)
+            {
+                if (open[idx] != stamp)
+                {
+                    int x = 0;
+                    int y = 0;
+                    indexer.coords(idx, x, y);
+                    open[idx] = stamp;
+                    push(idx, x, y);
+                }
+                incons[idx] = 0;
+            }
+            incons_list.clear();
+        }
+
+        // \brief starts a new CLOSED set
+        void stamp_closed()
+        {
+            closed_stamp++;
+        }
+
+        // \brief whether an open list entry is the current one for its cell
+        bool is_valid(const ARAEntry & entry) const
+        {
+            return open[entry.idx] == stamp and entry.gcost == gcost[entry.idx];
+        }
+
+        // \brief initializes a cell's search state the first time a plan reaches it
+        void visit(const int & idx)
+        {
+            if (seen[idx] != stamp)
+            {
+                seen[idx] = stamp;
+                gcost[idx] = std::numeric_limits<double>::infinity();
+                parent[idx] = -1;
+            }
+        }
+
+        // \brief pushes a cell keyed with the current epsilon
+        void push(const int & idx, const int & x, const int & y)
+        {
+            open_list.push_back(ARAEntry{gcost[idx] + epsilon * heuristic(x, y), gcost[idx], idx, x, y});
+            std::push_heap(open_list.begin(), open_list.end(), entry_after);
+        }
+
+        // \brief the cost model's heuristic to the goal in world units
+        double heuristic(const int & x, const int & y) const
+        {
+            return Cost::template heuristic<Conn>(std::abs(x - goal_index.x), std::abs(y - goal_index.y)) * resolution;
+        }
+
+        // \brief returns the path from the start to the goal as Nodes. Node IDs are row-major, whatever the layout.
+        std::vector<Node> trace_path() const
+        {
+            std::vector<Node> path;
+            for (int i = g_idx; i != -1; i = parent[i])
+            {
+                int x = 0;
+                int y = 0;
+                indexer.coords(i, x, y);
+                Node node;
+                node.cell = grid.return_cell(x, y);
+                node.id = map::grid2rowmajor(x, y, width);
+                node.gcost = gcost[i];
+                node.hcost = heuristic(x, y);
+                node.fcost = node.gcost + node.hcost;
+                if (!path.empty())
+                {
+                    path.back().parent_id = node.id;
+                }
+                path.push_back(node);
+            }
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
+        const GridT & grid;
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        map::GridIndexer indexer;
+
+        double initial_epsilon = 3.0;
+        double epsilon_step = 0.5;
+        double epsilon = 3.0;
+
+        // Search state in indexer order. gcost and parent are valid for a cell only if seen matches the stamp.
+        SearchStateArray<GridT, double> gcost;
+        SearchStateArray<GridT, int> parent;
+        SearchStateArray<GridT, uint32_t> seen;
+        // CLOSED of the current search (closed_stamp), OPEN and INCONS membership of the current plan (stamp)
+        SearchStateArray<GridT, uint32_t> closed;
+        SearchStateArray<GridT, uint32_t> open;
+        SearchStateArray<GridT, uint32_t> incons;
+        uint32_t stamp = 0;
+        uint32_t closed_stamp = 0;
+
+        // OPEN as a binary heap, so it can be scanned and re-keyed
+        std::vector<ARAEntry> open_list;
+        std::vector<int> incons_list;
+
+        Index goal_index;
+        int g_idx = 0;
+
+        double cost = std::numeric_limits<double>::infinity();
+        double bound = std::numeric_limits<double>::infinity();
+        int expansions = 0;
+        int searches = 0;
+    };
+}
+
+#endif
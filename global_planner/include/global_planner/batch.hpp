@@ -0,0 +1,199 @@
+#ifndef BATCH_INCLUDE_GUARD_HPP
+#define BATCH_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Plans batches of start/goal queries (eg: every robot to every pickup) on a thread pool. The map is
+/// shared read-only by all threads and each thread reuses its own search workspace, so nothing is copied per query.
+
+#include "global_planner/heuristic.hpp"
+#include "global_planner/search_budget.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace global
+{
+    // \brief one start/goal pair of a batch
+    struct Query
+    {
+        Vector2D start;
+        Vector2D goal;
+    };
+
+    // \brief the answer to a Query
+    struct QueryResult
+    {
+        // Path from start to goal, or to the closest reachable node if the goal is unreachable.
+        // Empty when the batch was planned without paths.
+        std::vector<Node> path;
+        // Path cost, infinity if the goal is unreachable
+        double cost = std::numeric_limits<double>::infinity();
+        // Nodes expanded by the search
+        int expansions = 0;
+    };
+
+    /// \brief Plans batches of queries on a fixed pool of threads.
+    /// \tparam Search: the per-thread workspace, eg: GridSearch<map::Grid> or RoadmapSearch. It must be
+    /// constructible from the map and provide begin, step, best_path, return_cost, return_expansions and set_verbose.
+    template<typename Search>
+    class BatchPlanner
+    {
+    public:
+        // \param map: the Grid, grid view or PRM to plan on. Must outlive this object and not change while it is used.
+        // \param threads: number of threads. 0 uses one per hardware thread.
+        template<typename MapT>
+        explicit BatchPlanner(const MapT & map, const int & threads = 0)
+        {
+            const int count = threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            for (int i = 0; i < count; i++)
+            {
+                workspaces.emplace_back(new Search(map));
+                // Hundreds of queries per batch: keep the console quiet
+                workspaces.back()->set_verbose(false);
+            }
+            for (int i = 0; i < count; i++)
+            {
+                workers.emplace_back(&BatchPlanner::work, this, i);
+            }
+        }
+
+        // \brief joins the threads
+        ~BatchPlanner()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto & worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        BatchPlanner(const BatchPlanner &) = delete;
+        BatchPlanner & operator=(const BatchPlanner &) = delete;
+
+        // \brief plans every query and waits for all of them. Batches from several callers run one after the other.
+        // \param queries: the start/goal pairs
+        // \param with_paths: also trace the paths. Leave false when only costs are needed (eg: dispatch decisions).
+        // \returns one result per query, in the same order
+        std::vector<QueryResult> plan_batch(const std::vector<Query> & queries, const bool & with_paths = true)
+        {
+            std::lock_guard<std::mutex> batch_lock(batch_mutex);
+            std::vector<QueryResult> results(queries.size());
+
+            std::unique_lock<std::mutex> lock(mutex);
+            batch_queries = &queries;
+            batch_results = &results;
+            batch_paths = with_paths;
+            error = nullptr;
+            next.store(0);
+            busy = static_cast<int>(workers.size());
+            generation++;
+            wake.notify_all();
+            done.wait(lock, [this]{ return busy == 0; });
+
+            batch_queries = nullptr;
+            batch_results = nullptr;
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            return results;
+        }
+
+        // \returns the number of threads
+        int return_threads() const
+        {
+            return static_cast<int>(workers.size());
+        }
+
+    private:
+        // \brief thread loop: takes the next unplanned query of the current batch until none are left
+        // \param id: index of the thread's workspace
+        void work(const int & id)
+        {
+            Search & search = *workspaces.at(id);
+            uint64_t seen = 0;
+            while (true)
+            {
+                const std::vector<Query> * queries = nullptr;
+                std::vector<QueryResult> * results = nullptr;
+                bool with_paths = true;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this, &seen]{ return stopping or generation != seen; });
+                    if (stopping)
+                    {
+                        return;
+                    }
+                    seen = generation;
+                    queries = batch_queries;
+                    results = batch_results;
+                    with_paths = batch_paths;
+                }
+
+                try
+                {
+                    for (size_t i = next++; i < queries->size(); i = next++)
+                    {
+                        search.begin(queries->at(i).start, queries->at(i).goal);
+                        search.step(SearchBudget());
+                        QueryResult & result = results->at(i);
+                        result.cost = search.return_cost();
+                        result.expansions = search.return_expansions();
+                        if (with_paths)
+                        {
+                            result.path = search.best_path();
+                        }
+                    }
+                } catch (...)
+                {
+                    // Stop handing out queries and report the first error from plan_batch
+                    next.store(queries->size());
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+                if (busy == 0)
+                {
+                    done.notify_one();
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<Search>> workspaces;
+        std::vector<std::thread> workers;
+
+        // Serializes plan_batch calls
+        std::mutex batch_mutex;
+        // Guards the batch fields below
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        const std::vector<Query> * batch_queries = nullptr;
+        std::vector<QueryResult> * batch_results = nullptr;
+        bool batch_paths = true;
+        // Increases with every batch, so each thread joins it once
+        uint64_t generation = 0;
+        // Threads still working on the current batch
+        int busy = 0;
+        std::exception_ptr error;
+        bool stopping = false;
+        // Next query to hand out
+        std::atomic<size_t> next{0};
+    };
+}
+
+#endif
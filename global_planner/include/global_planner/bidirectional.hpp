@@ -0,0 +1,51 @@
+#ifndef BIDIRECTIONAL_INCLUDE_GUARD_HPP
+#define BIDIRECTIONAL_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Bidirectional A* (NBA*, Pijls and Post 2009) on the PRM and on the Grid. Searches from start and goal
+/// at once and stops when neither frontier can improve the best meeting point, so far fewer nodes are expanded
+/// on long corridor maps.
+
+#include "global_planner/heuristic.hpp"
+#include <limits>
+
+namespace global
+{
+    /// \brief Bidirectional A* Planner. Same interface, heuristics and edge costs as Astar.
+    class BidirectionalAstar : public Astar
+    {
+    public:
+
+        // Inherit constructor from A*
+        using Astar::Astar;
+
+        // Keep the other Astar::plan overloads visible
+        using Astar::plan;
+
+        // \brief Plans a path on a PRM, searching from both ends. PRM edges are used in both directions.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param map: the PRM
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const std::vector<Vertex> & map) override;
+
+        // \brief Plans a path on a Grid, searching from both ends. Only Free cells are entered, like GridSearch.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param grid_: the Grid Map
+        // \param resolution: the Grid resolution
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::Grid & grid_, const double & resolution);
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const;
+
+        // \returns the number of nodes expanded by both searches in the last plan
+        int return_expansions() const;
+
+    private:
+        double cost = std::numeric_limits<double>::infinity();
+        int expansions = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef CONTRACTION_INCLUDE_GUARD_HPP
+#define CONTRACTION_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Contraction hierarchy (Geisberger et al. 2008) over a static PRM. Vertices are contracted one by one,
+/// adding shortcuts that keep distances between the remaining vertices, so a query only searches upwards
+/// from both ends and settles a few dozen vertices however large the roadmap is.
+
+#include "global_planner/heuristic.hpp"
+#include <map/kdtree.hpp>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+namespace global
+{
+    // \brief edge of the hierarchy
+    struct CHArc
+    {
+        // Vertex the arc leads to
+        int to;
+        // Euclidean length of the path it stands for
+        double weight;
+        // Vertex the shortcut bypasses, -1 for an edge of the roadmap
+        int middle;
+    };
+
+    /// \brief Contraction hierarchy planner for repeated queries on a roadmap that does not change.
+    /// Edges are undirected and cost their Euclidean length, as in Astar.
+    class ContractionHierarchy
+    {
+    public:
+        // \brief contracts the whole roadmap
+        // \param prm_: the roadmap. Vertex IDs must be their positions in it. Must outlive this object.
+        explicit ContractionHierarchy(const std::vector<Vertex> & prm_);
+
+        // \brief Plans a path on the roadmap, between the vertices start and goal snap to (see set_snapper).
+        // Without a snapper, the closest vertices are found through a k-d tree.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \returns: the path as a vector of Nodes with all shortcuts unpacked, or only the start vertex
+        // if the goal is unreachable
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal);
+
+        // \brief Plans a path on the roadmap between two vertices, for callers that snap start and goal themselves
+        // \param start_id: start vertex ID
+        // \param goal_id: goal vertex ID
+        // \returns: the path as a vector of Nodes with all shortcuts unpacked, or only the start vertex
+        // if the goal is unreachable
+        std::vector<Node> plan(const int & start_id, const int & goal_id);
+
+        // \brief shortest path cost between two vertices, without unpacking the path
+        // \param s: start vertex ID
+        // \param t: goal vertex ID
+        // \returns the cost, infinity if t is unreachable
+        double query(const int & s, const int & t);
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const;
+
+        // \returns the number of vertices settled by both searches of the last query
+        int return_settled() const;
+
+        // \returns the number of shortcuts added by the contraction
+        int return_shortcuts() const;
+
+        // \returns the contraction order of each vertex (0 is contracted first)
+        const std::vector<int> & return_ranks() const;
+
+        // \brief attaches start and goal through a spatial index, choosing the closest Vertex in line of sight,
+        // instead of scanning every Vertex for the closest one
+        // \param snapper_: built for this roadmap, or nullptr to scan. Must outlive its use.
+        void set_snapper(const RoadmapSnapper * snapper_);
+
+    private:
+        using Entry = std::pair<double, int>;
+        using MinQueue = std::priority_queue <Entry, std::vector<Entry>, std::greater<Entry> >;
+
+        // \brief contracts every vertex, least important first
+        void contract();
+
+        // \brief counts (simulate) or adds the shortcuts needed to contract v
+        // \returns the number of shortcuts
+        int shortcuts(const int & v, const bool & simulate);
+
+        // \brief importance of v: edge difference plus contracted neighbours. Lowest is contracted first.
+        int priority(const int & v);
+
+        // \brief Dijkstra from source over uncontracted vertices, skipping via, which stops past max_distance
+        // or after a fixed number of settled vertices. Results are in witness_dist for the current witness_stamp.
+        void witness_search(const int & source, const int & via, const double & max_distance);
+
+        // \brief adds or shortens the arc between a and b in the contraction graph
+        void add_arc(const int & a, const int & b, const double & weight, const int & middle);
+
+        // \brief appends the roadmap vertices of the arc from a to b, excluding a
+        void unpack(const int & a, const int & b, std::vector<int> & ids) const;
+
+        // \returns the arc from low to high in the upward graph (low has the lower rank)
+        const CHArc & upward_arc(const int & low, const int & high) const;
+
+        const std::vector<Vertex> & prm;
+        // Closest vertex lookup when there is no snapper
+        map::KDTree tree;
+
+        // Remaining graph during contraction
+        std::vector<std::vector<CHArc>> graph;
+        // Number of contracted neighbours, for the priority
+        std::vector<int> deleted_neighbours;
+
+        // Arcs to higher-ranked vertices, searched by queries and used to unpack shortcuts
+        std::vector<std::vector<CHArc>> upward;
+        std::vector<int> rank;
+        int shortcut_count = 0;
+
+        // Witness search state, valid for a vertex only if its stamp matches
+        std::vector<double> witness_dist;
+        std::vector<uint32_t> witness_seen;
+        uint32_t witness_stamp = 0;
+
+        // Query state: index 0 searches up from the start, 1 up from the goal
+        std::vector<double> dist[2];
+        std::vector<int> parent[2];
+        std::vector<uint32_t> seen[2];
+        uint32_t stamp = 0;
+        int meet = -1;
+
+        double cost = std::numeric_limits<double>::infinity();
+        int settled = 0;
+        const RoadmapSnapper * snapper = nullptr;
+    };
+}
+
+#endif
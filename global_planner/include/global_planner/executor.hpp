@@ -0,0 +1,132 @@
+#ifndef EXECUTOR_INCLUDE_GUARD_HPP
+#define EXECUTOR_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Runs planning requests on worker threads, so a node's loop keeps publishing during long replans.
+/// Only the plan for the latest goal and map is wanted, so each new request cancels the older ones.
+
+#include "global_planner/heuristic.hpp"
+#include "global_planner/search_budget.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace global
+{
+    /// \brief cancellation flag of one planning request. Copies share the flag.
+    class CancelToken
+    {
+    public:
+        // \brief creates a token that is not cancelled
+        CancelToken();
+
+        // \returns whether the request was cancelled
+        bool cancelled() const;
+
+        // \brief cancels the request. The planner stops at its next check of the token.
+        void cancel() const;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> flag;
+    };
+
+    // \brief the path computed by a finished request
+    struct PlanResult
+    {
+        // ID returned by PlanningExecutor::submit
+        uint64_t request = 0;
+        std::vector<Node> path;
+        // Whether the planner found a valid path, read on the worker so the caller never touches the planner
+        bool valid = true;
+    };
+
+    // \brief a planning request: returns the path and its validity, giving up early once its token is cancelled.
+    // The executor fills in the request ID.
+    using PlanningJob = std::function<PlanResult(const CancelToken &)>;
+
+    // Expansions between two checks of the token in step_until_cancelled
+    constexpr int CANCEL_CHECK_EXPANSIONS = 2048;
+
+    // \brief runs a resumable search in bounded steps until it finishes or the request is cancelled
+    // \param step: callable taking a SearchBudget and returning the SearchStatus after the step,
+    // eg: a lambda calling GridSearch::step or LPAstar::ComputeShortestPath
+    // \param token: the token of the request running the search
+    // \returns the status after the last step (InProgress if cancelled)
+    template<typename StepFn>
+    SearchStatus step_until_cancelled(StepFn step, const CancelToken & token)
+    {
+        SearchBudget slice;
+        slice.expansions = CANCEL_CHECK_EXPANSIONS;
+        SearchStatus status = SearchStatus::InProgress;
+        while (status == SearchStatus::InProgress and !token.cancelled())
+        {
+            status = step(slice);
+        }
+        return status;
+    }
+
+    /// \brief Runs planning requests on worker threads. Submitting a request cancels every older one: queued
+    /// requests are dropped and running ones are told to stop through their CancelToken. Only the result of the
+    /// latest request is ever returned.
+    class PlanningExecutor
+    {
+    public:
+        // \param threads: number of worker threads. Keep 1 when requests share a stateful planner (eg: LPAstar),
+        // so they run one at a time and in order.
+        explicit PlanningExecutor(const int & threads = 1);
+
+        // \brief cancels all requests and joins the workers
+        ~PlanningExecutor();
+
+        PlanningExecutor(const PlanningExecutor &) = delete;
+        PlanningExecutor & operator=(const PlanningExecutor &) = delete;
+
+        // \brief queues a request and cancels every older request
+        // \param job: the request. It runs on a worker thread, so it must not share unguarded state with the caller.
+        // \returns the ID of the request. IDs increase from 1.
+        uint64_t submit(PlanningJob job);
+
+        // \brief cancels every queued or running request
+        void cancel();
+
+        // \brief takes the result of the latest request once it has finished
+        // \param result: set to the result if one is ready
+        // \returns whether a result was ready. Each result is returned once.
+        bool poll(PlanResult & result);
+
+        // \returns whether a request is queued or running
+        bool busy() const;
+
+    private:
+        // \brief queued or running request
+        struct Request
+        {
+            uint64_t id = 0;
+            PlanningJob job;
+            CancelToken token;
+        };
+
+        // \brief worker thread loop
+        void work();
+
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Request> queue;
+        // Tokens of the running requests, by ID
+        std::map<uint64_t, CancelToken> running;
+        // ID of the latest submitted request
+        uint64_t latest = 0;
+        // Result of the latest request, if it finished and was not yet polled
+        bool ready = false;
+        PlanResult result;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+}
+
+#endif
@@ -0,0 +1,402 @@
+#ifndef FLOW_FIELD_INCLUDE_GUARD_HPP
+#define FLOW_FIELD_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Goal-rooted cost-to-go fields for robots converging on a common goal (dock, charger). The field is
+/// computed once per goal with a backward search over the whole grid, after which any robot extracts its path
+/// by descending the field in O(path length).
+
+#include "global_planner/grid_search.hpp"
+#include <memory>
+#include <mutex>
+
+namespace global
+{
+    /// \brief Cost-to-go from every cell to one goal, under the same neighbourhood and cost model as GridSearch,
+    /// so extracted paths cost the same as GridSearch::plan. Works on any grid type exposing the grid index API.
+    /// \tparam Conn: neighbourhood (Connect4, Connect8, Connect16)
+    /// \tparam Cost: cost model (UniformCost, OctileCost, WeightedCost)
+    template<typename GridT, typename Conn = Connect8, typename Cost = OctileCost>
+    class FlowField
+    {
+    public:
+        // \param grid_: the grid. Must outlive this object; recompute the field after the grid changes.
+        explicit FlowField(const GridT & grid_) : grid(grid_)
+        {
+            const auto dims = grid.return_grid_dimensions();
+            width = dims.at(0);
+            height = dims.at(1);
+            if (width < 1 or height < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): FlowField::FlowField(const GridT & grid_)");
+            }
+            resolution = grid.return_cell(0, 0).resolution;
+            indexer = map::GridIndexer(width, height, search_layout(grid));
+            dist.assign(indexer.size(), INF);
+        }
+
+        // \brief Computes the cost-to-go of every cell to the goal. Uses Dial's bucket queue: buckets are as wide
+        // as the cheapest step, so no cell can improve another in its own bucket and each bucket is settled in one pass.
+        // \param goal: the goal coordinates
+        void compute(const Vector2D & goal_)
+        {
+            const Index g = grid.world2grid(Cell(goal_, resolution));
+            compute(g.x, g.y);
+        }
+
+        // \brief Computes the cost-to-go of every cell to a goal cell
+        // \param gx: x-coordinate of the goal cell
+        // \param gy: y-coordinate of the goal cell
+        void compute(const int & gx, const int & gy)
+        {
+            goal.x = gx;
+            goal.y = gy;
+            goal.row_major = map::grid2rowmajor(gx, gy, width);
+            std::fill(dist.begin(), dist.end(), INF);
+            settled = 0;
+            // A blocked goal can never be entered, as in GridSearch
+            if (Cost::weights[static_cast<uint8_t>(grid.celltype(goal.x, goal.y))] == 0.0)
+            {
+                return;
+            }
+
+            // Bucket width and the number of buckets a single step can span, in grid units
+            double min_weight = INF;
+            double max_weight = 0.0;
+            for (const double & weight : Cost::weights)
+            {
+                if (weight > 0.0)
+                {
+                    min_weight = std::min(min_weight, weight);
+                    max_weight = std::max(max_weight, weight);
+                }
+            }
+            const double bucket_width = *std::min_element(STEPS.begin(), STEPS.end()) * min_weight;
+            const size_t buckets = static_cast<size_t>(std::ceil(*std::max_element(STEPS.begin(), STEPS.end()) * max_weight / bucket_width)) + 1;
+            std::vector<std::vector<int>> queue(buckets);
+            std::vector<bool> done(indexer.size(), false);
+
+            const int g_idx = indexer.index(goal.x, goal.y);
+            dist.at(g_idx) = 0.0;
+            queue.at(0).push_back(g_idx);
+            size_t queued = 1;
+
+            for (size_t b = 0; queued > 0; b++)
+            {
+                std::vector<int> & bucket = queue[b % buckets];
+                // Cells may be added to this bucket while it is processed
+                for (size_t i = 0; i < bucket.size(); i++)
+                {
+                    queued--;
+                    const int idx = bucket[i];
+                    if (done[idx] or static_cast<size_t>(dist[idx] / bucket_width) != b)
+                    {
+                        continue;
+                    }
+                    done[idx] = true;
+                    settled++;
+
+                    int x = 0;
+                    int y = 0;
+                    indexer.coords(idx, x, y);
+                    // Paths may start in a blocked cell, but never pass through one
+                    const double weight = Cost::weights[static_cast<uint8_t>(grid.celltype(x, y))];
+                    if (weight == 0.0)
+                    {
+                        continue;
+                    }
+
+                    // Moves are symmetric, so the predecessors of a cell are its neighbours. Entering idx costs its weight.
+                    for (int k = 0; k < Conn::size; k++)
+                    {
+                        const int px = x + Conn::moves[k].dx;
+                        const int py = y + Conn::moves[k].dy;
+                        if (!passable(x, y, k))
+                        {
+                            continue;
+                        }
+                        const int pidx = indexer.index(px, py);
+                        const double tentative = dist[idx] + STEPS[k] * weight;
+                        if (!done[pidx] and tentative < dist[pidx])
+                        {
+                            dist[pidx] = tentative;
+                            queue[static_cast<size_t>(tentative / bucket_width) % buckets].push_back(pidx);
+                            queued++;
+                        }
+                    }
+                }
+                bucket.clear();
+            }
+        }
+
+        // \returns the goal's grid coordinates
+        Index return_goal() const
+        {
+            return goal;
+        }
+
+        // \returns the number of cells whose cost-to-go was settled by the last compute
+        int return_settled() const
+        {
+            return settled;
+        }
+
+        // \param position: world coordinates
+        // \returns the cost of the cheapest path from position to the goal, infinity if there is none
+        double cost_to_go(const Vector2D & position) const
+        {
+            const Index s = grid.world2grid(Cell(position, resolution));
+            return cost_to_go(s.x, s.y);
+        }
+
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \returns the cost of the cheapest path from the cell to the goal, infinity if there is none
+        double cost_to_go(const int & x, const int & y) const
+        {
+            return dist.at(indexer.index(x, y)) * resolution;
+        }
+
+        // \brief Extracts the path to the goal by always moving to the neighbour with the lowest step cost plus
+        // cost-to-go.
+        // \param start: the starting coordinates
+        // \returns: the path as a vector of Nodes, or only the start if the goal is unreachable from it
+        std::vector<Node> extract_path(const Vector2D & start) const
+        {
+            const Index s = grid.world2grid(Cell(start, resolution));
+            int x = s.x;
+            int y = s.y;
+            std::vector<Node> path{make_node(x, y, 0.0, -1)};
+            if (dist.at(indexer.index(x, y)) == INF)
+            {
+                return path;
+            }
+
+            while (x != goal.x or y != goal.y)
+            {
+                int best_k = -1;
+                double best_cost = INF;
+                double best_step = 0.0;
+                for (int k = 0; k < Conn::size; k++)
+                {
+                    const int nx = x + Conn::moves[k].dx;
+                    const int ny = y + Conn::moves[k].dy;
+                    if (!passable(x, y, k))
+                    {
+                        continue;
+                    }
+                    const double weight = Cost::weights[static_cast<uint8_t>(grid.celltype(nx, ny))];
+                    if (weight == 0.0)
+                    {
+                        continue;
+                    }
+                    const double step = STEPS[k] * weight;
+                    if (step + dist[indexer.index(nx, ny)] < best_cost)
+                    {
+                        best_cost = step + dist[indexer.index(nx, ny)];
+                        best_step = step;
+                        best_k = k;
+                    }
+                }
+                x += Conn::moves[best_k].dx;
+                y += Conn::moves[best_k].dy;
+                path.push_back(make_node(x, y, path.back().gcost + best_step * resolution, path.back().id));
+            }
+            return path;
+        }
+
+    private:
+        static constexpr double INF = std::numeric_limits<double>::infinity();
+
+        // Step costs of Conn's moves under Cost, in grid units
+        static constexpr std::array<double, Conn::size> STEPS = step_table<Conn, Cost>();
+
+        // \brief whether move k from x, y stays on the grid and, for knight moves, crosses no blocked cell.
+        // The move's reverse crosses the same cells, so this holds both ways.
+        bool passable(const int & x, const int & y, const int & k) const
+        {
+            const GridMove & move = Conn::moves[k];
+            const int nx = x + move.dx;
+            const int ny = y + move.dy;
+            if (nx < 0 or nx >= width or ny < 0 or ny >= height)
+            {
+                return false;
+            }
+            if (move.has_via)
+            {
+                return Cost::weights[static_cast<uint8_t>(grid.celltype(x + move.via1_dx, y + move.via1_dy))] != 0.0 and
+                       Cost::weights[static_cast<uint8_t>(grid.celltype(x + move.via2_dx, y + move.via2_dy))] != 0.0;
+            }
+            return true;
+        }
+
+        // \brief builds a path Node. IDs are row-major, as in GridSearch.
+        Node make_node(const int & x, const int & y, const double & gcost, const int & parent_id) const
+        {
+            Node node;
+            node.cell = grid.return_cell(x, y);
+            node.id = map::grid2rowmajor(x, y, width);
+            node.parent_id = parent_id;
+            node.gcost = gcost;
+            node.hcost = dist[indexer.index(x, y)] * resolution;
+            node.fcost = node.gcost + node.hcost;
+            return node;
+        }
+
+        const GridT & grid;
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        map::GridIndexer indexer;
+        Index goal;
+        // Cost-to-go in grid units, in indexer order
+        std::vector<double> dist;
+        int settled = 0;
+    };
+
+    /// \brief FlowFields for the most recently used goals. Fields are shared, so a robot holding one keeps it
+    /// valid after it is evicted or invalidated. Safe to use from several threads.
+    template<typename GridT, typename Conn = Connect8, typename Cost = OctileCost>
+    class FlowFieldCache
+    {
+    public:
+        using Field = FlowField<GridT, Conn, Cost>;
+
+        // \param grid_: the grid. Must outlive this object.
+        // \param capacity_: number of goals to keep fields for
+        FlowFieldCache(const GridT & grid_, const int & capacity_ = 4) : grid(grid_), capacity(capacity_)
+        {
+            if (capacity < 1)
+            {
+                throw std::invalid_argument("FlowFieldCache needs room for at least one field\n  where(): FlowFieldCache::FlowFieldCache(const GridT & grid_, const int & capacity_)");
+            }
+            const auto dims = grid.return_grid_dimensions();
+            if (dims.at(0) < 1 or dims.at(1) < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): FlowFieldCache::FlowFieldCache(const GridT & grid_, const int & capacity_)");
+            }
+        }
+
+        // \brief returns the field of a goal, computing it if it is not cached. Goals in the same cell share a field.
+        // \param goal: the goal coordinates
+        // \returns the field
+        std::shared_ptr<const Field> field(const Vector2D & goal)
+        {
+            const Index g = grid.world2grid(Cell(goal, grid.return_cell(0, 0).resolution));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            clock++;
+            for (auto & entry : entries)
+            {
+                if (entry.goal == g.row_major)
+                {
+                    entry.last_used = clock;
+                    hits++;
+                    return entry.field;
+                }
+            }
+
+            misses++;
+            auto computed = std::make_shared<Field>(grid);
+            computed->compute(goal);
+            if (static_cast<int>(entries.size()) == capacity)
+            {
+                // Evict the least recently used goal
+                auto oldest = std::min_element(entries.begin(), entries.end(), [](const Entry & a, const Entry & b)
+                {
+                    return a.last_used < b.last_used;
+                });
+                entries.erase(oldest);
+            }
+            entries.push_back(Entry{g.row_major, clock, computed});
+            return computed;
+        }
+
+        // \brief drops every field. Call after the grid changes.
+        void invalidate()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+        }
+
+        // \returns the number of field requests answered from the cache
+        int return_hits() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return hits;
+        }
+
+        // \returns the number of fields computed
+        int return_misses() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return misses;
+        }
+
+    private:
+        // \brief cached field with its goal cell (row-major) and last use
+        struct Entry
+        {
+            int goal;
+            uint64_t last_used;
+            std::shared_ptr<const Field> field;
+        };
+
+        const GridT & grid;
+        int capacity = 4;
+        mutable std::mutex mutex;
+        std::vector<Entry> entries;
+        uint64_t clock = 0;
+        int hits = 0;
+        int misses = 0;
+    };
+
+    // \brief picks landmarks among the traversable cells of a grid (see select_landmarks) and computes their
+    // cost-to-go tables in parallel, one landmark per thread
+    // \tparam Conn, Cost: must match those of the GridSearch the tables are given to
+    // \param grid: the grid
+    // \param count: number of landmarks
+    // \param threads: number of threads, 0 uses one per hardware thread
+    // \returns the tables, by row-major cell
+    template<typename Conn = Connect8, typename Cost = OctileCost, typename GridT>
+    Landmarks build_landmarks(const GridT & grid, const int & count, const int & threads = 0)
+    {
+        const auto dims = grid.return_grid_dimensions();
+        const int width = dims.at(0);
+        const int height = dims.at(1);
+
+        // Candidates in grid coordinates
+        std::vector<Vector2D> points;
+        std::vector<int> ids;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                if (Cost::weights[static_cast<uint8_t>(grid.celltype(x, y))] != 0.0)
+                {
+                    points.push_back(Vector2D(x, y));
+                    ids.push_back(map::grid2rowmajor(x, y, width));
+                }
+            }
+        }
+
+        Landmarks landmarks(select_landmarks(points, ids, count), width * height, Cost::symmetric);
+        const std::vector<int> & chosen = landmarks.return_landmarks();
+
+        parallel_for(static_cast<int>(chosen.size()), threads, [&grid, &landmarks, &chosen, &width, &height](const int & l)
+        {
+            FlowField<GridT, Conn, Cost> field(grid);
+            field.compute(chosen.at(l) % width, chosen.at(l) / width);
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    landmarks.set_distance(l, map::grid2rowmajor(x, y, width), field.cost_to_go(x, y));
+                }
+            }
+        });
+
+        return landmarks;
+    }
+}
+
+#endif
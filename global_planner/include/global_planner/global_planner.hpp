@@ -29,9 +29,8 @@ namespace global
 
     // protected instead of private so that child Class can access
     protected:
-        std::vector<Vertex> PRM;
-
-        std::vector<Cell> GRID;
+        // Roadmap of the current PRM plan, owned by the caller. nullptr outside of plans.
+        const std::vector<Vertex> * PRM = nullptr;
 
          // Map obstacles
         std::vector<Obstacle> obstacles;
@@ -0,0 +1,184 @@
+#ifndef GRID_POLICIES_INCLUDE_GUARD_HPP
+#define GRID_POLICIES_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Compile-time neighbourhoods (4/8/16-connected) and cost models (uniform, octile, weighted cells)
+/// for GridSearch. Move lengths, step costs and cell weights are constexpr tables in grid units.
+#include <map/grid.hpp>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+namespace global
+{
+    // \brief a move to a neighbouring cell
+    struct GridMove
+    {
+        int dx;
+        int dy;
+        // Euclidean length in grid units
+        double length;
+        // Cells the move crosses, which must also be traversable (16-connected moves only)
+        bool has_via;
+        int via1_dx;
+        int via1_dy;
+        int via2_dx;
+        int via2_dy;
+    };
+
+    constexpr double SQRT_2 = 1.4142135623730951;
+    constexpr double SQRT_5 = 2.23606797749979;
+
+    /// \brief 4-connected neighbourhood
+    struct Connect4
+    {
+        static constexpr int size = 4;
+        // Largest |dx| or |dy| of any move
+        static constexpr int reach = 1;
+        static constexpr std::array<GridMove, size> moves = {{
+            {-1, 0, 1.0, false, 0, 0, 0, 0}, {0, -1, 1.0, false, 0, 0, 0, 0},
+            {0, 1, 1.0, false, 0, 0, 0, 0}, {1, 0, 1.0, false, 0, 0, 0, 0}}};
+
+        // \brief shortest path length between cells ax, ay apart on an empty grid (Manhattan)
+        static constexpr double distance(const int ax, const int ay)
+        {
+            return ax + ay;
+        }
+
+        // \brief fewest moves between cells ax, ay apart
+        static constexpr double min_moves(const int ax, const int ay)
+        {
+            return ax + ay;
+        }
+    };
+
+    /// \brief 8-connected neighbourhood, same visiting order as map::OFFSETS_8
+    struct Connect8
+    {
+        static constexpr int size = 8;
+        static constexpr int reach = 1;
+        static constexpr std::array<GridMove, size> moves = {{
+            {-1, -1, SQRT_2, false, 0, 0, 0, 0}, {-1, 0, 1.0, false, 0, 0, 0, 0},
+            {-1, 1, SQRT_2, false, 0, 0, 0, 0}, {0, -1, 1.0, false, 0, 0, 0, 0},
+            {0, 1, 1.0, false, 0, 0, 0, 0}, {1, -1, SQRT_2, false, 0, 0, 0, 0},
+            {1, 0, 1.0, false, 0, 0, 0, 0}, {1, 1, SQRT_2, false, 0, 0, 0, 0}}};
+
+        // \brief octile distance
+        static constexpr double distance(const int ax, const int ay)
+        {
+            return (ax + ay) + (SQRT_2 - 2.0) * (ax < ay ? ax : ay);
+        }
+
+        // \brief Chebyshev distance
+        static constexpr double min_moves(const int ax, const int ay)
+        {
+            return ax > ay ? ax : ay;
+        }
+    };
+
+    /// \brief 16-connected neighbourhood: the 8 neighbours plus knight moves. A knight move also needs
+    /// the two cells it crosses to be traversable.
+    struct Connect16
+    {
+        static constexpr int size = 16;
+        static constexpr int reach = 2;
+        static constexpr std::array<GridMove, size> moves = {{
+            {-1, -1, SQRT_2, false, 0, 0, 0, 0}, {-1, 0, 1.0, false, 0, 0, 0, 0},
+            {-1, 1, SQRT_2, false, 0, 0, 0, 0}, {0, -1, 1.0, false, 0, 0, 0, 0},
+            {0, 1, 1.0, false, 0, 0, 0, 0}, {1, -1, SQRT_2, false, 0, 0, 0, 0},
+            {1, 0, 1.0, false, 0, 0, 0, 0}, {1, 1, SQRT_2, false, 0, 0, 0, 0},
+            {-2, -1, SQRT_5, true, -1, 0, -1, -1}, {-2, 1, SQRT_5, true, -1, 0, -1, 1},
+            {-1, -2, SQRT_5, true, 0, -1, -1, -1}, {-1, 2, SQRT_5, true, 0, 1, -1, 1},
+            {1, -2, SQRT_5, true, 0, -1, 1, -1}, {1, 2, SQRT_5, true, 0, 1, 1, 1},
+            {2, -1, SQRT_5, true, 1, 0, 1, -1}, {2, 1, SQRT_5, true, 1, 0, 1, 1}}};
+
+        // \brief Euclidean distance (octile overestimates knight moves)
+        static double distance(const int ax, const int ay)
+        {
+            return std::sqrt(static_cast<double>(ax * ax + ay * ay));
+        }
+
+        // \brief each move changes the larger coordinate by at most 2
+        static constexpr double min_moves(const int ax, const int ay)
+        {
+            return ((ax > ay ? ax : ay) + 1) / 2;
+        }
+    };
+
+    /// \brief every move costs 1, whatever its length. Occupied and Inflation cells are blocked.
+    struct UniformCost
+    {
+        // Cost factor for entering a cell, indexed by map::CellType. 0 means blocked.
+        static constexpr std::array<double, 3> weights = {{0.0, 0.0, 1.0}};
+        // Whether a move costs the same both ways
+        static constexpr bool symmetric = true;
+
+        // \brief step cost of a move in grid units
+        static constexpr double step(const GridMove &)
+        {
+            return 1.0;
+        }
+
+        // \brief admissible heuristic in grid units
+        template<typename Conn>
+        static double heuristic(const int ax, const int ay)
+        {
+            return Conn::min_moves(ax, ay);
+        }
+    };
+
+    /// \brief moves cost their Euclidean length (1, sqrt(2), sqrt(5)). Occupied and Inflation cells are blocked.
+    /// With Connect8 this is the octile model used by Astar.
+    struct OctileCost
+    {
+        static constexpr std::array<double, 3> weights = {{0.0, 0.0, 1.0}};
+        static constexpr bool symmetric = true;
+
+        static constexpr double step(const GridMove & move)
+        {
+            return move.length;
+        }
+
+        template<typename Conn>
+        static double heuristic(const int ax, const int ay)
+        {
+            return Conn::distance(ax, ay);
+        }
+    };
+
+    /// \brief moves cost their Euclidean length times the weight of the cell entered. Inflation cells are
+    /// traversable at InflationWeight times the cost of Free cells, so paths keep away from obstacles when they can.
+    template<int InflationWeight = 4>
+    struct WeightedCost
+    {
+        static_assert(InflationWeight >= 1, "Weights below 1 make the heuristic inadmissible");
+
+        static constexpr std::array<double, 3> weights = {{0.0, static_cast<double>(InflationWeight), 1.0}};
+        // Entering an Inflation cell costs more than leaving it
+        static constexpr bool symmetric = InflationWeight == 1;
+
+        static constexpr double step(const GridMove & move)
+        {
+            return move.length;
+        }
+
+        template<typename Conn>
+        static double heuristic(const int ax, const int ay)
+        {
+            return Conn::distance(ax, ay);
+        }
+    };
+
+    // \brief step costs of every move of Conn under Cost, in grid units
+    template<typename Conn, typename Cost>
+    constexpr std::array<double, Conn::size> step_table()
+    {
+        std::array<double, Conn::size> table{};
+        for (int k = 0; k < Conn::size; k++)
+        {
+            table[k] = Cost::step(Conn::moves[k]);
+        }
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,561 @@
+#ifndef GRID_SEARCH_INCLUDE_GUARD_HPP
+#define GRID_SEARCH_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Grid A* written against the grid index API (return_grid_dimensions, celltype, return_cell, world2grid),
+/// so the same search runs on map::Grid and on read-only views such as map::GridView.
+/// Neighbourhood and cost model are template parameters (see grid_policies.hpp).
+
+#include "global_planner/heuristic.hpp"
+#include "global_planner/grid_policies.hpp"
+#include "global_planner/landmarks.hpp"
+#include "global_planner/radix_heap.hpp"
+#include "global_planner/search_budget.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace global
+{
+    using rigid2d::Vector2D;
+    using map::Cell;
+    using map::Index;
+
+    // \brief open list entry for GridSearch. Stale entries are skipped when popped (lazy deletion).
+    struct GridEntry
+    {
+        double fcost;
+        double hcost;
+        double gcost;
+        // Storage index of the cell (see map::GridIndexer) and its grid coordinates
+        int idx;
+        int x;
+        int y;
+    };
+
+    // \brief same ordering as HeapComparator: lowest f cost first, then lowest h cost
+    class GridEntryComparator
+    {
+    public:
+        bool operator() (const GridEntry & e1, const GridEntry & e2) const
+        {
+            if (rigid2d::almost_equal(e1.fcost, e2.fcost))
+            {
+                return e1.hcost > e2.hcost;
+            } else
+            {
+                return e1.fcost > e2.fcost;
+            }
+        }
+    };
+
+    // \brief default open list for GridSearch: a binary heap
+    using BinaryOpenList = std::priority_queue <GridEntry, std::vector<GridEntry>, GridEntryComparator >;
+
+    /// \brief open list for GridSearch on a radix heap keyed by the fixed-point f cost. Grid step costs are bounded
+    /// and the cost models' heuristics are consistent, so popped f costs never decrease. Equal keys are still
+    /// ordered by GridEntryComparator. Paths cost the same as with BinaryOpenList, but f costs that round to the
+    /// same key may be expanded in a different order, so the path may be a different one of equal cost.
+    class RadixOpenList
+    {
+    public:
+        void push(const GridEntry & entry)
+        {
+            heap.push(to_fixed_point(entry.fcost), entry);
+        }
+
+        const GridEntry & top()
+        {
+            return heap.top();
+        }
+
+        void pop()
+        {
+            heap.pop();
+        }
+
+        bool empty() const
+        {
+            return heap.empty();
+        }
+
+    private:
+        RadixHeap<GridEntry, GridEntryComparator> heap;
+    };
+
+    // \brief storage layout GridSearch uses for a grid type: row-major unless the grid has its own layout
+    template<typename GridT>
+    map::CellLayout search_layout(const GridT &)
+    {
+        return map::CellLayout::RowMajor;
+    }
+
+    // \brief GridSearch on a Grid uses the Grid's layout, so cell types and search state are ordered alike
+    inline map::CellLayout search_layout(const map::Grid & grid)
+    {
+        return grid.return_layout();
+    }
+
+    // \brief GridSearch on a TiledGrid orders its search state by tile, so each tile's state is one page
+    inline map::CellLayout search_layout(const map::TiledGrid &)
+    {
+        return map::CellLayout::Tiled;
+    }
+
+    // \brief whether GridSearch allocates search state per tile as the search reaches it, rather than for every cell
+    template<typename GridT>
+    struct paged_search_state : std::false_type {};
+
+    template<>
+    struct paged_search_state<map::TiledGrid> : std::true_type {};
+
+    /// \brief array of per-cell search state split into pages of one CellLayout::Tiled block, each allocated
+    /// (and filled with the default value) the first time one of its slots is accessed through the non-const
+    /// operator[]. A search on a large sparse map only pays for the tiles it reaches.
+    template<typename T>
+    class PagedArray
+    {
+    public:
+        // \brief drops every page
+        // \param size: number of slots
+        // \param value: initial value of every slot
+        void assign(const size_t & size, const T & value)
+        {
+            slots = size;
+            fill = value;
+            pages.clear();
+            pages.resize((size + PAGE_SIZE - 1) / PAGE_SIZE);
+        }
+
+        // \brief drops every page, new slots hold T{}
+        // \param size: number of slots
+        void resize(const size_t & size)
+        {
+            assign(size, T{});
+        }
+
+        // \returns the slot at i, allocating its page
+        T & operator[] (const size_t & i)
+        {
+            std::unique_ptr<Page> & page = pages[i / PAGE_SIZE];
+            if (!page)
+            {
+                page.reset(new Page);
+                page->fill(fill);
+            }
+            return (*page)[i % PAGE_SIZE];
+        }
+
+        // \returns the slot at i, the initial value if its page was never allocated
+        T operator[] (const size_t & i) const
+        {
+            const std::unique_ptr<Page> & page = pages[i / PAGE_SIZE];
+            return page ? (*page)[i % PAGE_SIZE] : fill;
+        }
+
+        // \returns the slot at i, allocating its page. Throws std::out_of_range if i is not a slot.
+        T & at(const size_t & i)
+        {
+            if (i >= slots)
+            {
+                throw std::out_of_range("slot out of range\n  where(): PagedArray::at(const size_t & i)");
+            }
+            return (*this)[i];
+        }
+
+        // \returns the number of allocated pages
+        size_t return_allocated_pages() const
+        {
+            size_t allocated = 0;
+            for (const auto & page : pages)
+            {
+                allocated += page ? 1 : 0;
+            }
+            return allocated;
+        }
+
+    private:
+        static constexpr size_t PAGE_SIZE = map::TILED_BLOCK_SIZE * map::TILED_BLOCK_SIZE;
+        using Page = std::array<T, PAGE_SIZE>;
+
+        std::vector<std::unique_ptr<Page>> pages;
+        size_t slots = 0;
+        T fill{};
+    };
+
+    // \brief per-cell search state array for a grid type: paged on a TiledGrid, flat otherwise
+    template<typename GridT, typename T>
+    using SearchStateArray = std::conditional_t<paged_search_state<GridT>::value, PagedArray<T>, std::vector<T>>;
+
+    // \brief raw cell types with a sentinel border, when the grid stores them that way. nullptr otherwise.
+    template<typename GridT>
+    const uint8_t * padded_celltypes(const GridT &, const map::CellLayout &)
+    {
+        return nullptr;
+    }
+
+    // \brief a Grid in CellLayout::Padded exposes its cell types, so GridSearch can skip bounds checks
+    inline const uint8_t * padded_celltypes(const map::Grid & grid, const map::CellLayout & layout)
+    {
+        if (layout == map::CellLayout::Padded and grid.return_layout() == map::CellLayout::Padded)
+        {
+            return grid.return_celltypes().data();
+        }
+        return nullptr;
+    }
+
+    /// \brief A* on any grid type exposing the grid index API. Defaults to 8-connected with octile costs, like Astar.
+    /// Search state lives in flat arrays ordered by a map::GridIndexer and is reused between plans.
+    /// On a TiledGrid the arrays are PagedArrays in tile order, so only the tiles a search reaches get state.
+    /// \tparam Conn: neighbourhood (Connect4, Connect8, Connect16)
+    /// \tparam Cost: cost model (UniformCost, OctileCost, WeightedCost)
+    /// \tparam Open: open list (BinaryOpenList, RadixOpenList)
+    template<typename GridT, typename Conn = Connect8, typename Cost = OctileCost, typename Open = BinaryOpenList>
+    class GridSearch
+    {
+    public:
+        // \param grid_: the grid to plan on. Must outlive this object.
+        explicit GridSearch(const GridT & grid_) : GridSearch(grid_, search_layout(grid_)) {}
+
+        // \param grid_: the grid to plan on. Must outlive this object.
+        // \param layout: storage order of the search state
+        GridSearch(const GridT & grid_, const map::CellLayout & layout) : grid(grid_)
+        {
+            const auto dims = grid.return_grid_dimensions();
+            width = dims.at(0);
+            height = dims.at(1);
+            if (width < 1 or height < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): GridSearch::GridSearch(const GridT & grid_, const map::CellLayout & layout)");
+            }
+            resolution = grid.return_cell(0, 0).resolution;
+            indexer = map::GridIndexer(width, height, layout);
+            // The sentinel border is one cell wide, so only neighbourhoods of reach 1 may skip bounds checks
+            if (Conn::reach == 1)
+            {
+                raw_types = padded_celltypes(grid, layout);
+            }
+            if (raw_types)
+            {
+                // Storage index differences are the same for every cell in a linear layout
+                const int centre = indexer.index(Conn::reach, Conn::reach);
+                for (int k = 0; k < Conn::size; k++)
+                {
+                    offsets[k] = indexer.index(Conn::reach + Conn::moves[k].dx, Conn::reach + Conn::moves[k].dy) - centre;
+                }
+            }
+
+            const size_t size = indexer.size();
+            gcost.resize(size);
+            parent.resize(size);
+            opened.assign(size, 0);
+            closed.assign(size, 0);
+        }
+
+        // \brief Plans a path on the grid.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \returns: the path as a vector of Nodes. If the goal is unreachable, the path to the closest expanded cell.
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal)
+        {
+            begin(start, goal);
+            step(SearchBudget());
+            return best_path();
+        }
+
+        // \brief Starts a resumable search. Nothing is expanded until step() is called.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        void begin(const Vector2D & start, const Vector2D & goal)
+        {
+            // A new stamp invalidates all previous search state without clearing the arrays
+            stamp++;
+            expansions = 0;
+            cost = std::numeric_limits<double>::infinity();
+            status = SearchStatus::InProgress;
+
+            const Index s = grid.world2grid(Cell(start, resolution));
+            g = grid.world2grid(Cell(goal, resolution));
+            const int s_idx = indexer.index(s.x, s.y);
+            g_idx = indexer.index(g.x, g.y);
+            g_row = map::grid2rowmajor(g.x, g.y, width);
+
+            open_list = OpenList();
+            gcost.at(s_idx) = 0.0;
+            parent.at(s_idx) = -1;
+            opened.at(s_idx) = stamp;
+            const double h0 = estimate(s.x, s.y);
+            open_list.push(GridEntry{h0, h0, 0.0, s_idx, s.x, s.y});
+
+            // Fall back to the closest expanded cell if the goal is never reached
+            best_idx = s_idx;
+            best_h = h0;
+        }
+
+        // \brief Continues the search started by begin() until the goal is expanded, the open list runs out
+        // or the budget is spent. The search state persists between calls.
+        // \param budget: limits on this call
+        // \returns InProgress if the budget ran out first, Done if the goal was reached, Failed if it is unreachable
+        SearchStatus step(const SearchBudget & budget)
+        {
+            if (status != SearchStatus::InProgress)
+            {
+                return status;
+            }
+
+            BudgetTracker tracker(budget);
+            while (!open_list.empty())
+            {
+                if (tracker.exhausted())
+                {
+                    return status;
+                }
+
+                const GridEntry current = open_list.top();
+                open_list.pop();
+
+                if (closed[current.idx] == stamp or current.gcost > gcost[current.idx])
+                {
+                    continue;
+                }
+                closed[current.idx] = stamp;
+                expansions++;
+                tracker.count();
+
+                if (current.hcost < best_h)
+                {
+                    best_h = current.hcost;
+                    best_idx = current.idx;
+                }
+
+                // END condition
+                if (current.idx == g_idx)
+                {
+                    if (verbose)
+                    {
+                        std::cout << "Goal found after " << expansions << " Iterations!" << std::endl;
+                    }
+                    cost = current.gcost;
+                    status = SearchStatus::Done;
+                    return status;
+                }
+
+                // The move loop is unrolled at compile time
+                if (raw_types)
+                {
+                    expand<true>(current, open_list, std::make_index_sequence<Conn::size>{});
+                } else
+                {
+                    expand<false>(current, open_list, std::make_index_sequence<Conn::size>{});
+                }
+            }
+
+            // If we have reached this point, then there was no valid path
+            if (verbose)
+            {
+                std::cout << "No valid path! returning most complete path" << std::endl;
+            }
+            status = SearchStatus::Failed;
+            return status;
+        }
+
+        // \brief The best path so far: to the goal once it is reached, otherwise to the expanded cell
+        // closest to the goal. Can be called at any point of a resumable search.
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> best_path() const
+        {
+            return trace_path(status == SearchStatus::Done ? g_idx : best_idx, g);
+        }
+
+        // \returns the state of the last search
+        SearchStatus return_status() const
+        {
+            return status;
+        }
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const
+        {
+            return cost;
+        }
+
+        // \returns the number of cells expanded by the last plan
+        int return_expansions() const
+        {
+            return expansions;
+        }
+
+        // \brief turns the progress messages printed by each plan on or off (on by default)
+        void set_verbose(const bool & verbose_)
+        {
+            verbose = verbose_;
+        }
+
+        // \brief also bounds the heuristic with landmark distance tables (ALT), which follow the walls of the map
+        // \param landmarks_: tables built for this grid with the same Conn and Cost (see build_landmarks), or nullptr
+        // to use only the cost model's heuristic. Must outlive their use.
+        void set_landmarks(const Landmarks * landmarks_)
+        {
+            landmarks = landmarks_;
+        }
+
+    private:
+        using OpenList = Open;
+
+        // Step costs of Conn's moves under Cost, in grid units
+        static constexpr std::array<double, Conn::size> STEPS = step_table<Conn, Cost>();
+
+        // \brief expands every move of Conn from current
+        // \tparam Raw: read cell types from the sentinel-bordered array, without bounds checks
+        template<bool Raw, size_t... K>
+        void expand(const GridEntry & current, OpenList & open_list, std::index_sequence<K...>)
+        {
+            (expand_move<Raw, K>(current, open_list), ...);
+        }
+
+        // \brief expands move K of Conn from current
+        template<bool Raw, size_t K>
+        void expand_move(const GridEntry & current, OpenList & open_list)
+        {
+            constexpr GridMove move = Conn::moves[K];
+            const int nx = current.x + move.dx;
+            const int ny = current.y + move.dy;
+
+            int nidx;
+            uint8_t type;
+            if constexpr (Raw)
+            {
+                // Sentinel border: the neighbour index is valid and border cells read as blocked
+                nidx = current.idx + offsets[K];
+                type = raw_types[nidx];
+            } else
+            {
+                if (nx < 0 or nx >= width or ny < 0 or ny >= height)
+                {
+                    return;
+                }
+                nidx = indexer.index(nx, ny);
+                type = static_cast<uint8_t>(grid.celltype(nx, ny));
+            }
+
+            const double weight = Cost::weights[type];
+            // Blocked cells first, so reading their state never allocates a page
+            if (weight == 0.0 or closed[nidx] == stamp)
+            {
+                return;
+            }
+
+            if constexpr (move.has_via)
+            {
+                // Both cells crossed by the move lie between two in-bounds cells, so they are in bounds too
+                if (Cost::weights[static_cast<uint8_t>(grid.celltype(current.x + move.via1_dx, current.y + move.via1_dy))] == 0.0 or
+                    Cost::weights[static_cast<uint8_t>(grid.celltype(current.x + move.via2_dx, current.y + move.via2_dy))] == 0.0)
+                {
+                    return;
+                }
+            }
+
+            relax(current, nidx, nx, ny, STEPS[K] * weight * resolution, open_list);
+        }
+
+        // \brief pushes a neighbour if the path through current is shorter
+        void relax(const GridEntry & current, const int & nidx, const int & nx, const int & ny,
+                   const double & step, OpenList & open_list)
+        {
+            const double tentative = current.gcost + step;
+            if (opened[nidx] != stamp or tentative < gcost[nidx])
+            {
+                opened[nidx] = stamp;
+                gcost[nidx] = tentative;
+                parent[nidx] = current.idx;
+                const double h = estimate(nx, ny);
+                open_list.push(GridEntry{tentative + h, h, tentative, nidx, nx, ny});
+            }
+        }
+
+        // \brief the cost model's heuristic in world units (octile by default, matching Astar::heuristic)
+        double heuristic(const int & x1, const int & y1, const int & x2, const int & y2) const
+        {
+            return Cost::template heuristic<Conn>(std::abs(x1 - x2), std::abs(y1 - y2)) * resolution;
+        }
+
+        // \brief the search's estimate of the cost from a cell to the goal: the cost model's heuristic,
+        // raised to the landmark bound if there are landmarks
+        double estimate(const int & x, const int & y) const
+        {
+            const double h = heuristic(x, y, g.x, g.y);
+            if (landmarks)
+            {
+                return std::max(h, landmarks->lower_bound(map::grid2rowmajor(x, y, width), g_row));
+            }
+            return h;
+        }
+
+        // \brief returns the path from the start to idx as Nodes. Node IDs are row-major, whatever the layout.
+        std::vector<Node> trace_path(const int & idx, const Index & goal) const
+        {
+            std::vector<Node> path;
+            for (int i = idx; i != -1; i = parent[i])
+            {
+                int x = 0;
+                int y = 0;
+                indexer.coords(i, x, y);
+                Node node;
+                node.cell = grid.return_cell(x, y);
+                node.id = map::grid2rowmajor(x, y, width);
+                node.gcost = gcost[i];
+                node.hcost = heuristic(x, y, goal.x, goal.y);
+                node.fcost = node.gcost + node.hcost;
+                if (!path.empty())
+                {
+                    path.back().parent_id = node.id;
+                }
+                path.push_back(node);
+            }
+            std::reverse(path.begin(), path.end());
+
+            if (verbose)
+            {
+                std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+            }
+            return path;
+        }
+
+        const GridT & grid;
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        map::GridIndexer indexer;
+        // Grid cell types in indexer order with a sentinel border, or nullptr
+        const uint8_t * raw_types = nullptr;
+        // Storage index differences to the neighbours, in Conn::moves order (only set with raw_types)
+        std::array<int, Conn::size> offsets{};
+
+        // Search state in indexer order, valid for a cell only if its stamp matches the current one
+        SearchStateArray<GridT, double> gcost;
+        SearchStateArray<GridT, int> parent;
+        SearchStateArray<GridT, uint32_t> opened;
+        SearchStateArray<GridT, uint32_t> closed;
+        uint32_t stamp = 0;
+
+        // Resumable search state
+        OpenList open_list;
+        Index g;
+        int g_idx = 0;
+        // Row-major index of the goal, for the landmark tables
+        int g_row = 0;
+        int best_idx = 0;
+        double best_h = 0.0;
+        SearchStatus status = SearchStatus::Failed;
+
+        double cost = std::numeric_limits<double>::infinity();
+        int expansions = 0;
+        bool verbose = true;
+        const Landmarks * landmarks = nullptr;
+    };
+}
+
+#endif
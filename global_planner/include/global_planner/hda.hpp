@@ -0,0 +1,484 @@
+#ifndef HDA_INCLUDE_GUARD_HPP
+#define HDA_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Hash Distributed A* (HDA*): grid A* spread over threads. Each cell belongs to one thread, picked by
+/// hashing the zone (block of cells) it lies in. Every thread searches its own cells with its own open list and
+/// sends relaxations of other threads' cells to their lock-free inboxes. Same policies and path cost as GridSearch.
+
+#include "global_planner/grid_search.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace global
+{
+    /// \brief parallel A* on any grid type exposing the grid index API. The grid is only read, from every thread.
+    /// A path is proven optimal once no thread holds a cell with an f cost below the best goal cost found and no
+    /// relaxation is in flight, so the result costs the same as GridSearch::plan.
+    /// \tparam Conn: neighbourhood (Connect4, Connect8, Connect16)
+    /// \tparam Cost: cost model (UniformCost, OctileCost, WeightedCost)
+    template<typename GridT, typename Conn = Connect8, typename Cost = OctileCost>
+    class ParallelGridSearch
+    {
+    public:
+        // \param grid_: the grid to plan on. Must outlive this object and not change while planning.
+        // \param threads_: number of search threads. 0 uses one per hardware thread.
+        // \param zone_: side of the square blocks of cells owned by one thread. Larger zones send fewer messages
+        // between threads, smaller ones share the work of a search front more evenly.
+        explicit ParallelGridSearch(const GridT & grid_, const int & threads_ = 0, const int & zone_ = 8) : grid(grid_)
+        {
+            if (zone_ < 1)
+            {
+                throw std::invalid_argument("The zone side must be at least one cell\n  where(): ParallelGridSearch::ParallelGridSearch(const GridT & grid_, const int & threads_, const int & zone_)");
+            }
+            threads = threads_ > 0 ? threads_ : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            zone = zone_;
+
+            const auto dims = grid.return_grid_dimensions();
+            width = dims.at(0);
+            height = dims.at(1);
+            if (width < 1 or height < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): ParallelGridSearch::ParallelGridSearch(const GridT & grid_, const int & threads_, const int & zone_)");
+            }
+            resolution = grid.return_cell(0, 0).resolution;
+
+            const size_t size = static_cast<size_t>(width) * static_cast<size_t>(height);
+            gcost.resize(size);
+            parent.resize(size);
+            opened.assign(size, 0);
+        }
+
+        // \brief Plans a path on the grid with all threads.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \returns: the path as a vector of Nodes. If the goal is unreachable, the path to the closest expanded cell.
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal)
+        {
+            // A new stamp invalidates all previous search state without clearing the arrays
+            stamp++;
+            const Index s = grid.world2grid(Cell(start, resolution));
+            g = grid.world2grid(Cell(goal, resolution));
+            g_idx = map::grid2rowmajor(g.x, g.y, width);
+            incumbent.store(std::numeric_limits<double>::infinity());
+            done.store(false);
+            // Every thread starts busy and counts itself out when it runs out of work
+            active.store(threads);
+
+            workers.clear();
+            for (int i = 0; i < threads; i++)
+            {
+                workers.emplace_back(new Worker());
+            }
+
+            const int s_idx = map::grid2rowmajor(s.x, s.y, width);
+            gcost[s_idx] = 0.0;
+            parent[s_idx] = -1;
+            opened[s_idx] = stamp;
+            const double h0 = heuristic(s.x, s.y);
+            Worker & first = *workers.at(owner(s.x, s.y));
+            first.open_list.push(GridEntry{h0, h0, 0.0, s_idx, s.x, s.y});
+            first.best_idx = s_idx;
+            first.best_h = h0;
+
+            std::vector<std::thread> pool;
+            for (int i = 0; i < threads; i++)
+            {
+                pool.emplace_back(&ParallelGridSearch::work, this, i);
+            }
+            for (auto & thread : pool)
+            {
+                thread.join();
+            }
+
+            cost = incumbent.load();
+            expansions = 0;
+            messages = 0;
+            int best_idx = s_idx;
+            double best_h = h0;
+            for (const auto & worker : workers)
+            {
+                expansions += worker->expansions;
+                messages += worker->sent;
+                if (worker->best_h < best_h)
+                {
+                    best_h = worker->best_h;
+                    best_idx = worker->best_idx;
+                }
+            }
+
+            if (cost < std::numeric_limits<double>::infinity())
+            {
+                status = SearchStatus::Done;
+                if (verbose)
+                {
+                    std::cout << "Goal found after " << expansions << " Iterations on " << threads << " threads!" << std::endl;
+                }
+                return trace_path(g_idx);
+            }
+
+            status = SearchStatus::Failed;
+            if (verbose)
+            {
+                std::cout << "No valid path! returning most complete path" << std::endl;
+            }
+            return trace_path(best_idx);
+        }
+
+        // \returns the state of the last search
+        SearchStatus return_status() const
+        {
+            return status;
+        }
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const
+        {
+            return cost;
+        }
+
+        // \returns the number of cells expanded by the last plan over all threads. A cell may be expanded more
+        // than once when a cheaper path to it arrives late from another thread.
+        long return_expansions() const
+        {
+            return expansions;
+        }
+
+        // \returns the number of relaxations the last plan sent between threads
+        long return_messages() const
+        {
+            return messages;
+        }
+
+        // \returns the number of search threads
+        int return_threads() const
+        {
+            return threads;
+        }
+
+        // \brief turns the progress messages printed by each plan on or off (on by default)
+        void set_verbose(const bool & verbose_)
+        {
+            verbose = verbose_;
+        }
+
+    private:
+        // \brief a relaxation of a cell owned by another thread
+        struct Message
+        {
+            double gcost;
+            int idx;
+            int x;
+            int y;
+            int parent;
+        };
+
+        // \brief messages sent together, linked into the receiver's inbox
+        struct Batch
+        {
+            std::vector<Message> messages;
+            Batch * next = nullptr;
+        };
+
+        // \brief state of one search thread. Only the owner touches its open list and its cells' search state.
+        struct Worker
+        {
+            ~Worker()
+            {
+                release(inbox.exchange(nullptr));
+            }
+
+            BinaryOpenList open_list;
+            // Lock-free stack of Batches sent to this thread: any thread pushes, the owner takes them all at once
+            std::atomic<Batch *> inbox{nullptr};
+            // Relaxations waiting to be sent, per receiving thread
+            std::vector<std::vector<Message>> outbox;
+            long expansions = 0;
+            long sent = 0;
+            int best_idx = -1;
+            double best_h = std::numeric_limits<double>::infinity();
+        };
+
+        // Messages buffered for one thread before they are sent as a Batch, even mid-round
+        static constexpr size_t BATCH_SIZE = 64;
+        // Expansions between checks of the inbox. Every outbox is flushed after each round.
+        static constexpr int EXPANSIONS_PER_POLL = 32;
+
+        // Step costs of Conn's moves under Cost, in grid units
+        static constexpr std::array<double, Conn::size> STEPS = step_table<Conn, Cost>();
+
+        // \brief deletes a list of Batches
+        static void release(Batch * batch)
+        {
+            while (batch)
+            {
+                Batch * next = batch->next;
+                delete batch;
+                batch = next;
+            }
+        }
+
+        // \brief thread that owns a cell: a hash of the cell's zone
+        int owner(const int & x, const int & y) const
+        {
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(x / zone)) << 32) | static_cast<uint32_t>(y / zone);
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<int>(key % static_cast<uint64_t>(threads));
+        }
+
+        // \brief search loop of thread id: expands its cells until no thread has work below the best goal cost
+        // and no message is in flight. active counts busy threads plus unread messages, so it only reaches zero
+        // once the whole search has run dry.
+        void work(const int id)
+        {
+            Worker & self = *workers.at(id);
+            self.outbox.assign(threads, std::vector<Message>());
+            bool idle = false;
+
+            while (!done.load())
+            {
+                Batch * received = self.inbox.exchange(nullptr, std::memory_order_acquire);
+                if (received)
+                {
+                    if (idle)
+                    {
+                        active.fetch_add(1);
+                        idle = false;
+                    }
+                    long count = 0;
+                    for (Batch * batch = received; batch; batch = batch->next)
+                    {
+                        for (const auto & message : batch->messages)
+                        {
+                            relax(self, message.idx, message.x, message.y, message.gcost, message.parent);
+                        }
+                        count += static_cast<long>(batch->messages.size());
+                    }
+                    release(received);
+                    active.fetch_sub(count);
+                }
+
+                int expanded = 0;
+                while (expanded < EXPANSIONS_PER_POLL and !self.open_list.empty())
+                {
+                    const GridEntry current = self.open_list.top();
+                    if (current.fcost >= incumbent.load(std::memory_order_relaxed))
+                    {
+                        // Nothing here can beat the goal cost found, nor can anything this thread receives later
+                        self.open_list = BinaryOpenList();
+                        break;
+                    }
+                    self.open_list.pop();
+                    if (current.gcost > gcost[current.idx])
+                    {
+                        continue;
+                    }
+                    self.expansions++;
+                    expanded++;
+
+                    if (current.hcost < self.best_h)
+                    {
+                        self.best_h = current.hcost;
+                        self.best_idx = current.idx;
+                    }
+
+                    if (current.idx == g_idx)
+                    {
+                        double best = incumbent.load();
+                        while (current.gcost < best and !incumbent.compare_exchange_weak(best, current.gcost))
+                        {
+                        }
+                        continue;
+                    }
+
+                    expand(self, current, std::make_index_sequence<Conn::size>{});
+                }
+
+                // Other threads get this round's relaxations now, not when a batch fills up or this thread runs
+                // dry, so they neither wait for work nor expand cells at stale g costs
+                flush(self);
+                if (!self.open_list.empty())
+                {
+                    continue;
+                }
+
+                // Out of work: count this thread out
+                if (!idle)
+                {
+                    idle = true;
+                    if (active.fetch_sub(1) == 1)
+                    {
+                        done.store(true);
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        // \brief expands every move of Conn from current
+        template<size_t... K>
+        void expand(Worker & self, const GridEntry & current, std::index_sequence<K...>)
+        {
+            (expand_move<K>(self, current), ...);
+        }
+
+        // \brief expands move K of Conn from current, relaxing the neighbour here or sending it to its owner
+        template<size_t K>
+        void expand_move(Worker & self, const GridEntry & current)
+        {
+            constexpr GridMove move = Conn::moves[K];
+            const int nx = current.x + move.dx;
+            const int ny = current.y + move.dy;
+            if (nx < 0 or nx >= width or ny < 0 or ny >= height)
+            {
+                return;
+            }
+
+            const double weight = Cost::weights[static_cast<uint8_t>(grid.celltype(nx, ny))];
+            if (weight == 0.0)
+            {
+                return;
+            }
+
+            if constexpr (move.has_via)
+            {
+                // Both cells crossed by the move lie between two in-bounds cells, so they are in bounds too
+                if (Cost::weights[static_cast<uint8_t>(grid.celltype(current.x + move.via1_dx, current.y + move.via1_dy))] == 0.0 or
+                    Cost::weights[static_cast<uint8_t>(grid.celltype(current.x + move.via2_dx, current.y + move.via2_dy))] == 0.0)
+                {
+                    return;
+                }
+            }
+
+            const int nidx = map::grid2rowmajor(nx, ny, width);
+            const double tentative = current.gcost + STEPS[K] * weight * resolution;
+            const int receiver = owner(nx, ny);
+            if (&self == workers[receiver].get())
+            {
+                relax(self, nidx, nx, ny, tentative, current.idx);
+                return;
+            }
+
+            auto & out = self.outbox[receiver];
+            out.push_back(Message{tentative, nidx, nx, ny, current.idx});
+            if (out.size() >= BATCH_SIZE)
+            {
+                send(self, receiver);
+            }
+        }
+
+        // \brief opens a cell owned by self if the path through parent_idx is shorter
+        void relax(Worker & self, const int & idx, const int & x, const int & y, const double & tentative,
+                   const int & parent_idx)
+        {
+            if (opened[idx] != stamp or tentative < gcost[idx])
+            {
+                opened[idx] = stamp;
+                gcost[idx] = tentative;
+                parent[idx] = parent_idx;
+                const double h = heuristic(x, y);
+                self.open_list.push(GridEntry{tentative + h, h, tentative, idx, x, y});
+            }
+        }
+
+        // \brief pushes the messages buffered for one thread onto its inbox
+        void send(Worker & self, const int & receiver)
+        {
+            auto & out = self.outbox[receiver];
+            if (out.empty())
+            {
+                return;
+            }
+            Batch * batch = new Batch();
+            batch->messages.swap(out);
+            out.reserve(BATCH_SIZE);
+            self.sent += static_cast<long>(batch->messages.size());
+            // Counted before they can be read, while this thread is still busy
+            active.fetch_add(static_cast<long>(batch->messages.size()));
+
+            std::atomic<Batch *> & inbox = workers[receiver]->inbox;
+            batch->next = inbox.load(std::memory_order_relaxed);
+            while (!inbox.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // \brief sends every buffered message
+        void flush(Worker & self)
+        {
+            for (int receiver = 0; receiver < threads; receiver++)
+            {
+                send(self, receiver);
+            }
+        }
+
+        // \brief the cost model's heuristic from a cell to the goal, in world units
+        double heuristic(const int & x, const int & y) const
+        {
+            return Cost::template heuristic<Conn>(std::abs(x - g.x), std::abs(y - g.y)) * resolution;
+        }
+
+        // \brief returns the path from the start to idx as Nodes, with row-major IDs like GridSearch
+        std::vector<Node> trace_path(const int & idx) const
+        {
+            std::vector<Node> path;
+            for (int i = idx; i != -1; i = parent[i])
+            {
+                const int x = i % width;
+                const int y = i / width;
+                Node node;
+                node.cell = grid.return_cell(x, y);
+                node.id = i;
+                node.gcost = gcost[i];
+                node.hcost = heuristic(x, y);
+                node.fcost = node.gcost + node.hcost;
+                if (!path.empty())
+                {
+                    path.back().parent_id = node.id;
+                }
+                path.push_back(node);
+            }
+            std::reverse(path.begin(), path.end());
+
+            if (verbose)
+            {
+                std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+            }
+            return path;
+        }
+
+        const GridT & grid;
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        int threads = 1;
+        int zone = 8;
+
+        // Search state in row-major order, valid for a cell only if its stamp matches the current one.
+        // Each cell is only written by the thread that owns it.
+        std::vector<double> gcost;
+        std::vector<int> parent;
+        std::vector<uint32_t> opened;
+        uint32_t stamp = 0;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        Index g;
+        int g_idx = 0;
+        // Lowest goal cost found so far
+        std::atomic<double> incumbent{std::numeric_limits<double>::infinity()};
+        // Busy threads plus messages sent but not yet read
+        std::atomic<long> active{0};
+        std::atomic<bool> done{false};
+
+        SearchStatus status = SearchStatus::Failed;
+        double cost = std::numeric_limits<double>::infinity();
+        long expansions = 0;
+        long messages = 0;
+        bool verbose = true;
+    };
+}
+
+#endif
@@ -4,11 +4,19 @@
 /// \brief Heuristic search library to encompass A*, Theta* planners.
 
 #include "global_planner/global_planner.hpp"
+#include <map/grid_view.hpp>
+#include <map/snapshot.hpp>
+#include <map/tiled_grid.hpp>
+#include <map/quadtree.hpp>
 #include <queue>
 #include <set>
+#include <unordered_map>
 
 namespace global
 {
+    class PathCache;
+    class RoadmapSnapper;
+
     // Used to store Obstacle vertex coordinates
     using rigid2d::Vector2D;
     using map::Vertex;
@@ -40,7 +48,9 @@ namespace global
         double rhs = 1e12;
 
         // NOTE: gcost will be initialized to 1e12 (inf) for LPA* and D* Lite
-        double gcost, hcost, fcost = 0.0;
+        double gcost = 0.0;
+        double hcost = 0.0;
+        double fcost = 0.0;
 
         // Store children for update using incremental gridmap
         std::vector<int> children_ids;
@@ -78,9 +88,9 @@ namespace global
         // \brief Plans a path on a PRM.
         // \param start: the starting coordinates
         // \param goal: the goal coordinates
-        // \param map: the PRM - may be modified if shorter paths are found
+        // \param map: the PRM
         // \returns: the path as a vector of Nodes
-        virtual std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, std::vector<Vertex> & map);
+        virtual std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const std::vector<Vertex> & map);
 
         // \brief potentially modify the g cost and parent of a Node in PRM. virtual so it can be overriden by Thetastar.
         // \param open_list: list containing nodes to evaluate. Not const because it can be modified
@@ -92,6 +102,12 @@ namespace global
         // \param neighbour: Node to be added to open list (also not const)
         virtual void create_vtx(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node);
 
+        // \brief called on each Node taken off the open list in PRM, before it is closed and its neighbours are
+        // evaluated. Does nothing in A*. virtual so it can be overriden by LazyThetastar.
+        // \param current_node: the Node being expanded (not const because its parent may change)
+        // \param closed_list: Nodes already expanded
+        virtual void expand_vtx(Node & current_node, const std::set<Node, std::less<>> & closed_list);
+
         // \brief returns the path planned on the PRM or GRID
         // \param closed_list: Nodes to traverse
         std::vector<Node> trace_path(const Node & final_node, const std::set<Node, std::less<>> & closed_list);
@@ -103,6 +119,44 @@ namespace global
         // \returns: the path as a vector of Nodes
         std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::Grid & grid_, const double & resolution);
 
+        // \brief Plans a path on a Grid snapshot published in shared memory, without copying it.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param view: read-only view attached to the shared Grid
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::GridView & view);
+
+        // \brief Plans a path on a versioned Grid snapshot. Commits made while planning do not affect the result.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param snapshot: the snapshot to plan on, eg: VersionedGrid::snapshot()
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot);
+
+        // \brief Plans a path on a versioned Grid snapshot, answering queries between the same cells from the
+        // cache while the snapshot's epoch is current for them. Only paths that reach the goal are cached.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param snapshot: the snapshot to plan on, eg: VersionedGrid::snapshot()
+        // \param cache: the path cache, kept up to date with PathCache::invalidate after each commit
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot, PathCache & cache);
+
+        // \brief Plans a path on a sparse tiled Grid.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param tiled: the built TiledGrid
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::TiledGrid & tiled);
+
+        // \brief Plans a path over the Free leaves of a quadtree. Nodes are leaves, joined through their centres,
+        // so each edge costs the distance between the centres of two touching leaves.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param tree: the built QuadTree
+        // \returns: the path as a vector of Nodes, whose cells cover whole leaves
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const map::QuadTree & tree);
+
         // \brief potentially modify the g cost and parent of a Node in GRID. virtual so it can be overriden by Thetastar.
         // \param open_list: list containing nodes to evaluate. Not const because it can be modified
         // \param neighbour: Node in the open list being potentially modified (also not const)
@@ -122,8 +176,17 @@ namespace global
 
         // \brief retrieves the 8 neighbours of a node in a grid
         // \param n: Node whose neighbours to retrieve
+        // \param grid: the grid, whose extent bounds the neighbours
         // \returns: vector of Nodes that are n's neighbours
-        std::vector<Cell> get_neighbours(const Node & n, const std::vector<Cell> & map);
+        std::vector<Cell> get_neighbours(const Node & n, const map::Grid & grid);
+
+        // \brief attaches start and goal to a PRM through a spatial index, choosing the closest Vertex in line of
+        // sight, instead of scanning every Vertex for the closest one
+        // \param snapper_: built for the roadmaps passed to plan, or nullptr to scan. Must outlive its use.
+        void set_snapper(const RoadmapSnapper * snapper_);
+
+    protected:
+        const RoadmapSnapper * snapper = nullptr;
     };
 
     /// \brief Theta* Planner
@@ -143,18 +206,68 @@ namespace global
         // \param open_list: list containing nodes to evaluate. Not const because it can be modified
         // \param neighbour: Node in the open list being potentially modified (also not const)
         void update_vtx(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node) override;
+
+    protected:
+        // \brief checks that the segment between two Vertices clears every obstacle by the robot's radius
+        // \param v1: the first Vertex
+        // \param v2: the second Vertex
+        // \returns true if the segment is collision free
+        bool line_of_sight(const Vertex & v1, const Vertex & v2);
+    };
+
+    /// \brief Lazy Theta* Planner (Nash, Koenig and Tovey 2010). Neighbours take the parent of the current Node
+    /// as their parent without a line of sight check, which is only done once per expanded Node. If the check
+    /// fails, the Node falls back to its best expanded roadmap neighbour as parent.
+    class LazyThetastar : public Thetastar
+    {
+    public:
+
+        // Inherit constructor from A*
+        using Thetastar::Thetastar;
+        using Astar::plan;
+
+        // \brief Overriden: forgets the open list g costs of the previous query, then plans as A*
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \param map: the PRM
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal, const std::vector<Vertex> & map) override;
+
+        // \brief Overriden: insert a Node into the open list with the parent of current_node as parent, assuming
+        // line of sight
+        // \param open_list: list containing nodes to evaluate. Not const because it can be modified
+        // \param neighbour: Node to be added to open list (also not const)
+        void create_vtx(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node) override;
+
+        // \brief Overriden: potentially modify the g cost and parent of a Node in PRM, assuming line of sight from
+        // the parent of current_node
+        // \param open_list: list containing nodes to evaluate. Not const because it can be modified
+        // \param neighbour: Node in the open list being potentially modified (also not const)
+        void update_vtx(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node) override;
+
+        // \brief Overriden: checks line of sight to the parent of the expanded Node. If it is blocked, the parent
+        // becomes the expanded roadmap neighbour with the lowest g cost plus edge length.
+        // \param current_node: the Node being expanded (not const because its parent may change)
+        // \param closed_list: Nodes already expanded
+        void expand_vtx(Node & current_node, const std::set<Node, std::less<>> & closed_list) override;
+
+    private:
+        // g cost of each Node on the open list, so that update_vtx only re-sorts it on an improvement
+        std::unordered_map<int, double> open_gcost;
     };
 
 
     // \brief returns the vertex that most closely matches the given cartesian coordinates in PRM
     // \param position: the coordinates
     // \param map: the map whose elements are being searched for coordinates
-    Vertex find_nearest_node(const Vector2D & position, const std::vector<Vertex> & map);
+    // \returns const reference to the matching element of map
+    const Vertex & find_nearest_node(const Vector2D & position, const std::vector<Vertex> & map);
 
     // \brief returns the vertex that most closely matches the given cartesian coordinates in GRID
     // \param position: the coordinates
     // \param map: the map whose elements are being searched for coordinates
-    Cell find_nearest_node(const Vector2D & position, const Grid & grid, const double & resolution);
+    // \returns const reference to the matching cell of grid
+    const Cell & find_nearest_node(const Vector2D & position, const Grid & grid, const double & resolution);
 }
 
 #endif
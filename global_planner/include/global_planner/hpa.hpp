@@ -0,0 +1,181 @@
+#ifndef HPA_INCLUDE_GUARD_HPP
+#define HPA_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Hierarchical path-finding (HPA*) over a grid: the grid is split into square clusters joined by entrances,
+/// long queries are searched on the abstract graph and then refined inside each cluster.
+
+#include "global_planner/heuristic.hpp"
+#include "global_planner/grid_policies.hpp"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace global
+{
+    using rigid2d::Vector2D;
+    using map::Cell;
+    using map::Index;
+
+    // \brief edge of the abstract graph
+    struct AbstractEdge
+    {
+        // ID of the AbstractNode the edge leads to
+        int to;
+        // Shortest path length in world units
+        double cost;
+        // true between the two sides of an entrance, false inside a cluster
+        bool inter;
+    };
+
+    // \brief entrance cell of a cluster
+    struct AbstractNode
+    {
+        int x = -1;
+        int y = -1;
+        int cluster = -1;
+        std::vector<AbstractEdge> edges;
+        // false once its entrance is removed. The ID is then reused.
+        bool alive = false;
+    };
+
+    // \brief pair of AbstractNodes facing each other across a cluster border.
+    // a is in the cluster with the lower ID.
+    struct Entrance
+    {
+        int a;
+        int b;
+    };
+
+    /// \brief HPA* planner. Keeps its own copy of the cell types (one byte per cell), so it can be
+    /// repaired in place when cells change. 8-connected with octile costs, like GridSearch.
+    class HPAstar
+    {
+    public:
+        // \brief builds the abstract graph from any grid exposing the grid index API
+        // \param grid: the grid (eg: map::Grid, map::GridView)
+        // \param cluster_size_: side length of a cluster in cells
+        template<typename GridT>
+        HPAstar(const GridT & grid, const int & cluster_size_)
+        {
+            const auto dims = grid.return_grid_dimensions();
+            if (dims.at(0) < 1 or dims.at(1) < 1)
+            {
+                throw std::invalid_argument("The grid has no cells, build the map first\n  where(): HPAstar::HPAstar(const GridT & grid, const int & cluster_size_)");
+            }
+            std::vector<double> xs(dims.at(0));
+            std::vector<double> ys(dims.at(1));
+            for (int x = 0; x < dims.at(0); x++)
+            {
+                xs[x] = grid.return_cell(x, 0).coords.x;
+            }
+            for (int y = 0; y < dims.at(1); y++)
+            {
+                ys[y] = grid.return_cell(0, y).coords.y;
+            }
+
+            std::vector<uint8_t> cell_types(static_cast<size_t>(dims.at(0)) * dims.at(1));
+            for (int y = 0; y < dims.at(1); y++)
+            {
+                for (int x = 0; x < dims.at(0); x++)
+                {
+                    cell_types[map::grid2rowmajor(x, y, dims.at(0))] = static_cast<uint8_t>(grid.celltype(x, y));
+                }
+            }
+            build(xs, ys, grid.return_cell(0, 0).resolution, cell_types, cluster_size_);
+        }
+
+        // \brief Plans a path: abstract search between entrances, then refinement inside each cluster.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \returns: the path as a vector of Nodes, empty if the goal is unreachable
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal);
+
+        // \brief applies cell type changes and repairs only the clusters they affect
+        // \param changes: cells with updated celltype (eg: the return of Grid::update_grid)
+        // \returns the number of clusters whose abstract edges were recomputed
+        int update(const std::vector<Cell> & changes);
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const;
+
+        // \returns the number of abstract nodes expanded by the last plan
+        int return_expansions() const;
+
+        // \returns the number of live abstract nodes
+        int return_abstract_nodes() const;
+
+    private:
+        // \brief stores the cell types and builds every entrance and intra-cluster edge
+        void build(const std::vector<double> & xcells_, const std::vector<double> & ycells_, const double & resolution_,
+                   const std::vector<uint8_t> & cell_types, const int & cluster_size_);
+
+        // \brief recomputes the entrances of a border between two clusters
+        void build_border(const int & border);
+
+        // \brief recomputes the intra-cluster edges between the entrances of a cluster
+        void build_cluster(const int & cluster);
+
+        // \returns the IDs of the borders around a cluster
+        std::vector<int> cluster_borders(const int & cluster) const;
+
+        // \returns the IDs of the live AbstractNodes of a cluster
+        std::vector<int> cluster_nodes(const int & cluster) const;
+
+        // \returns the cluster containing a cell
+        int cluster_of(const int & x, const int & y) const;
+
+        // \brief Dijkstra from a cell, restricted to one cluster
+        // \param cluster: the cluster to search in
+        // \param sx: x-coordinate of the source cell (inside cluster)
+        // \param sy: y-coordinate of the source cell (inside cluster)
+        // \param dist: set to the distance of each cluster cell, in cluster-local row-major order
+        // \param parent: set to the local parent of each cluster cell (-1 for the source and unreached cells)
+        void cluster_dijkstra(const int & cluster, const int & sx, const int & sy,
+                              std::vector<double> & dist, std::vector<int> & parent) const;
+
+        // \brief appends the cells of the in-cluster path from (x1, y1) to (x2, y2) to path, excluding the first cell
+        void refine(const int & cluster, const int & x1, const int & y1, const int & x2, const int & y2,
+                    std::vector<Index> & cells) const;
+
+        // \returns a new AbstractNode ID, reusing removed ones
+        int add_node(const int & x, const int & y);
+
+        // \brief whether a cell can be traversed
+        bool is_free(const int & x, const int & y) const
+        {
+            return types[map::grid2rowmajor(x, y, width)] == map::Free;
+        }
+
+        // \brief converts world coordinates to grid coordinates. Same convention as Grid::world2grid.
+        Index world2grid(const Vector2D & coords) const;
+
+        // \brief octile distance in world units
+        double heuristic(const int & x1, const int & y1, const int & x2, const int & y2) const;
+
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        // World coordinates of the cell corners along x and y, as in Grid
+        std::vector<double> xcells;
+        std::vector<double> ycells;
+        // Cell types in row-major order
+        std::vector<uint8_t> types;
+
+        int cluster_size = 0;
+        // Number of clusters along x and y
+        int clusters_x = 0;
+        int clusters_y = 0;
+        // Number of borders between horizontally adjacent clusters. Their IDs come first.
+        int vertical_borders = 0;
+
+        std::vector<AbstractNode> nodes;
+        std::vector<int> free_ids;
+        // Entrances of each border
+        std::vector<std::vector<Entrance>> borders;
+
+        double cost = std::numeric_limits<double>::infinity();
+        int expansions = 0;
+    };
+}
+
+#endif
@@ -4,6 +4,8 @@
 /// \brief Incremental search library to encompass LPA* and D* Lite planners. I might add Incr. Phi* in the future.
 
 #include "global_planner/heuristic.hpp"
+#include "global_planner/search_budget.hpp"
+#include "global_planner/radix_heap.hpp"
 
 namespace global
 {
@@ -31,6 +33,34 @@ namespace global
     }; 
 
 
+    // \brief radix heap open list entry for LPA*: a Node's keys when it was queued. Entries whose version no
+    // longer matches the Node's are stale and skipped when popped (lazy deletion).
+    struct OpenKey
+    {
+        double key1;
+        double key2;
+        // FakeGrid index of the Node
+        int id;
+        uint32_t version;
+    };
+
+    // \brief same ordering as KeyComparator, for OpenKeys
+    class OpenKeyComparator
+    {
+    public:
+        bool operator() (const OpenKey & k1, const OpenKey & k2) const
+        {
+            if (rigid2d::almost_equal(k1.key1, k2.key1))
+            {
+                return k1.key2 > k2.key2;
+            } else
+            {
+                return k1.key1 > k2.key1;
+            }
+        }
+    };
+
+
     // \brief functor (function object) which compares the costs of the predecessor of a Node
     class CostComparator
     { 
@@ -54,6 +84,13 @@ namespace global
         // \returns: the path as a vector of Nodes
         void ComputeShortestPath();
 
+        // \brief Resumable ComputeShortestPath: stops when the budget is spent and carries on from the same
+        // open list on the next call.
+        // \param budget: limits on this call
+        // \returns InProgress if the budget ran out first, Done if the goal is consistent with a finite cost,
+        // Failed if it is unreachable
+        SearchStatus ComputeShortestPath(const SearchBudget & budget);
+
         // Update the cost of a cell and remove it from the open list if it's there
         // param n: the node to update
         void UpdateCell(Node & n);
@@ -63,6 +100,13 @@ namespace global
         // This guarantees that the first run of ComputeShortestPath performs an exact A* search.
         virtual void Initialize(const Vector2D & start, const Vector2D & goal, const Grid & grid_, const double & resolution);
 
+        // \brief Initialize from an immutable map version instead of a Grid, so a worker thread can plan while
+        // the Grid keeps changing (see map::VersionedGrid)
+        // \param snapshot: the FAKE Grid's cell types
+        // \param layout: storage order of the Nodes, usually the Grid's layout
+        virtual void Initialize(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot,
+                                const map::CellLayout & layout);
+
         // Calculates priorities 1 and 2 of a node, used in sorting for LPA*
         // \param n: the node whose keys we calculate
         void CalculateKeys(Node & n);
@@ -88,13 +132,61 @@ namespace global
         // \returns: nodes that had to be updated based on new information
         virtual std::vector<Node> SimulateUpdate(const std::vector<Cell> & updated_grid);
 
+        // \brief update FakeGrid (internal perception) with updated grid and queue the affected Nodes, without
+        // searching. Follow with ComputeShortestPath(budget) to replan over several calls.
+        // param updated_grid: the updated grid
+        // \returns: nodes that had to be updated based on new information
+        virtual std::vector<Node> ApplyUpdate(const std::vector<Cell> & updated_grid);
+
+        // \brief returns the path to the expanded Node closest to the goal, so a search cut short by its budget
+        // still gives a direction to head in. Starts at the search's start (the goal for D* Lite).
+        // \returns: vector of Node
+        std::vector<Node> return_partial_path() const;
+
         // \brief returns whether the current path is valid
         bool return_valid();
 
+        // \brief keeps the open list in a radix heap over fixed-point keys, with lazy deletion, instead of a
+        // binary heap searched linearly for removals. Empties the open list, so call it before Initialize.
+        // The heap is monotone: within a search keys never drop below the last one popped. Keys only go down
+        // between replans, when cells change, so the first lower push of a replan rebases the heap and
+        // redistributes the whole open list once (O(n)).
+        // Paths cost the same as with the binary heap; equal keys may be expanded in a different order.
+        // \param radix_: whether to use the radix heap (off by default)
+        void set_radix_heap(const bool & radix_);
+
     protected:
+        // \brief the part of Initialize shared by every map source: resets FakeGrid and queues the start
+        // \param start_cell: cell of the search's start
+        // \param goal_cell: cell of the search's goal
+        // \param fake_cells: the FAKE Grid in row-major order
+        // \param indexer_: storage order of the Nodes
+        void initialize_nodes(const Cell & start_cell, const Cell & goal_cell, const std::vector<Cell> & fake_cells,
+                              const map::GridIndexer & indexer_);
+
+        // \brief empties the open list
+        void open_clear();
+
+        // \brief queues a Node with its current keys, replacing any earlier entry for it
+        void open_push(const Node & n);
+
+        // \brief removes a Node from the open list if it is there
+        void open_remove(const Node & n);
+
+        // \brief reads the Node with the lowest keys
+        // \param top: set to the Node, as queued with the binary heap or as in FakeGrid with the radix heap
+        // \returns false if the open list is empty
+        bool open_top(Node & top);
+
+        // \brief removes the Node with the lowest keys. The open list must not be empty.
+        // \returns the Node
+        Node open_pop();
+
         std::vector<Node> path;
-        // Fake grid with limited visibility for simulating increment
+        // Fake grid with limited visibility for simulating increment. Node IDs are indices into it.
         std::vector<Node> FakeGrid;
+        // Maps grid coordinates to FakeGrid indices in the Grid's layout
+        map::GridIndexer indexer;
 
         // TODO: DELETE
         // Open list used for finding existing IDs
@@ -105,6 +197,13 @@ namespace global
         // Open List. Uses ref wrapper for faster execution
         std::vector<Node> open_list;   
 
+        // Radix heap open list, used instead of open_list when radix is set
+        bool radix = false;
+        RadixHeap<OpenKey, OpenKeyComparator> radix_list;
+        // Version of each FakeGrid Node's live radix_list entry, 0 if it is not queued
+        std::vector<uint32_t> queued;
+        uint32_t version = 0;
+
         // For easy management/record keeping
         Node start_node;
         Node goal_node;
@@ -118,6 +217,11 @@ namespace global
         double BIG_NUM = std::numeric_limits<double>::infinity();
 
         bool valid_path = true;
+
+        // Iterations of the current ComputeShortestPath, kept across budgeted calls
+        int iterations = 0;
+        // Expanded Node closest to the goal in the current ComputeShortestPath (-1 if none yet)
+        int best_id = -1;
     };
 
 
@@ -133,11 +237,15 @@ namespace global
         // NOTE: flips start and goal for D*Lite so that everything else stays the same
         void Initialize(const Vector2D & start, const Vector2D & goal, const Grid & grid_, const double & resolution);
 
-        // \brief update FakeGrid (internal perception) with updated grid and then
-        // use this new information to update each affected Node, and hence the path
+        // \brief Initialize from an immutable map version. Flips start and goal like the Grid version.
+        void Initialize(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot,
+                        const map::CellLayout & layout) override;
+
+        // \brief moves the goal [start in paper] one step along the path, then updates FakeGrid
+        // (internal perception) and queues the affected Nodes, without searching
         // param updated_grid: the updated grid
         // \returns: nodes that had to be updated based on new information
-        std::vector<Node> SimulateUpdate(const std::vector<Cell> & updated_grid);
+        std::vector<Node> ApplyUpdate(const std::vector<Cell> & updated_grid) override;
 
         // \brief returns the most current path. Flips path returned by LPAstar since D*L plans the opposite way
         // \returns: vector of Node
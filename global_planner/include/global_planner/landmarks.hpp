@@ -0,0 +1,131 @@
+#ifndef LANDMARKS_INCLUDE_GUARD_HPP
+#define LANDMARKS_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Landmark (ALT) heuristics. A few landmarks get the exact distance to every node, and the triangle
+/// inequality turns these tables into a lower bound between any two nodes that follows the walls of the map,
+/// unlike the Euclidean or octile distance.
+
+#include <map/prm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace global
+{
+    using map::Vertex;
+
+    /// \brief distance tables from every node to a set of landmarks. Nodes are row-major cells or PRM vertex IDs.
+    class Landmarks
+    {
+    public:
+        // \brief no landmarks: the lower bound is always 0
+        Landmarks() = default;
+
+        // \brief empty tables, filled in with set_distance
+        // \param ids_: landmark node IDs
+        // \param nodes_: number of nodes
+        // \param symmetric_: whether the distance from a to b always equals the distance from b to a
+        Landmarks(const std::vector<int> & ids_, const int & nodes_, const bool & symmetric_);
+
+        // \brief sets the distance from a node to a landmark. Threads may fill different landmarks at once.
+        // \param landmark: index of the landmark in return_landmarks()
+        // \param node: the node
+        // \param distance: its distance to the landmark, infinity if it cannot reach it
+        void set_distance(const int & landmark, const int & node, const double & distance)
+        {
+            table[static_cast<size_t>(landmark) * nodes + node] = distance;
+        }
+
+        // \brief the ALT lower bound on the distance from node to goal: d(node, L) - d(goal, L) for each
+        // landmark L, and also d(goal, L) - d(node, L) when distances are symmetric.
+        // \returns the largest bound over the landmarks (0 without landmarks)
+        double lower_bound(const int & node, const int & goal) const
+        {
+            double bound = 0.0;
+            for (size_t row = 0; row < table.size(); row += nodes)
+            {
+                const double from = table[row + node];
+                const double to = table[row + goal];
+                // Nodes cut off from a landmark get no bound from it
+                if (from == INF or to == INF)
+                {
+                    continue;
+                }
+                bound = std::max(bound, from - to);
+                if (symmetric)
+                {
+                    bound = std::max(bound, to - from);
+                }
+            }
+            return bound;
+        }
+
+        // \returns the landmark node IDs
+        const std::vector<int> & return_landmarks() const;
+
+        // \returns the number of nodes in the tables
+        int return_nodes() const;
+
+    private:
+        static constexpr double INF = std::numeric_limits<double>::infinity();
+
+        std::vector<int> ids;
+        int count = 0;
+        int nodes = 0;
+        bool symmetric = true;
+        // Distances by landmark, then node. Each build thread fills its own contiguous row, so threads
+        // only share the cache line where two rows meet.
+        std::vector<double> table;
+    };
+
+    // \brief spreads landmarks around the map: the plane is cut into count equal angular sectors about the centre
+    // of the candidates, and each sector takes its candidate farthest from the centre (planar selection,
+    // Goldberg and Harrelson 2005). Sectors without candidates are skipped.
+    // \param points: candidate coordinates
+    // \param ids: candidate node IDs, in the order of points
+    // \param count: number of landmarks wanted
+    // \returns the landmark node IDs
+    std::vector<int> select_landmarks(const std::vector<rigid2d::Vector2D> & points, const std::vector<int> & ids, const int & count);
+
+    // \brief calls fn(i) for every i in [0, n) on up to threads threads
+    // \param threads: 0 uses one per hardware thread
+    template<typename F>
+    void parallel_for(const int & n, const int & threads, F fn)
+    {
+        const int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        const int workers = std::min(n, threads > 0 ? threads : hardware);
+        std::atomic<int> next{0};
+        auto work = [&next, &n, &fn]()
+        {
+            for (int i = next++; i < n; i = next++)
+            {
+                fn(i);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < workers; t++)
+        {
+            pool.emplace_back(work);
+        }
+        // The calling thread works too
+        work();
+        for (auto & thread : pool)
+        {
+            thread.join();
+        }
+    }
+
+    // \brief picks landmarks on a PRM and computes their distance tables (Dijkstra over Euclidean edge costs)
+    // in parallel, one landmark per thread
+    // \param prm: the roadmap. Vertex IDs must be their positions in it.
+    // \param count: number of landmarks
+    // \param threads: number of threads, 0 uses one per hardware thread
+    // \returns the tables
+    Landmarks build_landmarks(const std::vector<Vertex> & prm, const int & count, const int & threads = 0);
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef PATH_CACHE_INCLUDE_GUARD_HPP
+#define PATH_CACHE_INCLUDE_GUARD_HPP
+/// \file
+/// \brief LRU cache of planned grid paths, so that repeated start/goal queries on an unchanged map are answered
+/// without searching. Entries are tagged with the map epoch they are valid for (see map::VersionedGrid) and are
+/// dropped when a commit changes a cell the path crosses.
+
+#include "global_planner/heuristic.hpp"
+#include "global_planner/grid_policies.hpp"
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace global
+{
+    // \brief identifies a query: the snapped start and goal cells (row-major) and the planner settings
+    struct PathKey
+    {
+        int start;
+        int goal;
+        // Hash of whatever changes the planned path (planner type, cost model...)
+        uint64_t settings;
+
+        bool operator==(const PathKey & other) const
+        {
+            return start == other.start and goal == other.goal and settings == other.settings;
+        }
+    };
+
+    // \brief hash for PathKey
+    struct PathKeyHash
+    {
+        size_t operator()(const PathKey & key) const
+        {
+            uint64_t h = key.settings;
+            h = (h ^ static_cast<uint32_t>(key.start)) * 1099511628211ULL;
+            h = (h ^ static_cast<uint32_t>(key.goal)) * 1099511628211ULL;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    // \brief PathKey::settings of a planner searching with the Conn neighbourhood and the Cost model. Hashes the
+    // moves, their step costs and the cell weights, so paths planned under other policies never match.
+    // \param planner: name of the planner (eg: "astar"), as planners with the same policies may return other paths
+    // \returns the settings hash
+    template<typename Conn, typename Cost>
+    uint64_t policy_settings(const std::string & planner)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        const auto mix = [&h](const uint64_t & value)
+        {
+            h = (h ^ value) * 1099511628211ULL;
+        };
+        const auto mix_double = [&mix](const double & value)
+        {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            mix(bits);
+        };
+
+        for (const char & c : planner)
+        {
+            mix(static_cast<unsigned char>(c));
+        }
+        const std::array<double, Conn::size> steps = step_table<Conn, Cost>();
+        for (int k = 0; k < Conn::size; k++)
+        {
+            mix(static_cast<uint64_t>(Conn::moves[k].dx));
+            mix(static_cast<uint64_t>(Conn::moves[k].dy));
+            mix_double(steps[k]);
+        }
+        for (const double & weight : Cost::weights)
+        {
+            mix_double(weight);
+        }
+        return h;
+    }
+
+    /// \brief LRU cache of grid paths. Safe to use from several threads.
+    /// NOTE: a path stays collision free while none of its cells change, but freeing cells elsewhere may open
+    /// a shorter path that the cache will not see until the entry is evicted or cleared.
+    class PathCache
+    {
+    public:
+        using Path = std::vector<Node>;
+
+        // \param capacity_: number of paths to keep
+        explicit PathCache(const int & capacity_ = 64);
+
+        // \brief looks up a path
+        // \param key: the query
+        // \param epoch: epoch of the map being planned on
+        // \returns the cached path, or nullptr if there is none valid for this epoch
+        std::shared_ptr<const Path> lookup(const PathKey & key, const uint64_t & epoch);
+
+        // \brief stores a path, evicting the least recently used one if the cache is full
+        // \param key: the query
+        // \param epoch: epoch of the map the path was planned on
+        // \param path: the path. Node IDs must be row-major cells.
+        // \param width: grid width in cells, to recover the cells crossed between consecutive Nodes
+        void insert(const PathKey & key, const uint64_t & epoch, const Path & path, const int & width);
+
+        // \brief records a commit: drops the paths crossing a changed cell and carries the others over to the
+        // new epoch. Paths from before the previous epoch missed a commit, so they are dropped too.
+        // \param changes: the committed cells (eg: the return of Grid::update_grid)
+        // \param epoch: the epoch published by the commit (eg: the return of VersionedGrid::commit)
+        // \returns the number of paths dropped
+        int invalidate(const std::vector<Cell> & changes, const uint64_t & epoch);
+
+        // \brief drops every path
+        void clear();
+
+        // \returns the number of lookups answered from the cache
+        int return_hits() const;
+
+        // \returns the number of lookups that missed
+        int return_misses() const;
+
+        // \returns the number of cached paths
+        int return_size() const;
+
+    private:
+        // \brief cached path with the sorted row-major cells it crosses
+        struct Entry
+        {
+            PathKey key;
+            uint64_t epoch;
+            std::shared_ptr<const Path> path;
+            std::vector<int> cells;
+        };
+
+        using Entries = std::list<Entry>;
+
+        // \brief removes an entry from the list and the index
+        void erase(const Entries::iterator & it);
+
+        int capacity;
+        mutable std::mutex mutex;
+        // Most recently used first
+        Entries entries;
+        std::unordered_map<PathKey, Entries::iterator, PathKeyHash> index;
+        int hits = 0;
+        int misses = 0;
+    };
+
+    // \brief lists every cell crossed by a path, including the cells between Nodes that are not adjacent
+    // (any-angle or knight moves). Segments through a cell corner count both cells beside the corner.
+    // \param path: the path. Node IDs must be row-major cells.
+    // \param width: grid width in cells
+    // \returns the sorted row-major cells, without duplicates
+    std::vector<int> path_cells(const std::vector<Node> & path, const int & width);
+}
+
+#endif
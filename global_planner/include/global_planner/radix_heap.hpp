@@ -0,0 +1,209 @@
+#ifndef RADIX_HEAP_INCLUDE_GUARD_HPP
+#define RADIX_HEAP_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Monotone radix heap over fixed-point costs, for searches whose popped priorities never decrease
+/// (A* with a consistent heuristic, LPA* within one ComputeShortestPath). Pushes are O(1) and pops amortized
+/// O(log C) for a cost range C, against O(log n) for both with a binary heap. Keys are rounded, so costs
+/// closer than the fixed-point step tie and may leave in a different order than from a binary heap.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace global
+{
+    // Fixed-point steps per world unit for radix heap keys: costs closer than about 1e-6 share a key
+    constexpr double FIXED_POINT_SCALE = 1048576.0;
+
+    // \brief converts a non-negative cost to a fixed-point key
+    // \param cost: the cost, in world units
+    // \param scale: fixed-point steps per world unit
+    // \returns the rounded key. Infinite or out of range costs get the largest key.
+    inline uint64_t to_fixed_point(const double & cost, const double & scale = FIXED_POINT_SCALE)
+    {
+        const double scaled = cost * scale;
+        if (!(scaled < 9.2e18))
+        {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        if (scaled <= 0.0)
+        {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::llround(scaled));
+    }
+
+    /// \brief radix heap: entries sit in buckets by the highest bit in which their key differs from the last
+    /// popped key, so each entry moves down at most once per bit before it is popped.
+    /// Entries with the same key leave in Compare order (a heap comparator such as GridEntryComparator).
+    /// Only monotone use is cheap. Pushing a key below the last popped one redistributes every entry (O(n)),
+    /// once per run of pushes between two pops.
+    /// \tparam Value: the stored entry
+    /// \tparam Compare: orders entries with equal keys, true if the first should leave after the second
+    template<typename Value, typename Compare>
+    class RadixHeap
+    {
+    public:
+        // \brief adds an entry
+        // \param key: its fixed-point priority (see to_fixed_point)
+        // \param value: the entry
+        void push(const uint64_t & key, const Value & value)
+        {
+            if (key < last)
+            {
+                rebase();
+            }
+            const int b = bucket(key);
+            buckets[b].emplace_back(key, value);
+            if (b == 0)
+            {
+                std::push_heap(buckets[0].begin(), buckets[0].end(), tie_compare);
+            }
+            count++;
+        }
+
+        // \returns the entry with the lowest key. The heap must not be empty.
+        const Value & top()
+        {
+            fill();
+            return buckets[0].front().second;
+        }
+
+        // \returns the lowest key. The heap must not be empty.
+        uint64_t top_key()
+        {
+            fill();
+            return last;
+        }
+
+        // \brief removes the entry with the lowest key. The heap must not be empty.
+        void pop()
+        {
+            fill();
+            std::pop_heap(buckets[0].begin(), buckets[0].end(), tie_compare);
+            buckets[0].pop_back();
+            count--;
+        }
+
+        bool empty() const
+        {
+            return count == 0;
+        }
+
+        size_t size() const
+        {
+            return count;
+        }
+
+        // \brief removes every entry and forgets the last popped key
+        void clear()
+        {
+            for (auto & b : buckets)
+            {
+                b.clear();
+            }
+            count = 0;
+            last = 0;
+        }
+
+        // \returns how many pushes went below the last popped key and redistributed the heap
+        int return_rebases() const
+        {
+            return rebases;
+        }
+
+    private:
+        using Entry = std::pair<uint64_t, Value>;
+
+        // \brief Compare applied to the values of two entries
+        struct TieCompare
+        {
+            bool operator() (const Entry & e1, const Entry & e2)
+            {
+                return compare(e1.second, e2.second);
+            }
+
+            Compare compare;
+        };
+
+        // \brief bucket of a key: 0 if it equals the last popped key, else one past its highest differing bit
+        int bucket(const uint64_t & key) const
+        {
+            const uint64_t diff = key ^ last;
+            return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+        }
+
+        // \brief makes bucket 0 non-empty: the lowest key of the first non-empty bucket becomes the last
+        // popped key and that bucket's entries move to lower buckets
+        void fill()
+        {
+            if (!buckets[0].empty())
+            {
+                return;
+            }
+            if (count == 0)
+            {
+                throw std::runtime_error("Cannot take the top of an empty heap\n  where(): RadixHeap::fill()");
+            }
+
+            int b = 1;
+            while (buckets[b].empty())
+            {
+                b++;
+            }
+            uint64_t low = std::numeric_limits<uint64_t>::max();
+            for (const auto & entry : buckets[b])
+            {
+                low = std::min(low, entry.first);
+            }
+            last = low;
+            redistribute(buckets[b]);
+        }
+
+        // \brief lowers the last popped key to 0 so a smaller key can be pushed, then re-buckets everything.
+        // Going down to 0 rather than to the pushed key keeps the following pushes of the same run O(1).
+        void rebase()
+        {
+            rebases++;
+            last = 0;
+            std::vector<Entry> all;
+            all.reserve(count);
+            for (auto & b : buckets)
+            {
+                all.insert(all.end(), b.begin(), b.end());
+                b.clear();
+            }
+            redistribute(all);
+        }
+
+        // \brief moves entries into the buckets given by the current last key. Empties source.
+        void redistribute(std::vector<Entry> & source)
+        {
+            std::vector<Entry> moving;
+            moving.swap(source);
+            for (auto & entry : moving)
+            {
+                buckets[bucket(entry.first)].push_back(std::move(entry));
+            }
+            std::make_heap(buckets[0].begin(), buckets[0].end(), tie_compare);
+            // Keep the emptied bucket's storage for later pushes
+            moving.clear();
+            if (source.capacity() < moving.capacity())
+            {
+                source.swap(moving);
+            }
+        }
+
+        std::array<std::vector<Entry>, 65> buckets;
+        uint64_t last = 0;
+        size_t count = 0;
+        int rebases = 0;
+        TieCompare tie_compare;
+    };
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef ROADMAP_SEARCH_INCLUDE_GUARD_HPP
+#define ROADMAP_SEARCH_INCLUDE_GUARD_HPP
+/// \file
+/// \brief A* on a PRM that reads the roadmap in place instead of copying it, with search state in flat arrays
+/// reused between plans. Same interface as GridSearch, so both can serve as BatchPlanner workspaces.
+
+#include "global_planner/heuristic.hpp"
+#include "global_planner/landmarks.hpp"
+#include "global_planner/search_budget.hpp"
+#include "global_planner/snapping.hpp"
+#include <cstdint>
+#include <limits>
+
+namespace global
+{
+    // \brief open list entry for RoadmapSearch. Stale entries are skipped when popped (lazy deletion).
+    struct RoadmapEntry
+    {
+        double fcost;
+        double hcost;
+        double gcost;
+        // Vertex ID
+        int id;
+    };
+
+    // \brief same ordering as HeapComparator: lowest f cost first, then lowest h cost
+    class RoadmapEntryComparator
+    {
+    public:
+        bool operator() (const RoadmapEntry & e1, const RoadmapEntry & e2) const
+        {
+            if (rigid2d::almost_equal(e1.fcost, e2.fcost))
+            {
+                return e1.hcost > e2.hcost;
+            } else
+            {
+                return e1.fcost > e2.fcost;
+            }
+        }
+    };
+
+    /// \brief A* on a PRM. Edges cost the Euclidean distance between their vertices and the heuristic is
+    /// the Euclidean distance to the goal. Vertex IDs must be their positions in the roadmap.
+    class RoadmapSearch
+    {
+    public:
+        // \param prm_: the roadmap to plan on. Must outlive this object and not change while it is used.
+        explicit RoadmapSearch(const std::vector<Vertex> & prm_);
+
+        // \brief Plans a path on the roadmap, between the vertices closest to start and goal.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        // \returns: the path as a vector of Nodes. If the goal is unreachable, the path to the closest expanded vertex.
+        std::vector<Node> plan(const Vector2D & start, const Vector2D & goal);
+
+        // \brief Starts a resumable search. Nothing is expanded until step() is called.
+        // \param start: the starting coordinates
+        // \param goal: the goal coordinates
+        void begin(const Vector2D & start, const Vector2D & goal);
+
+        // \brief Continues the search started by begin(). The search state persists between calls.
+        // \param budget: limits on this call
+        // \returns InProgress if the budget ran out first, Done if the goal was reached, Failed if it is unreachable
+        SearchStatus step(const SearchBudget & budget);
+
+        // \brief The best path so far: to the goal once it is reached, otherwise to the expanded vertex
+        // closest to the goal.
+        // \returns: the path as a vector of Nodes
+        std::vector<Node> best_path() const;
+
+        // \returns the state of the last search
+        SearchStatus return_status() const;
+
+        // \returns the cost of the last planned path, infinity if the goal was not reached
+        double return_cost() const;
+
+        // \returns the number of vertices expanded by the last plan
+        int return_expansions() const;
+
+        // \brief turns the progress messages printed by each plan on or off (on by default)
+        void set_verbose(const bool & verbose_);
+
+        // \brief also bounds the heuristic with landmark distance tables (ALT), which follow the roadmap's edges
+        // \param landmarks_: tables built for this roadmap (see build_landmarks), or nullptr to use only the
+        // Euclidean distance. Must outlive their use.
+        void set_landmarks(const Landmarks * landmarks_);
+
+        // \brief attaches start and goal through a spatial index, choosing the closest Vertex in line of sight,
+        // instead of scanning every Vertex for the closest one
+        // \param snapper_: built for this roadmap, or nullptr to scan. Must outlive its use.
+        void set_snapper(const RoadmapSnapper * snapper_);
+
+    private:
+        using OpenList = std::priority_queue <RoadmapEntry, std::vector<RoadmapEntry>, RoadmapEntryComparator >;
+
+        // \returns the Euclidean distance between two vertices
+        double distance(const int & a, const int & b) const;
+
+        // \returns the search's estimate of the cost from a vertex to the goal: the Euclidean distance,
+        // raised to the landmark bound if there are landmarks
+        double estimate(const int & id) const;
+
+        const std::vector<Vertex> & prm;
+
+        // Search state by vertex ID, valid for a vertex only if its stamp matches the current one
+        std::vector<double> gcost;
+        std::vector<int> parent;
+        std::vector<uint32_t> opened;
+        std::vector<uint32_t> closed;
+        uint32_t stamp = 0;
+
+        // Resumable search state
+        OpenList open_list;
+        int goal_id = -1;
+        int best_id = -1;
+        double best_h = 0.0;
+        SearchStatus status = SearchStatus::Failed;
+
+        double cost = std::numeric_limits<double>::infinity();
+        int expansions = 0;
+        bool verbose = true;
+        const Landmarks * landmarks = nullptr;
+        const RoadmapSnapper * snapper = nullptr;
+    };
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SEARCH_BUDGET_INCLUDE_GUARD_HPP
+#define SEARCH_BUDGET_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Budgets for resumable searches, so planners can run a bounded amount of work per call
+/// and be interleaved with the other duties of a ROS loop.
+#include <chrono>
+
+namespace global
+{
+    // \brief state of a resumable search after a step
+    enum class SearchStatus {InProgress, Done, Failed};
+
+    /// \brief limits on one step of a resumable search. Zero means unlimited; the default budget is unlimited.
+    struct SearchBudget
+    {
+        // Maximum number of expansions
+        int expansions = 0;
+        // Maximum wall-clock time
+        std::chrono::microseconds time{0};
+    };
+
+    /// \brief tracks the use of a SearchBudget during one step
+    class BudgetTracker
+    {
+    public:
+        // \param budget_: the budget of this step. Its clock starts now.
+        explicit BudgetTracker(const SearchBudget & budget_)
+            : budget(budget_), start(std::chrono::steady_clock::now()) {}
+
+        // \brief counts one expansion
+        void count()
+        {
+            used++;
+        }
+
+        // \brief whether the step must stop before the next expansion. The clock is read every 16 expansions,
+        // so a time budget may be overrun by that much work.
+        bool exhausted() const
+        {
+            if (budget.expansions > 0 and used >= budget.expansions)
+            {
+                return true;
+            }
+            return budget.time.count() > 0 and (used & 0xf) == 0 and used > 0 and
+                   std::chrono::steady_clock::now() - start >= budget.time;
+        }
+
+    private:
+        SearchBudget budget;
+        std::chrono::steady_clock::time_point start;
+        int used = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SNAPPING_INCLUDE_GUARD_HPP
+#define SNAPPING_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Attaches start and goal positions to a PRM: a k-d tree finds the closest Vertices and the closest one
+/// in line of sight is chosen, instead of scanning every Vertex for the closest one whether it is reachable or not.
+
+#include "global_planner/global_planner.hpp"
+#include <map/kdtree.hpp>
+#include <array>
+
+namespace global
+{
+    /// \brief snaps positions to the closest roadmap Vertex joined to them by a collision-free segment
+    class RoadmapSnapper
+    {
+    public:
+        // \param prm_: the roadmap. Vertex IDs must be their positions in it. Must outlive this object.
+        // \param obstacles_: the map obstacles
+        // \param inflate_robot_: robot radius used for collision checking, as when the roadmap was built
+        // \param candidates_: number of nearest Vertices checked for line of sight
+        RoadmapSnapper(const std::vector<Vertex> & prm_, const std::vector<Obstacle> & obstacles_,
+                       const double & inflate_robot_, const int & candidates_ = 8);
+
+        // \brief finds the Vertex to attach a position to
+        // \param position: the coordinates
+        // \returns the ID of the closest candidate in line of sight. If none is, the closest Vertex.
+        int snap(const Vector2D & position) const;
+
+        // \returns the k-d tree over the roadmap
+        const map::KDTree & return_tree() const;
+
+    private:
+        // \brief checks a segment against the given obstacles
+        // \param nearby: indices of the obstacles that may touch the segment
+        bool segment_free(const Vertex & from, const Vertex & to, const std::vector<int> & nearby) const;
+
+        const std::vector<Vertex> & prm;
+        map::KDTree tree;
+        // map::no_intersect takes a mutable iterator, but does not modify the Obstacle
+        mutable std::vector<Obstacle> obstacles;
+        // Obstacle bounding boxes grown by the robot radius: min x, min y, max x, max y
+        std::vector<std::array<double, 4>> bounds;
+        double inflate_robot;
+        int candidates;
+    };
+}
+
+#endif
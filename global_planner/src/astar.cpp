@@ -9,21 +9,41 @@
 #include <ros/ros.h>
 
 #include <math.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "map/map.hpp"
 #include "map/prm.hpp"
 #include "map/grid.hpp"
+#include "map/tiled_grid.hpp"
+#include "map/quadtree.hpp"
 #include <nav_msgs/OccupancyGrid.h>
 #include "global_planner/heuristic.hpp"
+#include "global_planner/hpa.hpp"
+#include "global_planner/bidirectional.hpp"
+#include "global_planner/contraction.hpp"
+#include "global_planner/roadmap_search.hpp"
+#include "global_planner/arastar.hpp"
+#include "global_planner/any_angle.hpp"
+#include "global_planner/hda.hpp"
+#include "global_planner/grid_search.hpp"
+#include "global_planner/flow_field.hpp"
+#include "global_planner/snapping.hpp"
+#include "global_planner/executor.hpp"
+#include "global_planner/path_cache.hpp"
 
 #include "nuslam/TurtleMap.h"
 
 #include <functional>  // To use std::bind
+#include <memory>
+#include <tuple>
+#include <type_traits>
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <geometry_msgs/Point.h>
+#include <geometry_msgs/PointStamped.h>
+#include <geometry_msgs/PoseStamped.h>
 
 // Used to deal with YAML list of lists
 #include <xmlrpcpp/XmlRpcValue.h> // catkin component
@@ -40,6 +60,7 @@ int main(int argc, char** argv)
     double SCALE = 10.0;
     std::string frame_id = "base_footprint";
     std::string planner_type = "astar";
+    // prm, grid, tiled (sparse Grid for large maps) or quadtree (merged cells in open areas)
     std::string map_type = "prm";
     XmlRpc::XmlRpcValue xml_obstacles;
     std::vector<double> start_vec{7.0, 3.0};
@@ -52,6 +73,29 @@ int main(int argc, char** argv)
     int k = 5;
     double thresh = 0.01;
     double inflate = 0.1;
+    // Directory for cached Grid/PRM artifacts (empty disables the cache)
+    std::string cache_dir = "";
+    // Shared Grid published by map_server (empty builds a private Grid)
+    std::string shm_name = "";
+    // PRM Sparsification Parameters (disabled if sparse_delta <= 0)
+    double sparse_delta = 0.0;
+    double stretch = 3.0;
+    // HPA* cluster side length in cells (planner: hpa)
+    int hpa_cluster_size = 16;
+    // ARA* initial heuristic inflation and planning budget in seconds (planner: arastar)
+    double ara_epsilon = 3.0;
+    double ara_budget = 0.1;
+    // HDA* search threads, 0 for one per hardware thread (planner: hda)
+    int hda_threads = 0;
+    // Number of goals to keep flow fields for (planner: flow_field)
+    int flow_field_goals = 4;
+    // Number of landmarks for the ALT heuristic (planner: alt)
+    int landmark_count = 8;
+    // Grid neighbourhood (4, 8 or 16) and cost model (uniform, octile or weighted) (planner: astar, alt, arastar, hda)
+    int connectivity = 8;
+    std::string cost_model = "octile";
+    // Largest rviz occupancy grid for a tiled map, in cells. Larger maps are shown at a coarser resolution.
+    int tiled_display_cells = 4194304;
 
     // store Obstacle(s) here to create Map
     std::vector<map::Obstacle> obstacles_v;
@@ -69,10 +113,23 @@ int main(int argc, char** argv)
     nh_.getParam("k", k);
     nh_.getParam("thresh", thresh);
     nh_.getParam("inflate", inflate);
+    nh_.getParam("sparse_delta", sparse_delta);
+    nh_.getParam("stretch", stretch);
     nh_.getParam("scale", SCALE);
     nh_.getParam("planner", planner_type);
     nh_.getParam("map_type", map_type);
     nh_.getParam("resolution", resolution);
+    nh_.getParam("cache_dir", cache_dir);
+    nh_.getParam("shm_name", shm_name);
+    nh_.getParam("hpa_cluster_size", hpa_cluster_size);
+    nh_.getParam("ara_epsilon", ara_epsilon);
+    nh_.getParam("ara_budget", ara_budget);
+    nh_.getParam("hda_threads", hda_threads);
+    nh_.getParam("flow_field_goals", flow_field_goals);
+    nh_.getParam("landmarks", landmark_count);
+    nh_.getParam("connectivity", connectivity);
+    nh_.getParam("cost_model", cost_model);
+    nh_.getParam("tiled_display_cells", tiled_display_cells);
 
     rigid2d::Vector2D start(start_vec.at(0)/SCALE, start_vec.at(1)/SCALE);
     rigid2d::Vector2D goal(goal_vec.at(0)/SCALE, goal_vec.at(1)/SCALE);
@@ -134,6 +191,8 @@ int main(int argc, char** argv)
     nav_msgs::OccupancyGrid grid_map;
     // rviz representation of the grid
     std::vector<int8_t> map;
+    // Grid cells per rviz map cell along each axis
+    int display_scale = 1;
 
     // Init Marker Array
     visualization_msgs::MarkerArray map_arr;
@@ -203,15 +262,155 @@ int main(int argc, char** argv)
     // Debug Path (Usually A* to compare with Theta*)
     std::vector<global::Node> path2;
 
+    // GRID Version maps, kept for replanning
+    // Initialize Grid
+    map::Grid grid(obstacles_v, inflate);
+    // Or attach to the Grid shared by map_server
+    std::unique_ptr<map::GridView> view;
+    // Or build a sparse tiled Grid
+    std::unique_ptr<map::TiledGrid> tiled;
+    // Or build a quadtree
+    std::unique_ptr<map::QuadTree> tree;
+    // HPA* abstraction, built on the first plan and repaired when cells change
+    std::unique_ptr<global::HPAstar> hpa;
+    // Flow fields of recent goals (planner: flow_field), for the active grid type
+    std::tuple<std::unique_ptr<global::FlowFieldCache<map::Grid>>,
+               std::unique_ptr<global::FlowFieldCache<map::GridView>>,
+               std::unique_ptr<global::FlowFieldCache<map::TiledGrid>>> flow_fields;
+    // Landmark distance tables (planner: alt), built with the map
+    global::Landmarks landmark_table;
+    // Paths planned on a private or tiled Grid, dropped when clicked cells cross them
+    global::PathCache path_cache;
+    // Epoch of the edited Grid, advanced by each batch of clicked cells
+    uint64_t map_epoch = 0;
+
+    if (connectivity != 4 and connectivity != 8 and connectivity != 16)
+    {
+      ROS_WARN("Unknown connectivity %d. Using 8.", connectivity);
+      connectivity = 8;
+    }
+    if (cost_model != "uniform" and cost_model != "octile" and cost_model != "weighted")
+    {
+      ROS_WARN("Unknown cost_model '%s'. Using octile.", cost_model.c_str());
+      cost_model = "octile";
+    }
+    const bool default_policies = connectivity == 8 and cost_model == "octile";
+
+    // Calls f(Conn{}, Cost{}) with the grid neighbourhood and cost model named by connectivity and cost_model
+    auto with_policies = [&](const auto & f)
+    {
+      auto with_cost = [&](const auto & conn)
+      {
+        if (cost_model == "uniform")
+        {
+          return f(conn, global::UniformCost{});
+        } else if (cost_model == "weighted")
+        {
+          return f(conn, global::WeightedCost<>{});
+        }
+        return f(conn, global::OctileCost{});
+      };
+      if (connectivity == 4)
+      {
+        return with_cost(global::Connect4{});
+      } else if (connectivity == 16)
+      {
+        return with_cost(global::Connect16{});
+      }
+      return with_cost(global::Connect8{});
+    };
+
+    // Builds the landmark tables of a grid map, for the GridSearch policies in use
+    auto build_tables = [&](const auto & g)
+    {
+      return with_policies([&](const auto & conn, const auto & cost)
+      {
+        return global::build_landmarks<std::decay_t<decltype(conn)>, std::decay_t<decltype(cost)>>(g, landmark_count);
+      });
+    };
+    // Cache key settings of planner_type with the GridSearch policies in use
+    const uint64_t path_settings = with_policies([&](const auto & conn, const auto & cost)
+    {
+      return global::policy_settings<std::decay_t<decltype(conn)>, std::decay_t<decltype(cost)>>(planner_type);
+    });
+
+    // Plans from one point to another on the grid map. Empty for the PRM.
+    std::function<std::vector<global::Node>(const rigid2d::Vector2D &, const rigid2d::Vector2D &)> replan;
+
+    // Draws path and path2 on the grid map
+    auto draw_grid_path = [&]()
+    {
+      // Republished every iteration, so markers of an older, longer path expire
+      visualization_msgs::Marker line = path_marker;
+      visualization_msgs::Marker cube = path_sph_mkr;
+      line.lifetime = ros::Duration(2.0 / frequency);
+      cube.lifetime = ros::Duration(2.0 / frequency);
+      path_arr.markers.clear();
+      path_debug.markers.clear();
+
+      // DRAW PATH
+      int path_marker_id = 0;
+      for (auto path_iter = path.begin(); path_iter != path.end(); path_iter++)
+      {
+          // Add node as marker cell
+          geometry_msgs::Point vtx;
+          vtx.x = path_iter->cell.coords.x;
+          vtx.y = path_iter->cell.coords.y;
+          vtx.z = 0.0;
+          line.points.push_back(vtx);
+
+          // Also push back cylinders
+          cube.pose.position.x = path_iter->cell.coords.x;
+          cube.pose.position.y = path_iter->cell.coords.y;
+          cube.id = path_marker_id;
+          path_marker_id++;
+          path_arr.markers.push_back(cube);
+
+      }
+      line.id = path_marker_id;
+      path_arr.markers.push_back(line);
+
+      // DRAW DEBUG PATH
+      path_marker_id = 0;
+      line.points.clear();
+      line.color.r = 1.0;
+      line.color.g = 0.2;
+      line.color.b = 0.2;
+      for (auto path2_iter = path2.begin(); path2_iter != path2.end(); path2_iter++)
+      {
+          // Add node as marker cell
+          geometry_msgs::Point vtx;
+          vtx.x = path2_iter->cell.coords.x;
+          vtx.y = path2_iter->cell.coords.y;
+          vtx.z = 0.0;
+          line.points.push_back(vtx);
+
+          // Also push back cylinders
+          cube.pose.position.x = path2_iter->cell.coords.x;
+          cube.pose.position.y = path2_iter->cell.coords.y;
+          cube.id = path_marker_id;
+          path_marker_id++;
+          path_debug.markers.push_back(cube);
+
+      }
+      line.id = path_marker_id;
+      path_debug.markers.push_back(line);
+    };
+
     if (map_type == "prm")
       // PRM VERSION
     {
       // Build PRM
       map::PRM prm(obstacles_v, inflate);
-      prm.build_map(n, k, thresh);
+      prm.build_map(n, k, thresh, cache_dir);
+      // Sparsify PRM (SPARS-style) to speed up queries
+      if (sparse_delta > 0.0)
+      {
+        prm.sparsify(stretch, sparse_delta);
+      }
       // DRAW PRM
       int prm_marker_id = 0;
-      auto configurations = prm.return_prm();
+      const auto & configurations = prm.return_prm();
       for (auto node_iter = configurations.begin(); node_iter != configurations.end(); node_iter++)
       {
           marker.points.clear();
@@ -231,7 +430,7 @@ int main(int argc, char** argv)
                     marker.points.push_back(first_vertex);
 
                     // Find Vertex for each ID
-                    auto neighbor_iter = configurations.at(*id_iter);
+                    const auto & neighbor_iter = configurations.at(*id_iter);
 
                     geometry_msgs::Point new_vertex;
                     new_vertex.x = neighbor_iter.coords.x;
@@ -253,19 +452,72 @@ int main(int argc, char** argv)
 
       ROS_INFO("PRM Built!");
 
-      // PLAN on PRM using A* or Theta*
+      // Attach start and goal to the closest Vertex in line of sight, found through a k-d tree
+      global::RoadmapSnapper snapper(configurations, obstacles_v, inflate);
+
+      if (planner_type == "alt")
+      {
+        landmark_table = global::build_landmarks(configurations, landmark_count);
+        ROS_INFO("Built %d landmarks", static_cast<int>(landmark_table.return_landmarks().size()));
+      }
+
+      // PLAN on PRM using A*, A* with landmarks, bidirectional A*, a contraction hierarchy, Theta* or Lazy Theta*
       if (planner_type == "astar")
       {
         ROS_INFO("Planning using A*!");
         global::Astar astar(obstacles_v, inflate);
+        astar.set_snapper(&snapper);
         path = astar.plan(start, goal, configurations);
+      } else if (planner_type == "bidirectional")
+      {
+        ROS_INFO("Planning using bidirectional A*!");
+        global::BidirectionalAstar bidirectional(obstacles_v, inflate);
+        bidirectional.set_snapper(&snapper);
+        path = bidirectional.plan(start, goal, configurations);
+        ROS_INFO("Planning using A*!");
+        global::Astar astar(obstacles_v, inflate);
+        astar.set_snapper(&snapper);
+        path2 = astar.plan(start, goal, configurations);
+      } else if (planner_type == "alt")
+      {
+        ROS_INFO("Planning using A* with landmarks!");
+        global::RoadmapSearch search(configurations);
+        search.set_snapper(&snapper);
+        search.set_landmarks(&landmark_table);
+        path = search.plan(start, goal);
+        ROS_INFO("Planning using A*!");
+        global::Astar astar(obstacles_v, inflate);
+        astar.set_snapper(&snapper);
+        path2 = astar.plan(start, goal, configurations);
+      } else if (planner_type == "contraction")
+      {
+        ROS_INFO("Planning using a contraction hierarchy!");
+        global::ContractionHierarchy hierarchy(configurations);
+        hierarchy.set_snapper(&snapper);
+        path = hierarchy.plan(start, goal);
+        ROS_INFO("Planning using A*!");
+        global::Astar astar(obstacles_v, inflate);
+        astar.set_snapper(&snapper);
+        path2 = astar.plan(start, goal, configurations);
+      } else if (planner_type == "lazy_thetastar")
+      {
+        ROS_INFO("Planning using Lazy Theta*!");
+        global::LazyThetastar lazy_theta_star(obstacles_v, inflate);
+        lazy_theta_star.set_snapper(&snapper);
+        path = lazy_theta_star.plan(start, goal, configurations);
+        ROS_INFO("Planning using A*!");
+        global::Astar astar(obstacles_v, inflate);
+        astar.set_snapper(&snapper);
+        path2 = astar.plan(start, goal, configurations);
       } else
       {
         ROS_INFO("Planning using Theta*!");
         global::Thetastar theta_star(obstacles_v, inflate);
+        theta_star.set_snapper(&snapper);
         path = theta_star.plan(start, goal, configurations);
         ROS_INFO("Planning using A*!");
         global::Astar astar(obstacles_v, inflate);
+        astar.set_snapper(&snapper);
         path2 = astar.plan(start, goal, configurations);
       }
 
@@ -320,25 +572,69 @@ int main(int argc, char** argv)
     } else
     // GRID Version
     {
-      // Initialize Grid
-      map::Grid grid(obstacles_v, inflate);
+      rigid2d::Vector2D origin;
+      std::vector<int> gridsize;
+
+      if (!shm_name.empty())
+      {
+        view.reset(new map::GridView(shm_name));
+
+        ROS_INFO("Attached to shared Grid: %s", shm_name.c_str());
 
-      // Build Map
-      grid.build_map(resolution);
+        resolution = view->return_resolution();
+        origin = view->return_origin();
+        gridsize = view->return_grid_dimensions();
 
-      ROS_INFO("Grid Built!");
+        // rviz representation of the grid
+        view->occupancy_grid(map);
+      } else if (map_type == "tiled")
+      {
+        tiled.reset(new map::TiledGrid(obstacles_v, inflate));
+        tiled->build_map(resolution);
 
-      // Get map bounds
-      auto bounds = grid.return_map_bounds();
-      auto gridsize = grid.return_grid_dimensions();
+        ROS_INFO("Tiled Grid Built!");
 
-      // rviz representation of the grid
-      grid.occupancy_grid(map);
+        origin = tiled->return_origin();
+        gridsize = tiled->return_grid_dimensions();
+
+        // rviz representation of the grid, coarse enough to stay under tiled_display_cells
+        const double cells = static_cast<double>(gridsize.at(0)) * gridsize.at(1);
+        while (cells / (static_cast<double>(display_scale) * display_scale) > std::max(tiled_display_cells, 1))
+        {
+          display_scale *= 2;
+        }
+        tiled->occupancy_grid(map, display_scale);
+      } else if (map_type == "quadtree")
+      {
+        tree.reset(new map::QuadTree(obstacles_v, inflate));
+        tree->build_map(resolution);
+
+        ROS_INFO("Quadtree Built!");
+
+        origin = tree->return_origin();
+        gridsize = tree->return_grid_dimensions();
+
+        // rviz representation of the grid
+        tree->occupancy_grid(map);
+      } else
+      {
+        // Build Map
+        grid.build_map(resolution, cache_dir);
+
+        ROS_INFO("Grid Built!");
+
+        // Get map bounds
+        origin = grid.return_map_bounds().at(0);
+        gridsize = grid.return_grid_dimensions();
+
+        // rviz representation of the grid
+        grid.occupancy_grid(map);
+      }
 
       // Grid Pose
       geometry_msgs::Pose map_pose;
-      map_pose.position.x = bounds.at(0).x;
-      map_pose.position.y = bounds.at(0).y;
+      map_pose.position.x = origin.x;
+      map_pose.position.y = origin.y;
       map_pose.position.z = 0.0;
       map_pose.orientation.x = 0.0;
       map_pose.orientation.y = 0.0;
@@ -347,70 +643,204 @@ int main(int argc, char** argv)
 
       // Occupancy grid for visualization
       grid_map.header.frame_id = frame_id;
-      grid_map.info.resolution = resolution;
-      grid_map.info.width = gridsize.at(0);
-      grid_map.info.height = gridsize.at(1);
+      grid_map.info.resolution = resolution * display_scale;
+      grid_map.info.width = (gridsize.at(0) + display_scale - 1) / display_scale;
+      grid_map.info.height = (gridsize.at(1) + display_scale - 1) / display_scale;
 
       // std::cout << "Width: " << gridsize.at(0) << "\t Height: " << gridsize.at(1) << std::endl;
 
       grid_map.info.origin = map_pose;
 
-      ROS_INFO("Planning using A*!");
-      global::Astar astar(obstacles_v, inflate);
-      path = astar.plan(start, goal, grid, resolution);
-      path2 = path;
+      if (planner_type == "alt" and !tree)
+      {
+        if (view)
+        {
+          landmark_table = build_tables(*view);
+        } else if (tiled)
+        {
+          landmark_table = build_tables(*tiled);
+        } else
+        {
+          landmark_table = build_tables(grid);
+        }
+        ROS_INFO("Built %d landmarks", static_cast<int>(landmark_table.return_landmarks().size()));
+      }
 
+      if (!default_policies and planner_type != "astar" and planner_type != "alt" and planner_type != "arastar" and planner_type != "hda")
+      {
+        ROS_WARN("Planner '%s' is 8-connected with octile costs. Ignoring connectivity and cost_model.", planner_type.c_str());
+      }
 
-      // DRAW PATH
-      int path_marker_id = 0;
-      for (auto path_iter = path.begin(); path_iter != path.end(); path_iter++)
+      // Plans with planner_type on any grid exposing the grid index API (map::Grid, map::GridView, map::TiledGrid)
+      auto plan_on = [&](const auto & g, const rigid2d::Vector2D & from, const rigid2d::Vector2D & to) -> std::vector<global::Node>
       {
-          // Add node as marker cell
-          geometry_msgs::Point vtx;
-          vtx.x = path_iter->cell.coords.x;
-          vtx.y = path_iter->cell.coords.y;
-          vtx.z = 0.0;
-          path_marker.points.push_back(vtx);
+        using GridT = std::decay_t<decltype(g)>;
+        constexpr bool private_grid = std::is_same<GridT, map::Grid>::value;
 
-          // Also push back cylinders
-          path_sph_mkr.pose.position.x = path_iter->cell.coords.x;
-          path_sph_mkr.pose.position.y = path_iter->cell.coords.y;
-          path_sph_mkr.id = path_marker_id;
-          path_marker_id++;
-          path_arr.markers.push_back(path_sph_mkr);
+        if (planner_type == "hpa")
+        {
+          if (!hpa)
+          {
+            hpa.reset(new global::HPAstar(g, hpa_cluster_size));
+            ROS_INFO("Using the HPA* abstraction: %d abstract nodes", hpa->return_abstract_nodes());
+          }
+          return hpa->plan(from, to);
+        } else if (planner_type == "arastar")
+        {
+          ROS_INFO("Using ARA* with a %.3f s budget", ara_budget);
+          return with_policies([&](const auto & conn, const auto & cost)
+          {
+            global::ARAstar<GridT, std::decay_t<decltype(conn)>, std::decay_t<decltype(cost)>> ara(g, ara_epsilon);
+            std::vector<global::Node> ara_path = ara.plan(from, to, std::chrono::microseconds(static_cast<int64_t>(ara_budget * 1e6)));
+            ROS_INFO("Path cost is within %.2f of optimal", ara.return_bound());
+            return ara_path;
+          });
+        } else if (planner_type == "hda")
+        {
+          return with_policies([&](const auto & conn, const auto & cost)
+          {
+            global::ParallelGridSearch<GridT, std::decay_t<decltype(conn)>, std::decay_t<decltype(cost)>> hda(g, hda_threads);
+            ROS_INFO("Using HDA* on %d threads", hda.return_threads());
+            return hda.plan(from, to);
+          });
+        } else if (planner_type == "thetastar" or planner_type == "lazy_thetastar")
+        {
+          ROS_INFO("Any-angle planning on the grid");
+          global::AnyAngleSearch<GridT> any_angle(g, planner_type == "lazy_thetastar");
+          return any_angle.plan(from, to);
+        } else if (planner_type == "alt")
+        {
+          ROS_INFO("Planning using A* with landmarks!");
+          return with_policies([&](const auto & conn, const auto & cost)
+          {
+            global::GridSearch<GridT, std::decay_t<decltype(conn)>, std::decay_t<decltype(cost)>> search(g);
+            search.set_landmarks(&landmark_table);
+            return search.plan(from, to);
+          });
+        } else if (planner_type == "flow_field")
+        {
+          auto & fields = std::get<std::unique_ptr<global::FlowFieldCache<GridT>>>(flow_fields);
+          if (!fields)
+          {
+            fields.reset(new global::FlowFieldCache<GridT>(g, flow_field_goals));
+          }
+          const auto field = fields->field(to);
+          ROS_INFO("Descending the flow field (%d fields computed, %d reused)", fields->return_misses(), fields->return_hits());
+          return field->extract_path(from);
+        } else if (planner_type == "bidirectional")
+        {
+          if constexpr (private_grid)
+          {
+            ROS_INFO("Searching from both ends");
+            global::BidirectionalAstar bidirectional(obstacles_v, inflate);
+            return bidirectional.plan(from, to, g, resolution);
+          }
+          ROS_WARN("Bidirectional A* only runs on map_type grid without shm_name. Falling back to A*.");
+        } else if (planner_type != "astar")
+        {
+          ROS_WARN("Unknown planner '%s'. Falling back to A*.", planner_type.c_str());
+        }
 
-      }
-      path_marker.id = path_marker_id;
-      path_arr.markers.push_back(path_marker);
+        ROS_INFO("Planning using A*!");
+        if (!default_policies)
+        {
+          return with_policies([&](const auto & conn, const auto & cost)
+          {
+            global::GridSearch<GridT, std::decay_t<decltype(conn)>, std::decay_t<decltype(cost)>> search(g);
+            return search.plan(from, to);
+          });
+        }
+        global::Astar astar(obstacles_v, inflate);
+        if constexpr (private_grid)
+        {
+          return astar.plan(from, to, g, resolution);
+        } else
+        {
+          return astar.plan(from, to, g);
+        }
+      };
 
-      // DRAW DEBUG PATH
-      path_marker_id = 0;
-      path_marker.points.clear();
-      path_marker.color.r = 1.0;
-      path_marker.color.g = 0.2;
-      path_marker.color.b = 0.2;
-      for (auto path2_iter = path2.begin(); path2_iter != path2.end(); path2_iter++)
-      {
-          // Add node as marker cell
-          geometry_msgs::Point vtx;
-          vtx.x = path2_iter->cell.coords.x;
-          vtx.y = path2_iter->cell.coords.y;
-          vtx.z = 0.0;
-          path_marker.points.push_back(vtx);
+      // Optimal planners return a path as short as the cached one, so their paths can be reused
+      const bool cache_paths = planner_type == "astar" or planner_type == "alt" or planner_type == "hda";
 
-          // Also push back cylinders
-          path_sph_mkr.pose.position.x = path2_iter->cell.coords.x;
-          path_sph_mkr.pose.position.y = path2_iter->cell.coords.y;
-          path_sph_mkr.id = path_marker_id;
-          path_marker_id++;
-          path_debug.markers.push_back(path_sph_mkr);
+      // Plans with plan_on, answering repeated queries on the same edit of the map from path_cache
+      auto plan_cached = [&, plan_on](const auto & g, const rigid2d::Vector2D & from, const rigid2d::Vector2D & to)
+      {
+        if (!cache_paths)
+        {
+          return plan_on(g, from, to);
+        }
+        const global::PathKey key{g.world2grid(map::Cell(from, resolution)).row_major,
+                                  g.world2grid(map::Cell(to, resolution)).row_major, path_settings};
+        const auto cached = path_cache.lookup(key, map_epoch);
+        if (cached)
+        {
+          ROS_INFO("Reusing a cached path (%d hits, %d misses)", path_cache.return_hits(), path_cache.return_misses());
+          return *cached;
+        }
+        std::vector<global::Node> planned = plan_on(g, from, to);
+        // Partial paths are not cached
+        if (!planned.empty() and planned.back().id == key.goal)
+        {
+          path_cache.insert(key, map_epoch, planned, g.return_grid_dimensions().at(0));
+        }
+        return planned;
+      };
 
-      }
-      path_marker.id = path_marker_id;
-      path_debug.markers.push_back(path_marker);
+      replan = [&, plan_on, plan_cached](const rigid2d::Vector2D & from, const rigid2d::Vector2D & to) -> std::vector<global::Node>
+      {
+        if (view)
+        {
+          return plan_on(*view, from, to);
+        } else if (tiled)
+        {
+          return plan_cached(*tiled, from, to);
+        } else if (tree)
+        {
+          // Leaves have different sizes, so only A* searches the quadtree
+          if (planner_type != "astar")
+          {
+            ROS_WARN("The quadtree only supports A*. Ignoring planner '%s'.", planner_type.c_str());
+          }
+          ROS_INFO("Planning using A*!");
+          global::Astar astar(obstacles_v, inflate);
+          return astar.plan(from, to, *tree);
+        }
+        return plan_cached(grid, from, to);
+      };
+      path = replan(start, goal);
+      path2 = path;
+      draw_grid_path();
 
     }
 
+    // New goals (eg: rviz 2D Nav Goal). Handled in the loop, as spinOnce runs this on the same thread.
+    bool new_goal = false;
+    ros::Subscriber goal_sub = nh.subscribe<geometry_msgs::PoseStamped>("move_base_simple/goal", 1,
+      [&goal, &new_goal](const geometry_msgs::PoseStamped::ConstPtr & msg)
+      {
+        goal = rigid2d::Vector2D(msg->pose.position.x, msg->pose.position.y);
+        new_goal = true;
+      });
+
+    // Clicked points (eg: rviz Publish Point) toggle a cell between Occupied and Free on a private or tiled Grid.
+    // Queued here, and applied in the loop once no plan reads the map.
+    std::vector<rigid2d::Vector2D> clicked;
+    ros::Subscriber point_sub = nh.subscribe<geometry_msgs::PointStamped>("clicked_point", 1,
+      [&](const geometry_msgs::PointStamped::ConstPtr & msg)
+      {
+        if (!replan or view or tree)
+        {
+          ROS_WARN("Only map_type grid (without shm_name) and tiled can be edited");
+          return;
+        }
+        clicked.push_back(rigid2d::Vector2D(msg->point.x, msg->point.y));
+      });
+
+    // Replans in the background, so clicks and goals never stall publishing. Declared after the map and
+    // planner state, so it stops first.
+    global::PlanningExecutor executor;
+
     ros::Rate rate(frequency);
 
     // Main While
@@ -418,6 +848,86 @@ int main(int argc, char** argv)
     {
         ros::spinOnce();
 
+        // Background plan finished
+        global::PlanResult result;
+        if (executor.poll(result))
+        {
+          path = result.path;
+          path2 = path;
+          draw_grid_path();
+        }
+
+        // Replan on the grid for new goals and edited cells. Waits for the previous plan, as the map and planner
+        // state are only edited while no plan reads them. So no request is ever dropped.
+        if (replan and (new_goal or !clicked.empty()) and !executor.busy())
+        {
+          std::vector<map::Cell> changes;
+          for (const auto & point : clicked)
+          {
+            try
+            {
+              const map::Cell cell(point, resolution);
+              if (tiled)
+              {
+                const map::Index i = tiled->world2grid(cell);
+                tiled->set_celltype(i.x, i.y, tiled->celltype(i.x, i.y) == map::Free ? map::Occupied : map::Free);
+                changes.push_back(tiled->return_cell(i.x, i.y));
+              } else
+              {
+                const map::Index i = grid.world2grid(cell);
+                changes.push_back(grid.set_celltype(i.x, i.y, grid.celltype(i.x, i.y) == map::Free ? map::Occupied : map::Free));
+              }
+            } catch (const std::runtime_error &)
+            {
+              ROS_WARN("Clicked point is outside the grid");
+            }
+          }
+          clicked.clear();
+          if (!changes.empty())
+          {
+            // Drops the cached paths crossing an edited cell. Freed cells can also shorten the other paths.
+            path_cache.invalidate(changes, ++map_epoch);
+            if (std::any_of(changes.begin(), changes.end(), [](const map::Cell & cell) { return cell.celltype == map::Free; }))
+            {
+              path_cache.clear();
+            }
+            if (tiled)
+            {
+              tiled->occupancy_grid(map, display_scale);
+            } else
+            {
+              grid.occupancy_grid(map);
+            }
+          }
+          new_goal = false;
+
+          const rigid2d::Vector2D from = start;
+          const rigid2d::Vector2D to = goal;
+          executor.submit([&, from, to, changes](const global::CancelToken &)
+          {
+            // Repair the planner state on the worker, before planning on the edited map
+            if (!changes.empty())
+            {
+              if (hpa)
+              {
+                ROS_INFO("HPA*: repaired %d clusters", hpa->update(changes));
+              }
+              std::apply([](auto & ... fields)
+              {
+                ((fields ? fields->invalidate() : void()), ...);
+              }, flow_fields);
+              // Freed cells can shorten paths, so the old tables could overestimate
+              if (planner_type == "alt")
+              {
+                landmark_table = tiled ? build_tables(*tiled) : build_tables(grid);
+              }
+            }
+            global::PlanResult planned;
+            planned.path = replan(from, to);
+            return planned;
+          });
+        }
+
         // Publish PRM Map
         map_pub.publish(map_arr);
 
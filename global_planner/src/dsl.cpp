@@ -4,6 +4,7 @@
 /// PARAMETERS:
 /// PUBLISHES:
 /// SUBSCRIBES:
+///     move_base_simple/goal (geometry_msgs/PoseStamped): new goal, planned for from the current cell
 /// FUNCTIONS:
 
 #include <ros/ros.h>
@@ -15,8 +16,10 @@
 #include "map/map.hpp"
 #include "map/prm.hpp"
 #include "map/grid.hpp"
+#include "map/snapshot.hpp"
 #include <nav_msgs/OccupancyGrid.h>
 #include "global_planner/incremental.hpp"
+#include "global_planner/executor.hpp"
 
 #include "nuslam/TurtleMap.h"
 
@@ -24,6 +27,7 @@
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
 
 // Used to deal with YAML list of lists
 #include <xmlrpcpp/XmlRpcValue.h> // catkin component
@@ -48,6 +52,16 @@ int main(int argc, char** argv)
     double thresh = 0.01;
     double inflate = 0.1;
     int visibility = 5;
+    // Directory for cached Grid/PRM artifacts (empty disables the cache)
+    std::string cache_dir = "";
+    // Cell storage order: rowmajor, zorder (cache-local neighbours on wide maps) or padded (sentinel border)
+    std::string cell_layout = "rowmajor";
+    // Replanning time per loop iteration in microseconds (0 replans to completion each update)
+    int step_budget_us = 0;
+    // Plan on a worker thread so the loop keeps its rate; new goals cancel stale plans
+    bool async_planning = false;
+    // Keep the open list in a radix heap over fixed-point keys instead of a binary heap
+    bool radix_heap = false;
 
     // store Obstacle(s) here to create Map
     std::vector<map::Obstacle> obstacles_v;
@@ -66,6 +80,11 @@ int main(int argc, char** argv)
     nh_.getParam("scale", SCALE);
     nh_.getParam("resolution", resolution);
     nh_.getParam("visibility", visibility);
+    nh_.getParam("cache_dir", cache_dir);
+    nh_.getParam("cell_layout", cell_layout);
+    nh_.getParam("step_budget_us", step_budget_us);
+    nh_.getParam("async_planning", async_planning);
+    nh_.getParam("radix_heap", radix_heap);
 
     rigid2d::Vector2D start(start_vec.at(0)/SCALE, start_vec.at(1)/SCALE);
     rigid2d::Vector2D goal(goal_vec.at(0)/SCALE, goal_vec.at(1)/SCALE);
@@ -201,7 +220,14 @@ int main(int argc, char** argv)
     map::Grid grid(obstacles_v, inflate);
 
     // Build Map
-    grid.build_map(resolution);
+    grid.build_map(resolution, cache_dir);
+    if (cell_layout == "zorder")
+    {
+        grid.set_layout(map::CellLayout::ZOrder);
+    } else if (cell_layout == "padded")
+    {
+        grid.set_layout(map::CellLayout::Padded);
+    }
 
     ROS_INFO("Grid Built!");
 
@@ -231,10 +257,18 @@ int main(int argc, char** argv)
 
     ROS_INFO("Planning using D* Lite!");
     global::DSL dsl(obstacles_v, inflate);
+    dsl.set_radix_heap(radix_heap);
     dsl.Initialize(start, goal, grid, resolution);
     dsl.ComputeShortestPath();
     path = dsl.return_path();
 
+    // Versions of the FAKE Grid: every update is committed, so planners can read a snapshot while it changes
+    map::VersionedGrid versions(grid, grid.return_fake_grid());
+    // Latest version applied to dsl by a background plan. Only touched by jobs, which run on the worker
+    // one at a time, so an update dropped by submit() is picked up by the next job's diff
+    std::shared_ptr<const map::GridSnapshot> planned_on = versions.snapshot();
+    const map::CellLayout layout = grid.return_layout();
+
     ros::Rate rate(frequency);
 
     // 0th cell
@@ -261,6 +295,27 @@ int main(int argc, char** argv)
 
     bool valid_path = dsl.return_valid();
 
+    // A budgeted replan is spread over loop iterations; the previous path is shown until it finishes
+    global::SearchBudget budget;
+    budget.time = std::chrono::microseconds(step_budget_us);
+    bool replanning = false;
+
+    // Runs plans in the background when async_planning is set. Declared after dsl, so it stops first.
+    global::PlanningExecutor executor;
+    // Whether the robot waits for a background plan
+    bool waiting = false;
+    // ID of the latest background plan for a new goal
+    uint64_t goal_request = 0;
+
+    // New goals (eg: rviz 2D Nav Goal). Handled in the loop, as spinOnce runs this on the same thread.
+    bool new_goal = false;
+    ros::Subscriber goal_sub = nh.subscribe<geometry_msgs::PoseStamped>("move_base_simple/goal", 1,
+        [&goal, &new_goal](const geometry_msgs::PoseStamped::ConstPtr & msg)
+        {
+            goal = rigid2d::Vector2D(msg->pose.position.x, msg->pose.position.y);
+            new_goal = true;
+        });
+
     // Main While
     while (ros::ok())
     {
@@ -317,23 +372,109 @@ int main(int argc, char** argv)
         // Publish Path
         path_pub.publish(path_arr);
 
+        // Whether a replan finished in this iteration
+        bool replanned = false;
+
+        // Background plan finished
+        global::PlanResult result;
+        if (executor.poll(result))
+        {
+            path = result.path;
+            // Read on the worker: a request submitted below may already be using dsl
+            valid_path = result.valid;
+            waiting = false;
+            // The current cell is already in total_path when starting towards a new goal
+            if (result.request != goal_request)
+            {
+                replanned = true;
+            }
+        }
+
+        // New goal: plan from the current cell, with what has been seen of the map so far
+        if (new_goal)
+        {
+            new_goal = false;
+            replanning = false;
+            planning = true;
+            const rigid2d::Vector2D from = total_path.back().cell.center_coords;
+            ROS_INFO("New goal: [%.2f, %.2f]", goal.x, goal.y);
+            if (async_planning)
+            {
+                // Cancels any replan in progress
+                goal_request = executor.submit([&dsl, &versions, &planned_on, from, goal, layout](const global::CancelToken & token)
+                {
+                    planned_on = versions.snapshot();
+                    dsl.Initialize(from, goal, *planned_on, layout);
+                    global::step_until_cancelled([&dsl](const global::SearchBudget & slice)
+                    {
+                        return dsl.ComputeShortestPath(slice);
+                    }, token);
+                    global::PlanResult planned;
+                    planned.path = dsl.return_path();
+                    planned.valid = dsl.return_valid();
+                    return planned;
+                });
+                waiting = true;
+            } else
+            {
+                dsl.Initialize(from, goal, grid, resolution);
+                dsl.ComputeShortestPath();
+                path = dsl.return_path();
+                valid_path = dsl.return_valid();
+            }
+        }
+
         // FAKE Update
         updated_nodes.clear();
-        if (path.size() > 1 and planning and valid_path)
+        if (waiting)
+        {
+            // Keep publishing the current path until the background plan arrives
+        } else if (replanning)
+        {
+            // Search for at most step_budget_us per loop iteration
+            if (dsl.ComputeShortestPath(budget) != global::SearchStatus::InProgress)
+            {
+                replanning = false;
+                path = dsl.return_path();
+                valid_path = dsl.return_valid();
+                replanned = true;
+            }
+        } else if (path.size() > 1 and planning and valid_path)
         {
             // Update Grid
-            grid.update_grid(path.at(path_counter + 1).cell, visibility);
+            const std::vector<map::Cell> changed = grid.update_grid(path.at(path_counter + 1).cell, visibility);
+            versions.commit(changed);
             // D*Lite Update
-            updated_nodes = dsl.SimulateUpdate(grid.return_fake_grid());
-            // Return Path
-            path = dsl.return_path();
-            // Check path validity (obstacles etc)
-            valid_path = dsl.return_valid();
-            // Update total path
-            total_path.push_back(path.at(path_counter));
-            // Update Current Position Counter
-            curr_pos_marker.pose.position.x = path.at(path_counter).cell.center_coords.x;
-            curr_pos_marker.pose.position.y = path.at(path_counter).cell.center_coords.y;
+            if (async_planning)
+            {
+                // On the worker thread, which catches up from the version it last planned on
+                executor.submit([&dsl, &versions, &planned_on](const global::CancelToken & token)
+                {
+                    const std::shared_ptr<const map::GridSnapshot> latest = versions.snapshot();
+                    dsl.ApplyUpdate(latest->changes_since(*planned_on));
+                    planned_on = latest;
+                    global::step_until_cancelled([&dsl](const global::SearchBudget & slice)
+                    {
+                        return dsl.ComputeShortestPath(slice);
+                    }, token);
+                    global::PlanResult planned;
+                    planned.path = dsl.return_path();
+                    planned.valid = dsl.return_valid();
+                    return planned;
+                });
+                waiting = true;
+            } else if (step_budget_us > 0)
+            {
+                updated_nodes = dsl.ApplyUpdate(changed);
+                replanning = true;
+            } else
+            {
+                updated_nodes = dsl.SimulateUpdate(changed);
+                // Return Path
+                path = dsl.return_path();
+                valid_path = dsl.return_valid();
+                replanned = true;
+            }
         } else
         {
             // FINAL PATH. INFINITE MARKER DURATION
@@ -354,6 +495,16 @@ int main(int argc, char** argv)
             planning = false;
         }
 
+        if (replanned)
+        {
+            // valid_path was set along with the path (obstacles etc)
+            // Update total path
+            total_path.push_back(path.at(path_counter));
+            // Update Current Position Counter
+            curr_pos_marker.pose.position.x = path.at(path_counter).cell.center_coords.x;
+            curr_pos_marker.pose.position.y = path.at(path_counter).cell.center_coords.y;
+        }
+
         // Make the markers persist for the first iteration to show original path
         if (firstpass)
         {
@@ -0,0 +1,329 @@
+#include "global_planner/bidirectional.hpp"
+#include "global_planner/grid_policies.hpp"
+#include "global_planner/snapping.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace global
+{
+	namespace
+	{
+		// \brief open list entry. Stale entries are skipped when popped (lazy deletion).
+		struct NBAEntry
+		{
+			double fcost;
+			double gcost;
+			int id;
+		};
+
+		class NBAEntryComparator
+		{
+		public:
+			bool operator() (const NBAEntry & e1, const NBAEntry & e2) const
+			{
+				return e1.fcost > e2.fcost;
+			}
+		};
+
+		using NBAOpenList = std::priority_queue <NBAEntry, std::vector<NBAEntry>, NBAEntryComparator >;
+
+		constexpr double INF = std::numeric_limits<double>::infinity();
+
+		// \brief PRM seen by NBA*: vertex IDs, Euclidean edge costs and heuristic, as in Astar
+		class PRMGraph
+		{
+		public:
+			explicit PRMGraph(const std::vector<Vertex> & prm_) : prm(prm_) {}
+
+			int size() const
+			{
+				return static_cast<int>(prm.size());
+			}
+
+			double heuristic(const int & a, const int & b) const
+			{
+				return map::euclidean_distance(prm[a].coords.x - prm[b].coords.x, prm[a].coords.y - prm[b].coords.y);
+			}
+
+			// \brief calls f(neighbour, edge cost) for each edge of u. Edges are undirected.
+			template<typename F>
+			void neighbours(const int & u, const bool &, F f) const
+			{
+				for (const auto & edge : prm[u].edges)
+				{
+					f(edge.next_id, heuristic(u, edge.next_id));
+				}
+			}
+
+		private:
+			const std::vector<Vertex> & prm;
+		};
+
+		// \brief Grid seen by NBA*: row-major cell IDs, 8-connected octile costs, as in Astar
+		class GridGraph
+		{
+		public:
+			GridGraph(const Grid & grid_, const double & resolution_, const int & start_)
+				: grid(grid_), resolution(resolution_), start(start_)
+			{
+				const auto dims = grid.return_grid_dimensions();
+				width = dims.at(0);
+				height = dims.at(1);
+			}
+
+			int size() const
+			{
+				return width * height;
+			}
+
+			double heuristic(const int & a, const int & b) const
+			{
+				return Connect8::distance(std::abs(a % width - b % width), std::abs(a / width - b / width)) * resolution;
+			}
+
+			// \brief calls f(neighbour, edge cost) for each neighbour of u that can be entered.
+			// The backward search follows moves in reverse, so it may also reach the start cell, which is never entered.
+			template<typename F>
+			void neighbours(const int & u, const bool & backward, F f) const
+			{
+				const int x = u % width;
+				const int y = u / width;
+				for (const auto & offset : map::OFFSETS_8)
+				{
+					const int nx = x + offset.dx;
+					const int ny = y + offset.dy;
+					if (nx < 0 or nx >= width or ny < 0 or ny >= height)
+					{
+						continue;
+					}
+					const int v = map::grid2rowmajor(nx, ny, width);
+					if (grid.celltype(nx, ny) != map::Free and !(backward and v == start))
+					{
+						continue;
+					}
+					f(v, ((offset.dx != 0 and offset.dy != 0) ? SQRT_2 : 1.0) * resolution);
+				}
+			}
+
+		private:
+			const Grid & grid;
+			double resolution;
+			int start;
+			int width = 0;
+			int height = 0;
+		};
+
+		// \brief NBA*: alternately expands the smaller frontier. A node is expanded at most once over both searches,
+		// and is rejected without expansion when it cannot lie on a path shorter than the best one found (L).
+		// \param graph: PRMGraph or GridGraph
+		// \param s: start ID
+		// \param t: goal ID
+		// \param cost: set to the path cost, infinity if t is unreachable
+		// \param expansions: set to the number of nodes expanded
+		// \returns the IDs from s to t, or from s to the forward node closest to t if t is unreachable
+		template<typename Graph>
+		std::vector<int> nba_star(const Graph & graph, const int & s, const int & t, double & cost, int & expansions)
+		{
+			const int n = graph.size();
+			// Index 0 is the forward search (from s), 1 the backward search (from t)
+			std::vector<double> gcost[2] = {std::vector<double>(n, INF), std::vector<double>(n, INF)};
+			std::vector<int> parent[2] = {std::vector<int>(n, -1), std::vector<int>(n, -1)};
+			// Expanded or rejected by either search
+			std::vector<bool> done(n, false);
+			NBAOpenList open_list[2];
+			const int source[2] = {s, t};
+			const int target[2] = {t, s};
+
+			double F[2];
+			for (int side = 0; side < 2; side++)
+			{
+				gcost[side][source[side]] = 0.0;
+				F[side] = graph.heuristic(source[side], target[side]);
+				open_list[side].push(NBAEntry{F[side], 0.0, source[side]});
+			}
+
+			double L = s == t ? 0.0 : INF;
+			int meet = s == t ? s : -1;
+			expansions = 0;
+
+			// Fall back to the forward node closest to the goal
+			int closest = s;
+			double closest_h = F[0];
+
+			while (!open_list[0].empty() and !open_list[1].empty())
+			{
+				const int side = open_list[0].size() <= open_list[1].size() ? 0 : 1;
+				const int other = 1 - side;
+				const NBAEntry current = open_list[side].top();
+				open_list[side].pop();
+				F[side] = open_list[side].empty() ? current.fcost : open_list[side].top().fcost;
+
+				const int x = current.id;
+				if (done[x] or current.gcost > gcost[side][x])
+				{
+					continue;
+				}
+				done[x] = true;
+
+				// Rejection: no path through x can beat L
+				const double g = gcost[side][x];
+				if (g + graph.heuristic(x, target[side]) >= L or g + F[other] - graph.heuristic(x, source[side]) >= L)
+				{
+					continue;
+				}
+				expansions++;
+
+				if (side == 0 and graph.heuristic(x, t) < closest_h)
+				{
+					closest_h = graph.heuristic(x, t);
+					closest = x;
+				}
+
+				graph.neighbours(x, side == 1, [&](const int & y, const double & step)
+				{
+					if (done[y] or g + step >= gcost[side][y])
+					{
+						return;
+					}
+					gcost[side][y] = g + step;
+					parent[side][y] = x;
+					open_list[side].push(NBAEntry{gcost[side][y] + graph.heuristic(y, target[side]), gcost[side][y], y});
+
+					// Meeting point
+					if (gcost[side][y] + gcost[other][y] < L)
+					{
+						L = gcost[side][y] + gcost[other][y];
+						meet = y;
+					}
+				});
+				// The pushes may have lowered this frontier's bound, which the other search rejects against
+				if (!open_list[side].empty())
+				{
+					F[side] = open_list[side].top().fcost;
+				}
+			}
+
+			cost = L;
+			std::vector<int> ids;
+			if (meet == -1)
+			{
+				for (int id = closest; id != -1; id = parent[0][id])
+				{
+					ids.push_back(id);
+				}
+				std::reverse(ids.begin(), ids.end());
+				return ids;
+			}
+
+			// Forward half up to the meeting point, then the backward half to the goal
+			for (int id = meet; id != -1; id = parent[0][id])
+			{
+				ids.push_back(id);
+			}
+			std::reverse(ids.begin(), ids.end());
+			for (int id = parent[1][meet]; id != -1; id = parent[1][id])
+			{
+				ids.push_back(id);
+			}
+			return ids;
+		}
+	}
+
+	std::vector<Node> BidirectionalAstar::plan(const Vector2D & start, const Vector2D & goal, const std::vector<Vertex> & map)
+	{
+		const PRMGraph graph(map);
+		const int s = snapper ? snapper->snap(start) : find_nearest_node(start, map).id;
+		const int t = snapper ? snapper->snap(goal) : find_nearest_node(goal, map).id;
+
+		const std::vector<int> ids = nba_star(graph, s, t, cost, expansions);
+		if (cost < INF)
+		{
+			std::cout << "Goal found after " << expansions << " Iterations!" << std::endl;
+		} else
+		{
+			std::cout << "No valid path! returning most complete path" << std::endl;
+		}
+
+		std::vector<Node> path;
+		for (const int id : ids)
+		{
+			Node node;
+			node.vertex = map.at(id);
+			node.id = id;
+			if (!path.empty())
+			{
+				node.parent_id = path.back().id;
+				node.gcost = path.back().gcost + graph.heuristic(path.back().id, id);
+			} else
+			{
+				node.gcost = 0.0;
+			}
+			node.hcost = graph.heuristic(id, t);
+			node.fcost = node.gcost + node.hcost;
+			path.push_back(node);
+		}
+
+		std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+		return path;
+	}
+
+	std::vector<Node> BidirectionalAstar::plan(const Vector2D & start, const Vector2D & goal, const map::Grid & grid_, const double & resolution)
+	{
+		const Index s = grid_.world2grid(Cell(start, resolution));
+		const Index t = grid_.world2grid(Cell(goal, resolution));
+		const GridGraph graph(grid_, resolution, s.row_major);
+
+		std::vector<int> ids;
+		if (grid_.celltype(t.x, t.y) == map::Free)
+		{
+			ids = nba_star(graph, s.row_major, t.row_major, cost, expansions);
+		} else
+		// A blocked goal can never be entered
+		{
+			cost = INF;
+			expansions = 0;
+			ids.push_back(s.row_major);
+		}
+
+		if (cost < INF)
+		{
+			std::cout << "Goal found after " << expansions << " Iterations!" << std::endl;
+		} else
+		{
+			std::cout << "No valid path! returning most complete path" << std::endl;
+		}
+
+		const int width = grid_.return_grid_dimensions().at(0);
+		std::vector<Node> path;
+		for (const int id : ids)
+		{
+			Node node;
+			node.cell = grid_.return_cell(id % width, id / width);
+			node.id = id;
+			if (!path.empty())
+			{
+				node.parent_id = path.back().id;
+				node.gcost = path.back().gcost + graph.heuristic(path.back().id, id);
+			} else
+			{
+				node.gcost = 0.0;
+			}
+			node.hcost = graph.heuristic(id, t.row_major);
+			node.fcost = node.gcost + node.hcost;
+			path.push_back(node);
+		}
+
+		std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+		return path;
+	}
+
+	double BidirectionalAstar::return_cost() const
+	{
+		return cost;
+	}
+
+	int BidirectionalAstar::return_expansions() const
+	{
+		return expansions;
+	}
+}
@@ -0,0 +1,371 @@
+#include "global_planner/contraction.hpp"
+#include "global_planner/snapping.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace global
+{
+	// Witness searches give up after settling this many vertices. A missed witness only costs an extra shortcut.
+	static constexpr int WITNESS_SETTLE_LIMIT = 500;
+
+	ContractionHierarchy::ContractionHierarchy(const std::vector<Vertex> & prm_)
+		: prm(prm_), tree(prm_)
+	{
+		const int n = static_cast<int>(prm.size());
+		graph.resize(n);
+		for (int v = 0; v < n; v++)
+		{
+			if (prm.at(v).id != v)
+			{
+				throw std::invalid_argument("Vertex IDs must be their positions in the roadmap\n  where(): ContractionHierarchy::ContractionHierarchy(const std::vector<Vertex> & prm_)");
+			}
+			for (const auto & edge : prm.at(v).edges)
+			{
+				if (edge.next_id != v)
+				{
+					const Vector2D & a = prm.at(v).coords;
+					const Vector2D & b = prm.at(edge.next_id).coords;
+					add_arc(v, edge.next_id, map::euclidean_distance(a.x - b.x, a.y - b.y), -1);
+				}
+			}
+		}
+
+		deleted_neighbours.assign(n, 0);
+		upward.resize(n);
+		rank.assign(n, -1);
+		witness_dist.resize(n);
+		witness_seen.assign(n, 0);
+		for (int d = 0; d < 2; d++)
+		{
+			dist[d].resize(n);
+			parent[d].resize(n);
+			seen[d].assign(n, 0);
+		}
+
+		contract();
+		std::cout << "Contracted " << n << " vertices with " << shortcut_count << " shortcuts." << std::endl;
+	}
+
+	std::vector<Node> ContractionHierarchy::plan(const Vector2D & start, const Vector2D & goal)
+	{
+		if (prm.empty())
+		{
+			throw std::runtime_error("Cannot plan on an empty roadmap\n  where(): ContractionHierarchy::plan(const Vector2D & start, const Vector2D & goal)");
+		}
+		if (snapper)
+		{
+			return plan(snapper->snap(start), snapper->snap(goal));
+		}
+		return plan(tree.nearest(start), tree.nearest(goal));
+	}
+
+	std::vector<Node> ContractionHierarchy::plan(const int & start_id, const int & goal_id)
+	{
+		query(start_id, goal_id);
+
+		// Walk up from the start to the meeting vertex, then down to the goal, and expand the shortcuts
+		std::vector<int> ids{start_id};
+		if (meet != -1)
+		{
+			std::vector<int> hierarchy_path;
+			for (int id = meet; id != -1; id = parent[0][id])
+			{
+				hierarchy_path.push_back(id);
+			}
+			std::reverse(hierarchy_path.begin(), hierarchy_path.end());
+			for (int id = parent[1][meet]; id != -1; id = parent[1][id])
+			{
+				hierarchy_path.push_back(id);
+			}
+			for (size_t i = 1; i < hierarchy_path.size(); i++)
+			{
+				unpack(hierarchy_path.at(i - 1), hierarchy_path.at(i), ids);
+			}
+		} else
+		{
+			std::cout << "No valid path! returning the start vertex" << std::endl;
+		}
+
+		std::vector<Node> path;
+		double gcost = 0.0;
+		for (size_t i = 0; i < ids.size(); i++)
+		{
+			const Vertex & vertex = prm.at(ids.at(i));
+			if (i > 0)
+			{
+				const Vector2D & previous = path.back().vertex.coords;
+				gcost += map::euclidean_distance(previous.x - vertex.coords.x, previous.y - vertex.coords.y);
+				path.back().parent_id = vertex.id;
+			}
+			Node node;
+			node.vertex = vertex;
+			node.id = vertex.id;
+			node.gcost = gcost;
+			node.hcost = map::euclidean_distance(vertex.coords.x - prm.at(goal_id).coords.x, vertex.coords.y - prm.at(goal_id).coords.y);
+			node.fcost = node.gcost + node.hcost;
+			path.push_back(node);
+		}
+
+		std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+		return path;
+	}
+
+	double ContractionHierarchy::query(const int & s, const int & t)
+	{
+		// A new stamp invalidates all previous search state without clearing the arrays
+		stamp++;
+		settled = 0;
+		meet = -1;
+		cost = std::numeric_limits<double>::infinity();
+
+		MinQueue open_list[2];
+		const int sources[2] = {s, t};
+		for (int d = 0; d < 2; d++)
+		{
+			dist[d].at(sources[d]) = 0.0;
+			parent[d].at(sources[d]) = -1;
+			seen[d].at(sources[d]) = stamp;
+			open_list[d].push(Entry(0.0, sources[d]));
+		}
+
+		// Alternate between the two upward searches. One stops once nothing left in it can beat the best meeting.
+		int d = 1;
+		while (true)
+		{
+			for (int k = 0; k < 2; k++)
+			{
+				if (!open_list[k].empty() and open_list[k].top().first >= cost)
+				{
+					open_list[k] = MinQueue();
+				}
+			}
+			if (open_list[0].empty() and open_list[1].empty())
+			{
+				break;
+			}
+			if (!open_list[1 - d].empty())
+			{
+				d = 1 - d;
+			}
+
+			const Entry current = open_list[d].top();
+			open_list[d].pop();
+			const int u = current.second;
+			if (current.first > dist[d][u])
+			{
+				continue;
+			}
+			settled++;
+
+			if (seen[1 - d][u] == stamp and current.first + dist[1 - d][u] < cost)
+			{
+				cost = current.first + dist[1 - d][u];
+				meet = u;
+			}
+
+			for (const auto & arc : upward[u])
+			{
+				const double tentative = current.first + arc.weight;
+				if (seen[d][arc.to] != stamp or tentative < dist[d][arc.to])
+				{
+					seen[d][arc.to] = stamp;
+					dist[d][arc.to] = tentative;
+					parent[d][arc.to] = u;
+					open_list[d].push(Entry(tentative, arc.to));
+				}
+			}
+		}
+
+		return cost;
+	}
+
+	double ContractionHierarchy::return_cost() const
+	{
+		return cost;
+	}
+
+	int ContractionHierarchy::return_settled() const
+	{
+		return settled;
+	}
+
+	int ContractionHierarchy::return_shortcuts() const
+	{
+		return shortcut_count;
+	}
+
+	const std::vector<int> & ContractionHierarchy::return_ranks() const
+	{
+		return rank;
+	}
+
+	void ContractionHierarchy::set_snapper(const RoadmapSnapper * snapper_)
+	{
+		snapper = snapper_;
+	}
+
+	void ContractionHierarchy::contract()
+	{
+		const int n = static_cast<int>(prm.size());
+		std::priority_queue <std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>> > queue;
+		for (int v = 0; v < n; v++)
+		{
+			queue.push(std::make_pair(priority(v), v));
+		}
+
+		int order = 0;
+		while (!queue.empty())
+		{
+			const int v = queue.top().second;
+			queue.pop();
+
+			// Lazy update: contracting neighbours changes a priority, so recompute it and requeue v
+			// if it is no longer the least important
+			const int current = priority(v);
+			if (!queue.empty() and current > queue.top().first)
+			{
+				queue.push(std::make_pair(current, v));
+				continue;
+			}
+
+			shortcut_count += shortcuts(v, false);
+
+			// All remaining neighbours are contracted later, so they are higher in the hierarchy
+			upward.at(v) = graph.at(v);
+			rank.at(v) = order++;
+			for (const auto & arc : graph.at(v))
+			{
+				auto & arcs = graph.at(arc.to);
+				arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [&v](const CHArc & a) { return a.to == v; }), arcs.end());
+				deleted_neighbours.at(arc.to)++;
+			}
+			graph.at(v).clear();
+		}
+
+		// The remaining graph is empty now
+		graph.clear();
+		graph.shrink_to_fit();
+	}
+
+	int ContractionHierarchy::shortcuts(const int & v, const bool & simulate)
+	{
+		// Shortcuts join v's neighbours, so they never change v's own arcs
+		const std::vector<CHArc> & arcs = graph.at(v);
+		int count = 0;
+		for (size_t i = 0; i + 1 < arcs.size(); i++)
+		{
+			double max_distance = 0.0;
+			for (size_t j = i + 1; j < arcs.size(); j++)
+			{
+				max_distance = std::max(max_distance, arcs.at(i).weight + arcs.at(j).weight);
+			}
+
+			witness_search(arcs.at(i).to, v, max_distance);
+			for (size_t j = i + 1; j < arcs.size(); j++)
+			{
+				const int w = arcs.at(j).to;
+				const double via = arcs.at(i).weight + arcs.at(j).weight;
+				if (witness_seen[w] == witness_stamp and witness_dist[w] <= via)
+				{
+					continue;
+				}
+				count++;
+				if (!simulate)
+				{
+					add_arc(arcs.at(i).to, w, via, v);
+				}
+			}
+		}
+		return count;
+	}
+
+	int ContractionHierarchy::priority(const int & v)
+	{
+		return shortcuts(v, true) - static_cast<int>(graph.at(v).size()) + deleted_neighbours.at(v);
+	}
+
+	void ContractionHierarchy::witness_search(const int & source, const int & via, const double & max_distance)
+	{
+		witness_stamp++;
+		MinQueue open_list;
+		witness_dist[source] = 0.0;
+		witness_seen[source] = witness_stamp;
+		open_list.push(Entry(0.0, source));
+
+		int settled_count = 0;
+		while (!open_list.empty() and settled_count < WITNESS_SETTLE_LIMIT)
+		{
+			const Entry current = open_list.top();
+			open_list.pop();
+			if (current.first > witness_dist[current.second])
+			{
+				continue;
+			}
+			if (current.first > max_distance)
+			{
+				break;
+			}
+			settled_count++;
+
+			for (const auto & arc : graph[current.second])
+			{
+				if (arc.to == via)
+				{
+					continue;
+				}
+				const double tentative = current.first + arc.weight;
+				if (witness_seen[arc.to] != witness_stamp or tentative < witness_dist[arc.to])
+				{
+					witness_seen[arc.to] = witness_stamp;
+					witness_dist[arc.to] = tentative;
+					open_list.push(Entry(tentative, arc.to));
+				}
+			}
+		}
+	}
+
+	void ContractionHierarchy::add_arc(const int & a, const int & b, const double & weight, const int & middle)
+	{
+		// Arcs are kept in both directions, at most one per pair of vertices
+		const int ends[2][2] = {{a, b}, {b, a}};
+		for (const auto & end : ends)
+		{
+			auto & arcs = graph.at(end[0]);
+			auto it = std::find_if(arcs.begin(), arcs.end(), [&end](const CHArc & arc) { return arc.to == end[1]; });
+			if (it == arcs.end())
+			{
+				arcs.push_back(CHArc{end[1], weight, middle});
+			} else if (weight < it->weight)
+			{
+				it->weight = weight;
+				it->middle = middle;
+			}
+		}
+	}
+
+	void ContractionHierarchy::unpack(const int & a, const int & b, std::vector<int> & ids) const
+	{
+		const CHArc & arc = rank.at(a) < rank.at(b) ? upward_arc(a, b) : upward_arc(b, a);
+		if (arc.middle == -1)
+		{
+			ids.push_back(b);
+			return;
+		}
+		// The bypassed vertex was contracted before both ends, so it has upward arcs to each
+		unpack(a, arc.middle, ids);
+		unpack(arc.middle, b, ids);
+	}
+
+	const CHArc & ContractionHierarchy::upward_arc(const int & low, const int & high) const
+	{
+		for (const auto & arc : upward.at(low))
+		{
+			if (arc.to == high)
+			{
+				return arc;
+			}
+		}
+		throw std::runtime_error("Missing arc in the hierarchy\n  where(): ContractionHierarchy::upward_arc(const int & low, const int & high) const");
+	}
+}
@@ -0,0 +1,137 @@
+#include "global_planner/executor.hpp"
+#include <stdexcept>
+
+namespace global
+{
+	CancelToken::CancelToken()
+		: flag(std::make_shared<std::atomic<bool>>(false))
+	{
+	}
+
+	bool CancelToken::cancelled() const
+	{
+		return flag->load(std::memory_order_relaxed);
+	}
+
+	void CancelToken::cancel() const
+	{
+		flag->store(true, std::memory_order_relaxed);
+	}
+
+
+	PlanningExecutor::PlanningExecutor(const int & threads)
+	{
+		if (threads < 1)
+		{
+			throw std::invalid_argument("PlanningExecutor needs at least one thread\n  where(): PlanningExecutor::PlanningExecutor(const int & threads)");
+		}
+
+		for (int i = 0; i < threads; i++)
+		{
+			workers.emplace_back(&PlanningExecutor::work, this);
+		}
+	}
+
+	PlanningExecutor::~PlanningExecutor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			queue.clear();
+			for (const auto & entry : running)
+			{
+				entry.second.cancel();
+			}
+		}
+		wake.notify_all();
+
+		for (auto & worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	uint64_t PlanningExecutor::submit(PlanningJob job)
+	{
+		Request request;
+		request.job = std::move(job);
+		uint64_t id = 0;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// Older requests are stale
+			queue.clear();
+			for (const auto & entry : running)
+			{
+				entry.second.cancel();
+			}
+			ready = false;
+
+			latest++;
+			id = latest;
+			request.id = id;
+			queue.push_back(std::move(request));
+		}
+		wake.notify_one();
+		return id;
+	}
+
+	void PlanningExecutor::cancel()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.clear();
+		for (const auto & entry : running)
+		{
+			entry.second.cancel();
+		}
+		ready = false;
+	}
+
+	bool PlanningExecutor::poll(PlanResult & result_)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!ready)
+		{
+			return false;
+		}
+		result_ = std::move(result);
+		ready = false;
+		return true;
+	}
+
+	bool PlanningExecutor::busy() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return !queue.empty() or !running.empty();
+	}
+
+	void PlanningExecutor::work()
+	{
+		while (true)
+		{
+			Request request;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [this]{ return stopping or !queue.empty(); });
+				if (stopping)
+				{
+					return;
+				}
+				request = std::move(queue.front());
+				queue.pop_front();
+				running.emplace(request.id, request.token);
+			}
+
+			PlanResult planned = request.job(request.token);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			running.erase(request.id);
+			// Results of cancelled requests are stale
+			if (request.id == latest and !request.token.cancelled())
+			{
+				result = std::move(planned);
+				result.request = request.id;
+				ready = true;
+			}
+		}
+	}
+}
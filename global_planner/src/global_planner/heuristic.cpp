@@ -1,4 +1,7 @@
 #include "global_planner/heuristic.hpp"
+#include "global_planner/grid_search.hpp"
+#include "global_planner/path_cache.hpp"
+#include "global_planner/snapping.hpp"
 
 namespace global
 {
@@ -15,9 +18,10 @@ namespace global
 	}
 
 	// PRM version
-	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, std::vector<Vertex> & map)
+	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const std::vector<Vertex> & map)
 	{
-		PRM = map;
+		// Only the address is kept: the roadmap is read in place, never copied
+		PRM = &map;
 
 		/**
 			Main Planning Loop
@@ -54,13 +58,13 @@ namespace global
 	    // Store the goal node
 	    Node goal_node;
 	    // Find PRM vertex whose coordinates most closely match the goal coordinates
-	    goal_node.vertex = find_nearest_node(goal, PRM);
+	    goal_node.vertex = snapper ? PRM->at(snapper->snap(goal)) : find_nearest_node(goal, *PRM);
 	    goal_node.id = goal_node.vertex.id;
 
 	    // Add the start node to the queue
 	    Node current_node;
 	    // Find PRM vertex whose coordinates most closely match the start coordinates
-	    current_node.vertex = find_nearest_node(start, PRM);
+	    current_node.vertex = snapper ? PRM->at(snapper->snap(start)) : find_nearest_node(start, *PRM);
 	    current_node.id = current_node.vertex.id;
 
 	    open_list.push(current_node);
@@ -87,6 +91,9 @@ namespace global
 	    	open_list.pop();
 	    	open_list_v.erase(current_node.id);
 
+	    	// Settle the node's parent before it is closed (Lazy Theta*)
+	    	expand_vtx(current_node, closed_list);
+
 	    	// Add current node ID to closed list
 	    	closed_list.insert(current_node);
 
@@ -107,7 +114,7 @@ namespace global
 
 	    		// Find the neighbour node
 	    		Node neighbour;
-	    		neighbour.vertex = PRM.at(edge_iter->next_id);
+	    		neighbour.vertex = PRM->at(edge_iter->next_id);
 	    		// Self-identify
 				neighbour.id = neighbour.vertex.id;
 
@@ -196,6 +203,11 @@ namespace global
 
 	}
 
+	void Astar::expand_vtx(Node &, const std::set<Node, std::less<>> &)
+	{
+		// A* relaxes along roadmap edges, which are already collision free
+	}
+
 	std::vector<Node> Astar::trace_path(const Node & final_node, const std::set<Node, std::less<>> & closed_list)
 	{
 		// First node in the vector is 'final node'
@@ -224,8 +236,8 @@ namespace global
 
 	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const Grid & grid_, const double & resolution)
 	{
-		Grid grid = grid_;
-		GRID = grid.return_grid();
+		// Read cells through a const reference: no per-plan copy of the Grid
+		const Grid & grid = grid_;
 
 		/**
 			Main Planning Loop
@@ -309,7 +321,7 @@ namespace global
 	    	}
 
 	    	// Find the current node's neighbours
-	    	std::vector<Cell> neighbours = get_neighbours(current_node, GRID);
+	    	std::vector<Cell> neighbours = get_neighbours(current_node, grid);
 
 	    	// Loop through each node's neighbors
 	    	for (auto nbr_iter = neighbours.begin(); nbr_iter < neighbours.end(); nbr_iter++)
@@ -366,6 +378,145 @@ namespace global
 
 	}
 
+	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const map::GridView & view)
+	{
+		// Cells are read straight from shared memory, so there is no GRID copy here
+		GridSearch<map::GridView> search(view);
+		return search.plan(start, goal);
+	}
+
+	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot)
+	{
+		GridSearch<map::GridSnapshot> search(snapshot);
+		return search.plan(start, goal);
+	}
+
+	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot, PathCache & cache)
+	{
+		const double resolution = snapshot.return_resolution();
+		const int s = snapshot.world2grid(Cell(start, resolution)).row_major;
+		const int g = snapshot.world2grid(Cell(goal, resolution)).row_major;
+		const PathKey key{s, g, policy_settings<Connect8, OctileCost>("astar")};
+		const auto cached = cache.lookup(key, snapshot.return_epoch());
+		if (cached)
+		{
+			return *cached;
+		}
+
+		GridSearch<map::GridSnapshot> search(snapshot);
+		std::vector<Node> path = search.plan(start, goal);
+		if (search.return_status() == SearchStatus::Done)
+		{
+			cache.insert(key, snapshot.return_epoch(), path, snapshot.return_grid_dimensions().at(0));
+		}
+		return path;
+	}
+
+	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const map::TiledGrid & tiled)
+	{
+		GridSearch<map::TiledGrid> search(tiled);
+		return search.plan(start, goal);
+	}
+
+	std::vector<Node> Astar::plan(const Vector2D & start, const Vector2D & goal, const map::QuadTree & tree)
+	{
+		const std::vector<map::QuadLeaf> & leaves = tree.return_leaves();
+		const int s = tree.world2leaf(start);
+		const int g = tree.world2leaf(goal);
+		const Vector2D goal_center = tree.leaf_center(g);
+
+		const auto leaf_distance = [&tree](const int & a, const Vector2D & b)
+		{
+			const Vector2D ca = tree.leaf_center(a);
+			return map::euclidean_distance(ca.x - b.x, ca.y - b.y);
+		};
+
+		// Search state per leaf
+		std::vector<double> gcost(leaves.size(), std::numeric_limits<double>::infinity());
+		std::vector<int> parent(leaves.size(), -1);
+		std::vector<bool> closed(leaves.size(), false);
+		std::priority_queue <GridEntry, std::vector<GridEntry>, GridEntryComparator > open_list;
+
+		gcost.at(s) = 0.0;
+		const double h0 = leaf_distance(s, goal_center);
+		open_list.push(GridEntry{h0, h0, 0.0, s, leaves.at(s).x, leaves.at(s).y});
+
+		// Fall back to the closest expanded leaf if the goal is never reached
+		int last = s;
+		double best_h = h0;
+		int expansions = 0;
+		bool found = false;
+
+		while (!open_list.empty())
+		{
+			const GridEntry current = open_list.top();
+			open_list.pop();
+			if (closed[current.idx] or current.gcost > gcost[current.idx])
+			{
+				continue;
+			}
+			closed[current.idx] = true;
+			expansions++;
+
+			if (current.hcost < best_h)
+			{
+				best_h = current.hcost;
+				last = current.idx;
+			}
+
+			// END condition
+			if (current.idx == g)
+			{
+				std::cout << "Goal found after " << expansions << " Iterations!" << std::endl;
+				last = g;
+				found = true;
+				break;
+			}
+
+			const Vector2D center = tree.leaf_center(current.idx);
+			for (const int n : leaves[current.idx].neighbours)
+			{
+				if (closed[n])
+				{
+					continue;
+				}
+				const double gn = current.gcost + leaf_distance(n, center);
+				if (gn < gcost[n])
+				{
+					gcost[n] = gn;
+					parent[n] = current.idx;
+					const double hn = leaf_distance(n, goal_center);
+					open_list.push(GridEntry{gn + hn, hn, gn, n, leaves[n].x, leaves[n].y});
+				}
+			}
+		}
+
+		if (!found)
+		{
+			std::cout << "No valid path! returning most complete path" << std::endl;
+		}
+
+		std::vector<Node> path;
+		for (int id = last; id != -1; id = parent[id])
+		{
+			Node node;
+			node.cell = tree.return_leaf_cell(id);
+			node.id = id;
+			node.gcost = gcost[id];
+			node.hcost = leaf_distance(id, goal_center);
+			node.fcost = node.gcost + node.hcost;
+			if (!path.empty())
+			{
+				path.back().parent_id = node.id;
+			}
+			path.push_back(node);
+		}
+		std::reverse(path.begin(), path.end());
+
+		std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+		return path;
+	}
+
 	void Astar::update_cell(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node)
 	{
 		// Calculate a new tentative g cost
@@ -426,37 +577,27 @@ namespace global
 	}
 
 
-	std::vector<Cell> Astar::get_neighbours(const Node & n, const std::vector<Cell> & map)
+	std::vector<Cell> Astar::get_neighbours(const Node & n, const Grid & grid)
 	{
-		int x_max = map.back().index.x;
-		int y_max = map.back().index.y; 
+		// Extent from the grid's indexer, not from the last cell of the map
+		const map::GridIndexer & indexer = grid.return_indexer();
+		const int width = indexer.return_width();
+		const int height = indexer.return_height();
+		const std::vector<Cell> & cells = grid.return_grid();
 		std::vector<Cell> neighbours;
-		// std::cout << "Node at [" << n.cell.index.x << ", " << n.cell.index.y << "]" << std::endl;
+		neighbours.reserve(map::OFFSETS_8.size());
 
 		// Evaluate about 3x3 block for 8-connectivity
-		for (int x = -1; x < 2; x++)
+		for (const auto & offset : map::OFFSETS_8)
 		{
-			for (int y = -1; y < 2; y++)
-			{
-				// Skip x,y = (0,0) since that's the current node
-				if (x == 0 and y == 0)
-				{
-					continue;
-				} else
-				{
-					int check_x = n.cell.index.x + x;
-					int check_y = n.cell.index.y + y;
+			int check_x = n.cell.index.x + offset.dx;
+			int check_y = n.cell.index.y + offset.dy;
 
-					// Ensure potential neighbour is within grid bounds
-					if (check_x >= 0 and check_x <= x_max and check_y >= 0 and check_y <= y_max)
-					{
-						// Now we need to grab the right cell from the map. To do this: index->RMJ
-						// std::cout << "Neighbour at [" << check_x << ", " << check_y << "]" << std::endl;
-						int rmj = map::grid2rowmajor(check_x, check_y, x_max + 1);
-						Cell nbr = map.at(rmj);
-						neighbours.push_back(nbr);
-					}
-				}
+			// Ensure potential neighbour is within grid bounds
+			if (check_x >= 0 and check_x < width and check_y >= 0 and check_y < height)
+			{
+				// Cells are stored row-major
+				neighbours.push_back(cells[map::grid2rowmajor(check_x, check_y, width)]);
 			}
 		}
 		return neighbours;
@@ -478,32 +619,7 @@ namespace global
 
 		if (clear)
 		{
-			for (auto obs_iter = obstacles.begin(); obs_iter != obstacles.end(); obs_iter++)
-			{
-				// Edge on Edge Check
-				if (!no_intersect(neighbour.vertex, PRM.at(grandparent_id), obs_iter))
-				{
-					clear = false;
-					break;
-				}
-
-				// Edge Near Point Check
-				for (auto v_iter = obs_iter->vertices.begin(); v_iter != obs_iter->vertices.end(); v_iter++)
-				{
-					if (too_close(neighbour.vertex, PRM.at(grandparent_id), Vertex(*v_iter), inflate_robot))
-					{
-						clear = false;
-						break;
-					}
-				}
-
-				// No need to loop over other obstacles if not clear
-				if (!clear)
-				{
-					break;
-				}
-			}
-
+			clear = line_of_sight(neighbour.vertex, PRM->at(grandparent_id));
 		}
 
 		if (!clear)
@@ -515,12 +631,12 @@ namespace global
 		} else
 		{
 			// g cost of grandparent = current_node gcost - dist(grandparent->current)
-			double grandparent_gcost = current_node.gcost - map::euclidean_distance(current_node.vertex.coords.x - PRM.at(grandparent_id).coords.x,
-													  					            current_node.vertex.coords.y - PRM.at(grandparent_id).coords.y);
+			double grandparent_gcost = current_node.gcost - map::euclidean_distance(current_node.vertex.coords.x - PRM->at(grandparent_id).coords.x,
+													  					            current_node.vertex.coords.y - PRM->at(grandparent_id).coords.y);
 
 			// g cost is grandparent node g cost + dist(grandparent -> neighbor)
-			neighbour.gcost = grandparent_gcost + map::euclidean_distance(neighbour.vertex.coords.x - PRM.at(grandparent_id).coords.x,
-													  					neighbour.vertex.coords.y - PRM.at(grandparent_id).coords.y);
+			neighbour.gcost = grandparent_gcost + map::euclidean_distance(neighbour.vertex.coords.x - PRM->at(grandparent_id).coords.x,
+													  					neighbour.vertex.coords.y - PRM->at(grandparent_id).coords.y);
 			// Update f cost
 			neighbour.fcost = neighbour.gcost + neighbour.hcost;
 
@@ -550,32 +666,7 @@ namespace global
 
 		if (clear)
 		{
-			for (auto obs_iter = obstacles.begin(); obs_iter != obstacles.end(); obs_iter++)
-			{
-				// Edge on Edge Check
-				if (!no_intersect(neighbour.vertex, PRM.at(grandparent_id), obs_iter))
-				{
-					clear = false;
-					break;
-				}
-
-				// Edge Near Point Check
-				for (auto v_iter = obs_iter->vertices.begin(); v_iter != obs_iter->vertices.end(); v_iter++)
-				{
-					if (too_close(neighbour.vertex, PRM.at(grandparent_id), Vertex(*v_iter), inflate_robot))
-					{
-						clear = false;
-						break;
-					}
-				}
-
-				// No need to loop over other obstacles if not clear
-				if (!clear)
-				{
-					break;
-				}
-			}
-
+			clear = line_of_sight(neighbour.vertex, PRM->at(grandparent_id));
 		}
 
 		if (!clear)
@@ -588,11 +679,11 @@ namespace global
 		// Perform cost update with new parent
 		{
 			// g cost of grandparent = current_node gcost - dist(grandparent->current)
-			double grandparent_gcost = current_node.gcost - map::euclidean_distance(current_node.vertex.coords.x - PRM.at(grandparent_id).coords.x,
-													  					            current_node.vertex.coords.y - PRM.at(grandparent_id).coords.y);
+			double grandparent_gcost = current_node.gcost - map::euclidean_distance(current_node.vertex.coords.x - PRM->at(grandparent_id).coords.x,
+													  					            current_node.vertex.coords.y - PRM->at(grandparent_id).coords.y);
 			// Calculate a new tentative g cost
-			double gcost = grandparent_gcost + map::euclidean_distance(neighbour.vertex.coords.x - PRM.at(grandparent_id).coords.x,
-													  					neighbour.vertex.coords.y - PRM.at(grandparent_id).coords.y);
+			double gcost = grandparent_gcost + map::euclidean_distance(neighbour.vertex.coords.x - PRM->at(grandparent_id).coords.x,
+													  					neighbour.vertex.coords.y - PRM->at(grandparent_id).coords.y);
 			if (gcost < neighbour.gcost)
 			// Modify Node
 			{
@@ -623,7 +714,138 @@ namespace global
 		}
 	}
 
-	Vertex find_nearest_node(const Vector2D & position, const std::vector<Vertex> & map)
+	bool Thetastar::line_of_sight(const Vertex & v1, const Vertex & v2)
+	{
+		for (auto obs_iter = obstacles.begin(); obs_iter != obstacles.end(); obs_iter++)
+		{
+			// Edge on Edge Check
+			if (!no_intersect(v1, v2, obs_iter))
+			{
+				return false;
+			}
+
+			// Edge Near Point Check
+			for (auto v_iter = obs_iter->vertices.begin(); v_iter != obs_iter->vertices.end(); v_iter++)
+			{
+				if (too_close(v1, v2, Vertex(*v_iter), inflate_robot))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+
+	std::vector<Node> LazyThetastar::plan(const Vector2D & start, const Vector2D & goal, const std::vector<Vertex> & map)
+	{
+		open_gcost.clear();
+		return Astar::plan(start, goal, map);
+	}
+
+	void LazyThetastar::create_vtx(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node)
+	{
+		if (current_node.parent_id == -1)
+		// The start node has no parent to pass on
+		{
+			Astar::create_vtx(open_list, neighbour, current_node);
+			open_gcost[neighbour.id] = neighbour.gcost;
+			return;
+		}
+
+		// Assume line of sight from the parent of current node: expand_vtx checks it if neighbour is expanded
+		const Vertex & grandparent = PRM->at(current_node.parent_id);
+		const double grandparent_gcost = current_node.gcost - map::euclidean_distance(current_node.vertex.coords.x - grandparent.coords.x,
+																					  current_node.vertex.coords.y - grandparent.coords.y);
+		neighbour.gcost = grandparent_gcost + map::euclidean_distance(neighbour.vertex.coords.x - grandparent.coords.x,
+																	  neighbour.vertex.coords.y - grandparent.coords.y);
+		neighbour.fcost = neighbour.gcost + neighbour.hcost;
+		neighbour.parent_id = current_node.parent_id;
+		open_gcost[neighbour.id] = neighbour.gcost;
+		open_list.push(neighbour);
+	}
+
+	void LazyThetastar::update_vtx(std::priority_queue <Node, std::vector<Node>, HeapComparator > & open_list, Node & neighbour, const Node & current_node)
+	{
+		// Tentative parent and g cost, assuming line of sight from the parent of current node
+		int parent_id = current_node.id;
+		double gcost = current_node.gcost + map::euclidean_distance(neighbour.vertex.coords.x - current_node.vertex.coords.x,
+																	neighbour.vertex.coords.y - current_node.vertex.coords.y);
+		if (current_node.parent_id != -1)
+		{
+			const Vertex & grandparent = PRM->at(current_node.parent_id);
+			const double grandparent_gcost = current_node.gcost - map::euclidean_distance(current_node.vertex.coords.x - grandparent.coords.x,
+																						  current_node.vertex.coords.y - grandparent.coords.y);
+			parent_id = current_node.parent_id;
+			gcost = grandparent_gcost + map::euclidean_distance(neighbour.vertex.coords.x - grandparent.coords.x,
+																neighbour.vertex.coords.y - grandparent.coords.y);
+		}
+
+		if (gcost >= open_gcost.at(neighbour.id))
+		{
+			return;
+		}
+		open_gcost[neighbour.id] = gcost;
+
+		// If this happens, we need to re-sort the open list
+		std::priority_queue <Node, std::vector<Node>, HeapComparator > temp_open_list;
+		while (!open_list.empty())
+		{
+			Node temp = open_list.top();
+			if (temp.id == neighbour.id)
+			{
+				temp.gcost = gcost;
+				temp.fcost = temp.gcost + temp.hcost;
+				temp.parent_id = parent_id;
+			}
+			temp_open_list.push(temp);
+			open_list.pop();
+		}
+
+		open_list = temp_open_list;
+	}
+
+	void LazyThetastar::expand_vtx(Node & current_node, const std::set<Node, std::less<>> & closed_list)
+	{
+		if (current_node.parent_id == -1 or line_of_sight(PRM->at(current_node.parent_id), current_node.vertex))
+		{
+			return;
+		}
+
+		// No line of sight: take the expanded neighbour with the lowest g cost plus edge length as parent.
+		// There is always one, the Node whose expansion generated current node.
+		double best_gcost = std::numeric_limits<double>::infinity();
+		int best_id = -1;
+		for (const auto & edge : current_node.vertex.edges)
+		{
+			const auto closed = closed_list.find(edge.next_id);
+			if (closed == closed_list.end())
+			{
+				continue;
+			}
+			const double gcost = closed->gcost + map::euclidean_distance(current_node.vertex.coords.x - closed->vertex.coords.x,
+																		 current_node.vertex.coords.y - closed->vertex.coords.y);
+			if (gcost < best_gcost)
+			{
+				best_gcost = gcost;
+				best_id = closed->id;
+			}
+		}
+
+		if (best_id != -1)
+		{
+			current_node.gcost = best_gcost;
+			current_node.fcost = current_node.gcost + current_node.hcost;
+			current_node.parent_id = best_id;
+		}
+	}
+
+	void Astar::set_snapper(const RoadmapSnapper * snapper_)
+	{
+		snapper = snapper_;
+	}
+
+	const Vertex & find_nearest_node(const Vector2D & position, const std::vector<Vertex> & map)
 	{
 		double min_dist = map::euclidean_distance(position.x - map.at(0).coords.x, position.y - map.at(0).coords.y);
 		int min_idx = 0;
@@ -642,12 +864,12 @@ namespace global
 	}
 
 
-	Cell find_nearest_node(const Vector2D & position, const Grid & grid, const double & resolution)
+	const Cell & find_nearest_node(const Vector2D & position, const Grid & grid, const double & resolution)
 	{
 		Cell temp_cell(position, resolution);
 
 		Index idx = grid.world2grid(temp_cell);
 
-		return (grid.return_grid().at(idx.row_major));
+		return grid.return_grid().at(idx.row_major);
 	}
 }
\ No newline at end of file
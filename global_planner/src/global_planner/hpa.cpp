@@ -0,0 +1,616 @@
+#include "global_planner/hpa.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace global
+{
+	using rigid2d::Vector2D;
+
+	namespace
+	{
+		// \brief open list entry for the abstract search and the cluster searches
+		struct HPAEntry
+		{
+			double fcost;
+			double gcost;
+			int id;
+		};
+
+		class HPAEntryComparator
+		{
+		public:
+			bool operator() (const HPAEntry & e1, const HPAEntry & e2) const
+			{
+				return e1.fcost > e2.fcost;
+			}
+		};
+
+		using HPAOpenList = std::priority_queue <HPAEntry, std::vector<HPAEntry>, HPAEntryComparator >;
+
+		constexpr double INF = std::numeric_limits<double>::infinity();
+	}
+
+	void HPAstar::build(const std::vector<double> & xcells_, const std::vector<double> & ycells_, const double & resolution_,
+						const std::vector<uint8_t> & cell_types, const int & cluster_size_)
+	{
+		if (cluster_size_ < 2)
+		{
+			throw std::invalid_argument("cluster size must be at least 2 cells!\
+										 \n  where(): HPAstar::build(...)");
+		}
+
+		xcells = xcells_;
+		ycells = ycells_;
+		width = static_cast<int>(xcells.size());
+		height = static_cast<int>(ycells.size());
+		resolution = resolution_;
+		types = cell_types;
+		cluster_size = cluster_size_;
+		clusters_x = (width + cluster_size - 1) / cluster_size;
+		clusters_y = (height + cluster_size - 1) / cluster_size;
+		vertical_borders = std::max(clusters_x - 1, 0) * clusters_y;
+
+		nodes.clear();
+		free_ids.clear();
+		borders.clear();
+		borders.resize(vertical_borders + clusters_x * std::max(clusters_y - 1, 0));
+
+		for (int b = 0; b < static_cast<int>(borders.size()); b++)
+		{
+			build_border(b);
+		}
+		for (int c = 0; c < clusters_x * clusters_y; c++)
+		{
+			build_cluster(c);
+		}
+	}
+
+	void HPAstar::build_border(const int & border)
+	{
+		// Remove the old entrances. Their nodes only have edges inside clusters touching this border,
+		// which are rebuilt after it.
+		for (const auto & entrance : borders.at(border))
+		{
+			for (const int id : {entrance.a, entrance.b})
+			{
+				nodes.at(id).alive = false;
+				nodes.at(id).edges.clear();
+				free_ids.push_back(id);
+			}
+		}
+		borders.at(border).clear();
+
+		// Border cells: (ax, ay) in the lower cluster faces (ax + step_x, ay + step_y), along the run direction
+		int ax = 0;
+		int ay = 0;
+		int step_x = 0;
+		int step_y = 0;
+		int run_x = 0;
+		int run_y = 0;
+		int length = 0;
+		if (border < vertical_borders)
+		{
+			const int cx = border % (clusters_x - 1);
+			const int cy = border / (clusters_x - 1);
+			ax = (cx + 1) * cluster_size - 1;
+			ay = cy * cluster_size;
+			step_x = 1;
+			run_y = 1;
+			length = std::min(height, ay + cluster_size) - ay;
+		} else
+		{
+			const int cx = (border - vertical_borders) % clusters_x;
+			const int cy = (border - vertical_borders) / clusters_x;
+			ax = cx * cluster_size;
+			ay = (cy + 1) * cluster_size - 1;
+			step_y = 1;
+			run_x = 1;
+			length = std::min(width, ax + cluster_size) - ax;
+		}
+
+		// Each maximal run of cells free on both sides is an entrance: one transition in the middle,
+		// or one at each end for long runs (Botea et al.)
+		int run_start = -1;
+		for (int i = 0; i <= length; i++)
+		{
+			const bool open = i < length and is_free(ax + i * run_x, ay + i * run_y)
+										 and is_free(ax + i * run_x + step_x, ay + i * run_y + step_y);
+			if (open and run_start == -1)
+			{
+				run_start = i;
+			} else if (!open and run_start != -1)
+			{
+				const int run_end = i - 1;
+				std::vector<int> transitions;
+				if (run_end - run_start + 1 >= 6)
+				{
+					transitions = {run_start, run_end};
+				} else
+				{
+					transitions = {(run_start + run_end) / 2};
+				}
+
+				for (const int t : transitions)
+				{
+					const int x = ax + t * run_x;
+					const int y = ay + t * run_y;
+					const int a = add_node(x, y);
+					const int b = add_node(x + step_x, y + step_y);
+					nodes.at(a).edges.push_back(AbstractEdge{b, resolution, true});
+					nodes.at(b).edges.push_back(AbstractEdge{a, resolution, true});
+					borders.at(border).push_back(Entrance{a, b});
+				}
+				run_start = -1;
+			}
+		}
+	}
+
+	void HPAstar::build_cluster(const int & cluster)
+	{
+		const std::vector<int> ids = cluster_nodes(cluster);
+
+		// Keep only the edges across entrances
+		for (const int id : ids)
+		{
+			auto & edges = nodes.at(id).edges;
+			edges.erase(std::remove_if(edges.begin(), edges.end(), [](const AbstractEdge & e) { return !e.inter; }),
+						edges.end());
+		}
+
+		const int x0 = (cluster % clusters_x) * cluster_size;
+		const int y0 = (cluster / clusters_x) * cluster_size;
+		std::vector<double> dist;
+		std::vector<int> parent;
+		for (const int from : ids)
+		{
+			cluster_dijkstra(cluster, nodes.at(from).x, nodes.at(from).y, dist, parent);
+			for (const int to : ids)
+			{
+				if (to == from)
+				{
+					continue;
+				}
+				const double d = dist.at((nodes.at(to).y - y0) * cluster_size + (nodes.at(to).x - x0));
+				if (d < INF)
+				{
+					nodes.at(from).edges.push_back(AbstractEdge{to, d, false});
+				}
+			}
+		}
+	}
+
+	std::vector<int> HPAstar::cluster_borders(const int & cluster) const
+	{
+		const int cx = cluster % clusters_x;
+		const int cy = cluster / clusters_x;
+		std::vector<int> ids;
+		if (cx > 0)
+		{
+			ids.push_back(cy * (clusters_x - 1) + cx - 1);
+		}
+		if (cx < clusters_x - 1)
+		{
+			ids.push_back(cy * (clusters_x - 1) + cx);
+		}
+		if (cy > 0)
+		{
+			ids.push_back(vertical_borders + (cy - 1) * clusters_x + cx);
+		}
+		if (cy < clusters_y - 1)
+		{
+			ids.push_back(vertical_borders + cy * clusters_x + cx);
+		}
+		return ids;
+	}
+
+	std::vector<int> HPAstar::cluster_nodes(const int & cluster) const
+	{
+		std::vector<int> ids;
+		for (const int border : cluster_borders(cluster))
+		{
+			for (const auto & entrance : borders.at(border))
+			{
+				ids.push_back(nodes.at(entrance.a).cluster == cluster ? entrance.a : entrance.b);
+			}
+		}
+		return ids;
+	}
+
+	int HPAstar::cluster_of(const int & x, const int & y) const
+	{
+		return (y / cluster_size) * clusters_x + x / cluster_size;
+	}
+
+	void HPAstar::cluster_dijkstra(const int & cluster, const int & sx, const int & sy,
+								   std::vector<double> & dist, std::vector<int> & parent) const
+	{
+		const int x0 = (cluster % clusters_x) * cluster_size;
+		const int y0 = (cluster / clusters_x) * cluster_size;
+		const int x1 = std::min(width, x0 + cluster_size);
+		const int y1 = std::min(height, y0 + cluster_size);
+
+		dist.assign(static_cast<size_t>(cluster_size) * cluster_size, INF);
+		parent.assign(dist.size(), -1);
+
+		HPAOpenList open_list;
+		const int s = (sy - y0) * cluster_size + (sx - x0);
+		dist.at(s) = 0.0;
+		open_list.push(HPAEntry{0.0, 0.0, s});
+
+		while (!open_list.empty())
+		{
+			const HPAEntry current = open_list.top();
+			open_list.pop();
+			if (current.gcost > dist[current.id])
+			{
+				continue;
+			}
+
+			const int cx = x0 + current.id % cluster_size;
+			const int cy = y0 + current.id / cluster_size;
+			for (const auto & offset : map::OFFSETS_8)
+			{
+				const int nx = cx + offset.dx;
+				const int ny = cy + offset.dy;
+				if (nx < x0 or nx >= x1 or ny < y0 or ny >= y1 or !is_free(nx, ny))
+				{
+					continue;
+				}
+				const int n = (ny - y0) * cluster_size + (nx - x0);
+				const double g = current.gcost + ((offset.dx != 0 and offset.dy != 0) ? SQRT_2 : 1.0) * resolution;
+				if (g < dist[n])
+				{
+					dist[n] = g;
+					parent[n] = current.id;
+					open_list.push(HPAEntry{g, g, n});
+				}
+			}
+		}
+	}
+
+	void HPAstar::refine(const int & cluster, const int & x1, const int & y1, const int & x2, const int & y2,
+						 std::vector<Index> & cells) const
+	{
+		std::vector<double> dist;
+		std::vector<int> parent;
+		cluster_dijkstra(cluster, x1, y1, dist, parent);
+
+		const int x0 = (cluster % clusters_x) * cluster_size;
+		const int y0 = (cluster / clusters_x) * cluster_size;
+		std::vector<Index> segment;
+		for (int i = (y2 - y0) * cluster_size + (x2 - x0); parent[i] != -1; i = parent[i])
+		{
+			Index index;
+			index.x = x0 + i % cluster_size;
+			index.y = y0 + i / cluster_size;
+			segment.push_back(index);
+		}
+		cells.insert(cells.end(), segment.rbegin(), segment.rend());
+	}
+
+	int HPAstar::add_node(const int & x, const int & y)
+	{
+		int id = 0;
+		if (!free_ids.empty())
+		{
+			id = free_ids.back();
+			free_ids.pop_back();
+		} else
+		{
+			id = static_cast<int>(nodes.size());
+			nodes.emplace_back();
+		}
+
+		AbstractNode & node = nodes.at(id);
+		node.x = x;
+		node.y = y;
+		node.cluster = cluster_of(x, y);
+		node.edges.clear();
+		node.alive = true;
+		return id;
+	}
+
+	Index HPAstar::world2grid(const Vector2D & coords) const
+	{
+		// Grid::world2grid scans for the last cell whose [corner, corner + resolution) holds the centre.
+		// The cells are evenly spaced, so only the cells around the direct estimate can match.
+		const Cell cell(coords, resolution);
+		const auto find = [this, &cell](const std::vector<double> & corners, const double & c)
+		{
+			const int guess = corners.empty() ? 0 : static_cast<int>(std::floor((c - corners.front()) / resolution));
+			for (int i = guess + 1; i >= guess - 1; i--)
+			{
+				if (i >= 0 and i < static_cast<int>(corners.size()) and c >= corners[i] and c < corners[i] + cell.resolution)
+				{
+					return i;
+				}
+			}
+			return -1;
+		};
+
+		Index index;
+		index.x = find(xcells, cell.center_coords.x);
+		index.y = find(ycells, cell.center_coords.y);
+		if (index.x == -1 or index.y == -1)
+		{
+			throw std::runtime_error("Could not convert from world to grid coordinates!\
+									  \n  where(): HPAstar::world2grid(const Vector2D & coords)");
+		}
+		index.row_major = map::grid2rowmajor(index.x, index.y, width);
+		return index;
+	}
+
+	double HPAstar::heuristic(const int & x1, const int & y1, const int & x2, const int & y2) const
+	{
+		return Connect8::distance(std::abs(x1 - x2), std::abs(y1 - y2)) * resolution;
+	}
+
+	std::vector<Node> HPAstar::plan(const Vector2D & start, const Vector2D & goal)
+	{
+		expansions = 0;
+		cost = INF;
+
+		const Index s_index = world2grid(start);
+		const Index g_index = world2grid(goal);
+		const int sx = s_index.x;
+		const int sy = s_index.y;
+		const int gx = g_index.x;
+		const int gy = g_index.y;
+
+		const int s_cluster = cluster_of(sx, sy);
+		const int g_cluster = cluster_of(gx, gy);
+		const int sx0 = (s_cluster % clusters_x) * cluster_size;
+		const int sy0 = (s_cluster / clusters_x) * cluster_size;
+		const int gx0 = (g_cluster % clusters_x) * cluster_size;
+		const int gy0 = (g_cluster / clusters_x) * cluster_size;
+
+		// The start cell is left even if blocked, but a blocked goal cannot be entered
+		if (!is_free(gx, gy))
+		{
+			std::cout << "No valid path! The goal is not free." << std::endl;
+			return std::vector<Node>();
+		}
+
+		// Step 1. Connect start and goal to the entrances of their clusters
+		std::vector<double> s_dist;
+		std::vector<double> g_dist;
+		std::vector<int> unused;
+		cluster_dijkstra(s_cluster, sx, sy, s_dist, unused);
+		cluster_dijkstra(g_cluster, gx, gy, g_dist, unused);
+
+		// Path that stays inside the shared cluster, if any
+		double direct = INF;
+		if (s_cluster == g_cluster)
+		{
+			direct = s_dist.at((gy - gy0) * cluster_size + (gx - gx0));
+		}
+
+		// Step 2. A* on the abstract graph. The goal is reached through goal_cost from its cluster's entrances.
+		std::vector<double> gcost(nodes.size(), INF);
+		std::vector<double> goal_cost(nodes.size(), INF);
+		std::vector<int> parent(nodes.size(), -1);
+		std::vector<bool> closed(nodes.size(), false);
+		HPAOpenList open_list;
+
+		for (const int id : cluster_nodes(g_cluster))
+		{
+			goal_cost.at(id) = g_dist.at((nodes.at(id).y - gy0) * cluster_size + (nodes.at(id).x - gx0));
+		}
+		for (const int id : cluster_nodes(s_cluster))
+		{
+			const double g = s_dist.at((nodes.at(id).y - sy0) * cluster_size + (nodes.at(id).x - sx0));
+			if (g < gcost.at(id))
+			{
+				gcost.at(id) = g;
+				open_list.push(HPAEntry{g + heuristic(nodes.at(id).x, nodes.at(id).y, gx, gy), g, id});
+			}
+		}
+
+		double best = direct;
+		int last = -1;
+		while (!open_list.empty())
+		{
+			const HPAEntry current = open_list.top();
+			open_list.pop();
+			if (closed[current.id] or current.gcost > gcost[current.id])
+			{
+				continue;
+			}
+			// No remaining entry can improve on the best complete path
+			if (current.fcost >= best)
+			{
+				break;
+			}
+			closed[current.id] = true;
+			expansions++;
+
+			if (current.gcost + goal_cost[current.id] < best)
+			{
+				best = current.gcost + goal_cost[current.id];
+				last = current.id;
+			}
+
+			for (const auto & edge : nodes[current.id].edges)
+			{
+				const double g = current.gcost + edge.cost;
+				if (!closed[edge.to] and g < gcost[edge.to])
+				{
+					gcost[edge.to] = g;
+					parent[edge.to] = current.id;
+					const AbstractNode & next = nodes[edge.to];
+					open_list.push(HPAEntry{g + heuristic(next.x, next.y, gx, gy), g, edge.to});
+				}
+			}
+		}
+
+		std::vector<Node> path;
+		if (best == INF)
+		{
+			std::cout << "No valid path!" << std::endl;
+			return path;
+		}
+		cost = best;
+
+		// Step 3. Refine the abstract path into grid cells
+		std::vector<Index> cells;
+		cells.push_back(s_index);
+		if (last == -1)
+		{
+			refine(s_cluster, sx, sy, gx, gy, cells);
+		} else
+		{
+			std::vector<int> abstract_path;
+			for (int id = last; id != -1; id = parent[id])
+			{
+				abstract_path.push_back(id);
+			}
+			std::reverse(abstract_path.begin(), abstract_path.end());
+
+			refine(s_cluster, sx, sy, nodes.at(abstract_path.front()).x, nodes.at(abstract_path.front()).y, cells);
+			for (size_t i = 1; i < abstract_path.size(); i++)
+			{
+				const AbstractNode & from = nodes.at(abstract_path.at(i - 1));
+				const AbstractNode & to = nodes.at(abstract_path.at(i));
+				if (from.cluster != to.cluster)
+				{
+					// Across an entrance: adjacent cells
+					Index index;
+					index.x = to.x;
+					index.y = to.y;
+					cells.push_back(index);
+				} else
+				{
+					refine(from.cluster, from.x, from.y, to.x, to.y, cells);
+				}
+			}
+			refine(g_cluster, nodes.at(last).x, nodes.at(last).y, gx, gy, cells);
+		}
+
+		double g = 0.0;
+		for (size_t i = 0; i < cells.size(); i++)
+		{
+			const int x = cells.at(i).x;
+			const int y = cells.at(i).y;
+			if (i > 0)
+			{
+				const bool diagonal = x != cells.at(i - 1).x and y != cells.at(i - 1).y;
+				g += (diagonal ? SQRT_2 : 1.0) * resolution;
+			}
+
+			Node node;
+			node.cell = Cell(Vector2D(xcells.at(x), ycells.at(y)), resolution);
+			node.cell.celltype = static_cast<map::CellType>(types[map::grid2rowmajor(x, y, width)]);
+			node.cell.index.x = x;
+			node.cell.index.y = y;
+			node.cell.index.row_major = map::grid2rowmajor(x, y, width);
+			node.id = node.cell.index.row_major;
+			node.gcost = g;
+			node.hcost = heuristic(x, y, gx, gy);
+			node.fcost = node.gcost + node.hcost;
+			if (!path.empty())
+			{
+				node.parent_id = path.back().id;
+			}
+			path.push_back(node);
+		}
+
+		std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+		return path;
+	}
+
+	int HPAstar::update(const std::vector<Cell> & changes)
+	{
+		std::vector<bool> dirty_borders(borders.size(), false);
+		std::vector<bool> dirty_clusters(static_cast<size_t>(clusters_x) * clusters_y, false);
+
+		for (const auto & cell : changes)
+		{
+			const int x = cell.index.x;
+			const int y = cell.index.y;
+			if (!(x >= 0 and x < width and y >= 0 and y < height))
+			{
+				throw std::invalid_argument("cell coordinates out of bounds!\
+											 \n  where(): HPAstar::update(const std::vector<Cell> & changes)");
+			}
+
+			uint8_t & type = types[map::grid2rowmajor(x, y, width)];
+			if (type == static_cast<uint8_t>(cell.celltype))
+			{
+				continue;
+			}
+			type = static_cast<uint8_t>(cell.celltype);
+
+			const int cluster = cluster_of(x, y);
+			dirty_clusters.at(cluster) = true;
+
+			// Borders this cell lies on
+			const int cx = cluster % clusters_x;
+			const int cy = cluster / clusters_x;
+			if (x % cluster_size == 0 and cx > 0)
+			{
+				dirty_borders.at(cy * (clusters_x - 1) + cx - 1) = true;
+			}
+			if (x % cluster_size == cluster_size - 1 and cx < clusters_x - 1)
+			{
+				dirty_borders.at(cy * (clusters_x - 1) + cx) = true;
+			}
+			if (y % cluster_size == 0 and cy > 0)
+			{
+				dirty_borders.at(vertical_borders + (cy - 1) * clusters_x + cx) = true;
+			}
+			if (y % cluster_size == cluster_size - 1 and cy < clusters_y - 1)
+			{
+				dirty_borders.at(vertical_borders + cy * clusters_x + cx) = true;
+			}
+		}
+
+		// Rebuilt entrances invalidate the intra-cluster edges on both sides of the border
+		for (int b = 0; b < static_cast<int>(borders.size()); b++)
+		{
+			if (!dirty_borders[b])
+			{
+				continue;
+			}
+			build_border(b);
+			if (b < vertical_borders)
+			{
+				const int cluster = (b / (clusters_x - 1)) * clusters_x + b % (clusters_x - 1);
+				dirty_clusters.at(cluster) = true;
+				dirty_clusters.at(cluster + 1) = true;
+			} else
+			{
+				const int cluster = b - vertical_borders;
+				dirty_clusters.at(cluster) = true;
+				dirty_clusters.at(cluster + clusters_x) = true;
+			}
+		}
+
+		int repaired = 0;
+		for (int c = 0; c < static_cast<int>(dirty_clusters.size()); c++)
+		{
+			if (dirty_clusters[c])
+			{
+				build_cluster(c);
+				repaired++;
+			}
+		}
+		return repaired;
+	}
+
+	double HPAstar::return_cost() const
+	{
+		return cost;
+	}
+
+	int HPAstar::return_expansions() const
+	{
+		return expansions;
+	}
+
+	int HPAstar::return_abstract_nodes() const
+	{
+		return static_cast<int>(std::count_if(nodes.begin(), nodes.end(),
+											  [](const AbstractNode & node) { return node.alive; }));
+	}
+}
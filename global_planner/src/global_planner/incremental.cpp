@@ -3,12 +3,23 @@
 namespace global
 {
 	void LPAstar::ComputeShortestPath()
+	{
+		ComputeShortestPath(SearchBudget());
+	}
+
+
+	SearchStatus LPAstar::ComputeShortestPath(const SearchBudget & budget)
 	{
 		Node min;
-		int iterations= 0;
+		BudgetTracker tracker(budget);
 		while (Continue(iterations))
 		{
+			if (tracker.exhausted())
+			{
+				return SearchStatus::InProgress;
+			}
 			iterations++;
+			tracker.count();
 			// std::cout << "Iteration: " << iterations << std::endl;
 
 			// if (iterations > 200)
@@ -17,10 +28,7 @@ namespace global
 			// }
 
 			// Get min node and erase from open list
-			min = open_list.at(0);
-			std::pop_heap(open_list.begin(), open_list.end(), KeyComparator());
-			open_list.back();
-			open_list.pop_back();
+			min = open_pop();
 
 			// Check if Overconsistent (start always satisfies this)
 			if (min.gcost > min.rhs)
@@ -30,6 +38,11 @@ namespace global
 				min.gcost = min.rhs;
 				// Update min in FakeGrid
 				FakeGrid.at(min.id) = min;
+				// Remember the closest Node to the goal for partial paths
+				if (best_id == -1 or min.hcost < FakeGrid.at(best_id).hcost)
+				{
+					best_id = min.id;
+				}
 				// Check Successors
 				std::vector<Node> successors = get_neighbours(min, FakeGrid);
 				for (auto succ = successors.begin(); succ < successors.end(); succ++)
@@ -52,6 +65,13 @@ namespace global
 				}
 			}
 		}
+
+		iterations = 0;
+		if (goal_node.gcost >= BIG_NUM)
+		{
+			return SearchStatus::Failed;
+		}
+		return SearchStatus::Done;
 	}
 
 
@@ -69,7 +89,7 @@ namespace global
 	    		// Find the neighbour node
 	    		Node predecessor;
 	    		predecessor = *pred_iter;
-	    		predecessor.id = predecessor.cell.index.row_major;
+	    		predecessor.id = indexer.index(predecessor.cell.index.x, predecessor.cell.index.y);
 
 	    		// Skip Occupied or Inflated Cells
 	    		if (predecessor.cell.celltype == map::Occupied or\
@@ -98,22 +118,14 @@ namespace global
 	    	n.parent_id = min_predecessor.id;
 	    }
     	// If it's on the open list, remove it
-    	auto cell_iter = std::find_if(open_list.begin(), open_list.end(), [&](const Node & node) {return node.id == n.id;});
-    	if (cell_iter != open_list.end())
-    	{
-    		// Delete using points
-    		open_list.erase(cell_iter);
-    		// Re-sort open list
-    		std::push_heap(open_list.begin(), open_list.end(), KeyComparator());
-    	}
+    	open_remove(n);
 
     	// If n is locally inconsistent (ie if n.gcost != n.rhs), add it to the open list with updated keys
     	if (!(rigid2d::almost_equal(n.gcost, n.rhs)))
     	{
     		n.hcost = heuristic(n, goal_node);
     		CalculateKeys(n);
-    		open_list.push_back(n);
-    		std::push_heap(open_list.begin(), open_list.end(), KeyComparator());
+    		open_push(n);
     	}
 
     	// Update n in FakeGrid
@@ -123,21 +135,53 @@ namespace global
 
 	void LPAstar::Initialize(const Vector2D & start, const Vector2D & goal, const map::Grid & grid_, const double & resolution)
 	{
-		GRID = grid_.return_fake_grid();
+		// Nodes are stored in the Grid's layout, so neighbours are close in memory
+		const auto dims = grid_.return_grid_dimensions();
+		initialize_nodes(find_nearest_node(start, grid_, resolution), find_nearest_node(goal, grid_, resolution),
+						 grid_.return_fake_grid(), map::GridIndexer(dims.at(0), dims.at(1), grid_.return_layout()));
+	}
+
+
+	void LPAstar::Initialize(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot,
+							 const map::CellLayout & layout)
+	{
+		const auto dims = snapshot.return_grid_dimensions();
+		std::vector<Cell> fake_cells;
+		fake_cells.reserve(static_cast<size_t>(dims.at(0)) * dims.at(1));
+		for (int y = 0; y < dims.at(1); y++)
+		{
+			for (int x = 0; x < dims.at(0); x++)
+			{
+				fake_cells.push_back(snapshot.return_cell(x, y));
+			}
+		}
+
+		const double resolution = snapshot.return_resolution();
+		const Index s = snapshot.world2grid(Cell(start, resolution));
+		const Index g = snapshot.world2grid(Cell(goal, resolution));
+		initialize_nodes(fake_cells.at(s.row_major), fake_cells.at(g.row_major), fake_cells,
+						 map::GridIndexer(dims.at(0), dims.at(1), layout));
+	}
+
+
+	void LPAstar::initialize_nodes(const Cell & start_cell, const Cell & goal_cell, const std::vector<Cell> & fake_cells,
+								   const map::GridIndexer & indexer_)
+	{
+		indexer = indexer_;
 		FakeGrid.clear();
+		// Padding slots (ZOrder) are never neighbours of a grid cell
+		FakeGrid.resize(indexer.size());
 
-		// Find Start and Goal Nodes
-	    goal_node.cell = find_nearest_node(goal, grid_, resolution);
-	    goal_node.id = goal_node.cell.index.row_major;
+	    goal_node.cell = goal_cell;
+	    goal_node.id = indexer.index(goal_node.cell.index.x, goal_node.cell.index.y);
 	    // Make sure the algo thinks it's free to begin with
 	    goal_node.cell.celltype = map::Free;
 	    goal_node.hcost = 0.0;
 	    goal_node.gcost = BIG_NUM;
 	    CalculateKeys(goal_node);
 
-	    // Find GRID cell whose coordinates most closely match the start coordinates
-	    start_node.cell = find_nearest_node(start, grid_, resolution);
-	    start_node.id = start_node.cell.index.row_major;
+	    start_node.cell = start_cell;
+	    start_node.id = indexer.index(start_node.cell.index.x, start_node.cell.index.y);
 	    // Make sure the algo thinks it's free to begin with
 	    start_node.cell.celltype = map::Free;
 	    start_node.hcost = heuristic(start_node, goal_node);
@@ -148,11 +192,11 @@ namespace global
 	    // std::cout << "GOAL, IDX: [" << goal_node.cell.index.x << ", " << goal_node.cell.index.y << "]" << "ID: " << goal_node.id << std::endl;
 
 		// Populate Fake Grid
-		for (auto iter = GRID.begin(); iter < GRID.end(); iter++)
+		for (auto iter = fake_cells.begin(); iter < fake_cells.end(); iter++)
 		{
 			Node node;
 			node.cell = *iter;
-			node.id = node.cell.index.row_major;
+			node.id = indexer.index(node.cell.index.x, node.cell.index.y);
 			if (node.id == goal_node.id)
 			{
 				node = goal_node;
@@ -162,17 +206,21 @@ namespace global
 			}
 			node.gcost = BIG_NUM;
 			// TODO: When vanilla is done, clear all obstacle/inflated in FakeGrid for simulated increment
-			FakeGrid.push_back(node);
+			FakeGrid.at(node.id) = node;
 		}
 
 		// Populate Open List
-		open_list.push_back(start_node);
-		std::make_heap(open_list.begin(), open_list.end(), KeyComparator());
+		open_clear();
+		open_push(start_node);
 
 		// Cross-update FakeGrid with start and goal
 		FakeGrid.at(start_node.id) = start_node;
 		FakeGrid.at(goal_node.id) = goal_node;
 
+		// No search in progress
+		iterations = 0;
+		best_id = -1;
+
 		std::cout << "Initialized!" << std::endl;
 	}
 
@@ -213,12 +261,8 @@ namespace global
 
 	bool LPAstar::Continue(const int & iterations)
 	{
-		if(!std::is_heap(open_list.begin(), open_list.end(), KeyComparator()))
-		{
-			std::make_heap(open_list.begin(), open_list.end(), KeyComparator());
-		}
-
-		Node top = open_list.at(0);
+		Node top;
+		const bool queued_top = open_top(top);
 		CalculateKeys(top);
 		// Update Goal Node from Fake Grid
 		goal_node = FakeGrid.at(goal_node.id);
@@ -269,8 +313,8 @@ namespace global
 		// 	std::cout << "CONSISTENT" << std::endl;
 		// }
 
-		// Conditions for Continuing
-		if (not_minkey or (!consistent))
+		// Conditions for Continuing. An empty open list leaves nothing to expand.
+		if (queued_top and (not_minkey or (!consistent)))
 		{
 			return true;
 		} else
@@ -337,36 +381,24 @@ namespace global
 
 	std::vector<Node> LPAstar::get_neighbours(const Node & n, const std::vector<Node> & map)
 	{
-		int x_max = map.back().cell.index.x;
-		int y_max = map.back().cell.index.y; 
+		int x_max = indexer.return_width() - 1;
+		int y_max = indexer.return_height() - 1;
 		std::vector<Node> neighbours;
+		neighbours.reserve(map::OFFSETS_8.size());
 		// std::cout << "Node at [" << n.cell.index.x << ", " << n.cell.index.y << "]" << std::endl;
 
 		// Evaluate about 3x3 block for 8-connectivity
-		for (int x = -1; x < 2; x++)
+		for (const auto & offset : map::OFFSETS_8)
 		{
-			for (int y = -1; y < 2; y++)
-			{
-				// Skip x,y = (0,0) since that's the current node
-				if (x == 0 and y == 0)
-				{
-					continue;
-				} else
-				{
-					int check_x = n.cell.index.x + x;
-					int check_y = n.cell.index.y + y;
+			int check_x = n.cell.index.x + offset.dx;
+			int check_y = n.cell.index.y + offset.dy;
 
-					// Ensure potential neighbour is within grid bounds
-					if (check_x >= 0 and check_x <= x_max and check_y >= 0 and check_y <= y_max)
-					{
-						// Now we need to grab the right cell from the map. To do this: index->RMJ
-						// std::cout << "Neighbour at [" << check_x << ", " << check_y << "]" << std::endl;
-						int rmj = map::grid2rowmajor(check_x, check_y, x_max + 1);
-						Node nbr = map.at(rmj);
-						// std::cout << "Checked Neighbour at [" << nbr.cell.index.x << ", " << nbr.cell.index.y << "]" << std::endl;
-						neighbours.push_back(nbr);
-					}
-				}
+			// Ensure potential neighbour is within grid bounds
+			if (check_x >= 0 and check_x <= x_max and check_y >= 0 and check_y <= y_max)
+			{
+				// Now we need to grab the right cell from the map. To do this: index->storage index
+				// std::cout << "Neighbour at [" << check_x << ", " << check_y << "]" << std::endl;
+				neighbours.push_back(map[indexer.index(check_x, check_y)]);
 			}
 		}
 		return neighbours;
@@ -382,15 +414,30 @@ namespace global
 
 	std::vector<Node> LPAstar::SimulateUpdate(const std::vector<Cell> & updated_grid)
 	{
-		GRID = updated_grid;
+		std::vector<Node> updated_nodes = ApplyUpdate(updated_grid);
+		// Compute Shortest Path
+		ComputeShortestPath();
+		// Return updated nodes
+		return updated_nodes;
+	}
+
+
+	std::vector<Node> LPAstar::ApplyUpdate(const std::vector<Cell> & updated_grid)
+	{
+		// The next ComputeShortestPath starts afresh
+		iterations = 0;
+		best_id = -1;
+
 		std::vector<Node> updated_nodes;
-		for (unsigned int i = 0; i < updated_grid.size(); i++)
+		for (unsigned int j = 0; j < updated_grid.size(); j++)
 		{
+			// updated_grid is in row-major order, FakeGrid in the indexer's order
+			const int i = indexer.index(updated_grid.at(j).index.x, updated_grid.at(j).index.y);
 			// For each UPDATED Cell (cell.newView = true;), UpdateCell() on its neighbours
-			if (updated_grid.at(i).newView and FakeGrid.at(i).cell.celltype != updated_grid.at(i).celltype)
+			if (updated_grid.at(j).newView and FakeGrid.at(i).cell.celltype != updated_grid.at(j).celltype)
 			{
 				// First, update FakeGrid
-				FakeGrid.at(i).cell = updated_grid.at(i);
+				FakeGrid.at(i).cell = updated_grid.at(j);
 				// Push back culprit
 				updated_nodes.push_back(FakeGrid.at(i));
 
@@ -425,76 +472,149 @@ namespace global
 
 		// open_list = temp_open_list;
 
-		// Compute Shortest Path
-		ComputeShortestPath();
 		// Return updated nodes
 		return updated_nodes;
 	}
 
+
+	std::vector<Node> LPAstar::return_partial_path() const
+	{
+		if (best_id == -1)
+		{
+			return std::vector<Node>{start_node};
+		}
+
+		// Parents may still form a loop mid-search, so never walk more Nodes than exist
+		std::vector<Node> partial{FakeGrid.at(best_id)};
+		while (partial.back().parent_id >= 0 and partial.back().id != start_node.id and partial.size() < FakeGrid.size())
+		{
+			partial.push_back(FakeGrid.at(partial.back().parent_id));
+		}
+		std::reverse(partial.begin(), partial.end());
+		return partial;
+	}
+
 	bool LPAstar::return_valid()
 	{
 		return valid_path;
 	}
 
 
-	void DSL::Initialize(const Vector2D & start, const Vector2D & goal, const map::Grid & grid_, const double & resolution)
+	void LPAstar::set_radix_heap(const bool & radix_)
 	{
-		GRID = grid_.return_fake_grid();
-		FakeGrid.clear();
+		radix = radix_;
+		open_clear();
+	}
 
-		// NOTE: START AND GOAL POSITIONS FLIPPED FOR D*LITE
-		// Find Start and Goal Nodes
-	    goal_node.cell = find_nearest_node(start, grid_, resolution);
-	    goal_node.id = goal_node.cell.index.row_major;
-	    // Make sure the algo thinks it's free to begin with
-	    goal_node.cell.celltype = map::Free;
-	    goal_node.hcost = 0.0;
-	    goal_node.gcost = BIG_NUM;
-	    CalculateKeys(goal_node);
 
-	    // Find GRID cell whose coordinates most closely match the start coordinates
-	    start_node.cell = find_nearest_node(goal, grid_, resolution);
-	    // Make sure the algo thinks it's free to begin with
-	    start_node.cell.celltype = map::Free;
-	    start_node.id = start_node.cell.index.row_major;
-	    start_node.hcost = heuristic(start_node, goal_node);
-	    start_node.rhs = 0.0;
-	    start_node.gcost = BIG_NUM;
-	    CalculateKeys(start_node);
-	    // std::cout << "START, IDX: [" << start_node.cell.index.x << ", " << start_node.cell.index.y << "]"<< std::endl;
-	    // std::cout << "GOAL, IDX: [" << goal_node.cell.index.x << ", " << goal_node.cell.index.y << "]"<< std::endl;
+	void LPAstar::open_clear()
+	{
+		open_list.clear();
+		radix_list.clear();
+		queued.assign(FakeGrid.size(), 0);
+		version = 0;
+	}
 
-		// Populate Fake Grid
-		for (auto iter = GRID.begin(); iter < GRID.end(); iter++)
+
+	void LPAstar::open_push(const Node & n)
+	{
+		if (radix)
 		{
-			Node node;
-			node.cell = *iter;
-			node.id = node.cell.index.row_major;
-			if (node.id == goal_node.id)
+			// Any earlier entry for n goes stale
+			version++;
+			queued.at(n.id) = version;
+			radix_list.push(to_fixed_point(n.key1), OpenKey{n.key1, n.key2, n.id, version});
+		} else
+		{
+			open_list.push_back(n);
+			std::push_heap(open_list.begin(), open_list.end(), KeyComparator());
+		}
+	}
+
+
+	void LPAstar::open_remove(const Node & n)
+	{
+		if (radix)
+		{
+			// Lazy deletion: the entry is skipped when it reaches the top
+			queued.at(n.id) = 0;
+			return;
+		}
+
+		auto cell_iter = std::find_if(open_list.begin(), open_list.end(), [&](const Node & node) {return node.id == n.id;});
+		if (cell_iter != open_list.end())
+		{
+			// Delete using points
+			open_list.erase(cell_iter);
+			// Re-sort open list
+			std::make_heap(open_list.begin(), open_list.end(), KeyComparator());
+		}
+	}
+
+
+	bool LPAstar::open_top(Node & top)
+	{
+		if (radix)
+		{
+			while (!radix_list.empty())
 			{
-				node = goal_node;
-			} else if (node.id == start_node.id)
+				const OpenKey & entry = radix_list.top();
+				if (queued.at(entry.id) == entry.version)
+				{
+					top = FakeGrid.at(entry.id);
+					return true;
+				}
+				radix_list.pop();
+			}
+			return false;
+		}
+
+		if (open_list.empty())
+		{
+			return false;
+		}
+		top = open_list.at(0);
+		return true;
+	}
+
+
+	Node LPAstar::open_pop()
+	{
+		if (radix)
+		{
+			Node min;
+			if (!open_top(min))
 			{
-				node = start_node;
+				throw std::runtime_error("The open list is empty\n  where(): LPAstar::open_pop()");
 			}
-			node.gcost = BIG_NUM;
-			// TODO: When vanilla is done, clear all obstacle/inflated in FakeGrid for simulated increment
-			FakeGrid.push_back(node);
+			radix_list.pop();
+			queued.at(min.id) = 0;
+			return min;
 		}
 
-		// Populate Open List
-		open_list.push_back(start_node);
-		std::make_heap(open_list.begin(), open_list.end(), KeyComparator());
+		Node min = open_list.at(0);
+		std::pop_heap(open_list.begin(), open_list.end(), KeyComparator());
+		open_list.pop_back();
+		return min;
+	}
 
-		// Cross-update FakeGrid with start and goal
-		FakeGrid.at(start_node.id) = start_node;
-		FakeGrid.at(goal_node.id) = goal_node;
 
-		std::cout << "Initialized!" << std::endl;
+	void DSL::Initialize(const Vector2D & start, const Vector2D & goal, const map::Grid & grid_, const double & resolution)
+	{
+		// NOTE: START AND GOAL POSITIONS FLIPPED FOR D*LITE
+		LPAstar::Initialize(goal, start, grid_, resolution);
+	}
+
+
+	void DSL::Initialize(const Vector2D & start, const Vector2D & goal, const map::GridSnapshot & snapshot,
+						 const map::CellLayout & layout)
+	{
+		// NOTE: START AND GOAL POSITIONS FLIPPED FOR D*LITE
+		LPAstar::Initialize(goal, start, snapshot, layout);
 	}
 
 
-	std::vector<Node> DSL::SimulateUpdate(const std::vector<Cell> & updated_grid)
+	std::vector<Node> DSL::ApplyUpdate(const std::vector<Cell> & updated_grid)
 	{
 		// First, make sure g(goal [start in paper]!= inf, otherwise no path)
 		if (goal_node.gcost >= BIG_NUM)
@@ -512,7 +632,7 @@ namespace global
     		// Find the neighbour node
     		Node predecessor;
     		predecessor = *pred_iter;
-    		predecessor.id = predecessor.cell.index.row_major;
+    		predecessor.id = indexer.index(predecessor.cell.index.x, predecessor.cell.index.y);
 
     		// Occupied or Inflated Cells
     		if (predecessor.cell.celltype == map::Occupied or\
@@ -536,8 +656,7 @@ namespace global
 
     	//Update Goal Node (start in D*L paper)
     	goal_node = FakeGrid.at(min_predecessor.id);
-		GRID = updated_grid;
-		std::vector<Node> updated_nodes = LPAstar::SimulateUpdate(updated_grid);
+		std::vector<Node> updated_nodes = LPAstar::ApplyUpdate(updated_grid);
 
 		return updated_nodes;
 	}
@@ -0,0 +1,125 @@
+#include "global_planner/landmarks.hpp"
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace global
+{
+	Landmarks::Landmarks(const std::vector<int> & ids_, const int & nodes_, const bool & symmetric_)
+		: ids(ids_), count(static_cast<int>(ids_.size())), nodes(nodes_), symmetric(symmetric_)
+	{
+		table.assign(static_cast<size_t>(nodes) * count, INF);
+	}
+
+	const std::vector<int> & Landmarks::return_landmarks() const
+	{
+		return ids;
+	}
+
+	int Landmarks::return_nodes() const
+	{
+		return nodes;
+	}
+
+
+	std::vector<int> select_landmarks(const std::vector<rigid2d::Vector2D> & points, const std::vector<int> & ids, const int & count)
+	{
+		if (count < 1)
+		{
+			throw std::invalid_argument("At least one landmark is needed\n  where(): select_landmarks(const std::vector<rigid2d::Vector2D> & points, const std::vector<int> & ids, const int & count)");
+		}
+
+		std::vector<int> landmarks;
+		if (points.empty())
+		{
+			return landmarks;
+		}
+
+		rigid2d::Vector2D centre;
+		for (const auto & point : points)
+		{
+			centre.x += point.x;
+			centre.y += point.y;
+		}
+		centre.x /= points.size();
+		centre.y /= points.size();
+
+		// Farthest candidate from the centre in each sector
+		std::vector<int> farthest(count, -1);
+		std::vector<double> radius(count, -1.0);
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			const double dx = points.at(i).x - centre.x;
+			const double dy = points.at(i).y - centre.y;
+			const double angle = std::atan2(dy, dx) + M_PI;
+			const int sector = std::min(count - 1, static_cast<int>(angle / (2.0 * M_PI) * count));
+			const double r = dx * dx + dy * dy;
+			if (r > radius.at(sector))
+			{
+				radius.at(sector) = r;
+				farthest.at(sector) = ids.at(i);
+			}
+		}
+
+		for (const int id : farthest)
+		{
+			if (id != -1)
+			{
+				landmarks.push_back(id);
+			}
+		}
+		return landmarks;
+	}
+
+
+	Landmarks build_landmarks(const std::vector<Vertex> & prm, const int & count, const int & threads)
+	{
+		std::vector<rigid2d::Vector2D> points;
+		std::vector<int> ids;
+		for (const auto & vertex : prm)
+		{
+			points.push_back(vertex.coords);
+			ids.push_back(vertex.id);
+		}
+
+		Landmarks landmarks(select_landmarks(points, ids, count), static_cast<int>(prm.size()), true);
+		const std::vector<int> & chosen = landmarks.return_landmarks();
+
+		parallel_for(static_cast<int>(chosen.size()), threads, [&prm, &landmarks, &chosen](const int & l)
+		{
+			// Dijkstra from the landmark. Edges are used both ways, so this is also the distance to it.
+			std::vector<double> dist(prm.size(), std::numeric_limits<double>::infinity());
+			using Entry = std::pair<double, int>;
+			std::priority_queue <Entry, std::vector<Entry>, std::greater<Entry> > open_list;
+			dist.at(chosen.at(l)) = 0.0;
+			open_list.push(Entry(0.0, chosen.at(l)));
+			while (!open_list.empty())
+			{
+				const Entry current = open_list.top();
+				open_list.pop();
+				if (current.first > dist[current.second])
+				{
+					continue;
+				}
+				const Vertex & u = prm[current.second];
+				for (const auto & edge : u.edges)
+				{
+					const Vertex & v = prm[edge.next_id];
+					const double tentative = current.first + map::euclidean_distance(u.coords.x - v.coords.x, u.coords.y - v.coords.y);
+					if (tentative < dist[edge.next_id])
+					{
+						dist[edge.next_id] = tentative;
+						open_list.push(Entry(tentative, edge.next_id));
+					}
+				}
+			}
+
+			for (size_t node = 0; node < dist.size(); node++)
+			{
+				landmarks.set_distance(l, static_cast<int>(node), dist[node]);
+			}
+		});
+
+		return landmarks;
+	}
+}
@@ -0,0 +1,190 @@
+#include "global_planner/path_cache.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace global
+{
+	PathCache::PathCache(const int & capacity_)
+		: capacity(capacity_)
+	{
+		if (capacity < 1)
+		{
+			throw std::invalid_argument("PathCache needs room for at least one path\n  where(): PathCache::PathCache(const int & capacity_)");
+		}
+	}
+
+	std::shared_ptr<const PathCache::Path> PathCache::lookup(const PathKey & key, const uint64_t & epoch)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto found = index.find(key);
+		if (found == index.end() or found->second->epoch != epoch)
+		{
+			// An older entry was not carried over by invalidate(), so the map may have changed under it
+			if (found != index.end() and found->second->epoch < epoch)
+			{
+				erase(found->second);
+			}
+			misses++;
+			return nullptr;
+		}
+
+		// Move to the front of the LRU list
+		entries.splice(entries.begin(), entries, found->second);
+		hits++;
+		return entries.front().path;
+	}
+
+	void PathCache::insert(const PathKey & key, const uint64_t & epoch, const Path & path, const int & width)
+	{
+		Entry entry{key, epoch, std::make_shared<const Path>(path), path_cells(path, width)};
+
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto found = index.find(key);
+		if (found != index.end())
+		{
+			erase(found->second);
+		}
+		if (static_cast<int>(entries.size()) == capacity)
+		{
+			// Evict the least recently used path
+			erase(std::prev(entries.end()));
+		}
+		entries.push_front(std::move(entry));
+		index[key] = entries.begin();
+	}
+
+	int PathCache::invalidate(const std::vector<Cell> & changes, const uint64_t & epoch)
+	{
+		std::vector<int> changed;
+		for (const auto & cell : changes)
+		{
+			changed.push_back(cell.index.row_major);
+		}
+		std::sort(changed.begin(), changed.end());
+
+		std::lock_guard<std::mutex> lock(mutex);
+		int dropped = 0;
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			const auto current = it++;
+			if (current->epoch >= epoch)
+			{
+				continue;
+			}
+
+			bool crossed = current->epoch + 1 != epoch;
+			// Both lists are sorted, so walk them together
+			auto c = current->cells.begin();
+			auto u = changed.begin();
+			while (!crossed and c != current->cells.end() and u != changed.end())
+			{
+				if (*c == *u)
+				{
+					crossed = true;
+				} else if (*c < *u)
+				{
+					c++;
+				} else
+				{
+					u++;
+				}
+			}
+
+			if (crossed)
+			{
+				erase(current);
+				dropped++;
+			} else
+			{
+				current->epoch = epoch;
+			}
+		}
+		return dropped;
+	}
+
+	void PathCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		index.clear();
+	}
+
+	int PathCache::return_hits() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return hits;
+	}
+
+	int PathCache::return_misses() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return misses;
+	}
+
+	int PathCache::return_size() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return static_cast<int>(entries.size());
+	}
+
+	void PathCache::erase(const Entries::iterator & it)
+	{
+		index.erase(it->key);
+		entries.erase(it);
+	}
+
+
+	std::vector<int> path_cells(const std::vector<Node> & path, const int & width)
+	{
+		if (width < 1)
+		{
+			throw std::invalid_argument("Grid width must be positive\n  where(): path_cells(const std::vector<Node> & path, const int & width)");
+		}
+
+		std::vector<int> cells;
+		if (!path.empty())
+		{
+			cells.push_back(path.front().id);
+		}
+		for (size_t i = 1; i < path.size(); i++)
+		{
+			// Supercover walk from the previous Node: step across whichever cell border the segment meets first
+			int x = path.at(i - 1).id % width;
+			int y = path.at(i - 1).id / width;
+			const int ax = std::abs(path.at(i).id % width - x);
+			const int ay = std::abs(path.at(i).id / width - y);
+			const int sx = path.at(i).id % width > x ? 1 : -1;
+			const int sy = path.at(i).id / width > y ? 1 : -1;
+			int ix = 0;
+			int iy = 0;
+			while (ix < ax or iy < ay)
+			{
+				const long border = static_cast<long>(1 + 2 * ix) * ay - static_cast<long>(1 + 2 * iy) * ax;
+				if (border == 0)
+				{
+					// Through a corner: both cells beside it count
+					cells.push_back(map::grid2rowmajor(x + sx, y, width));
+					cells.push_back(map::grid2rowmajor(x, y + sy, width));
+					x += sx;
+					y += sy;
+					ix++;
+					iy++;
+				} else if (border < 0)
+				{
+					x += sx;
+					ix++;
+				} else
+				{
+					y += sy;
+					iy++;
+				}
+				cells.push_back(map::grid2rowmajor(x, y, width));
+			}
+		}
+
+		std::sort(cells.begin(), cells.end());
+		cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+		return cells;
+	}
+}
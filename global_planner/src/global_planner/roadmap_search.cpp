@@ -0,0 +1,187 @@
+#include "global_planner/roadmap_search.hpp"
+#include <algorithm>
+
+namespace global
+{
+	RoadmapSearch::RoadmapSearch(const std::vector<Vertex> & prm_)
+		: prm(prm_)
+	{
+		gcost.resize(prm.size());
+		parent.resize(prm.size());
+		opened.assign(prm.size(), 0);
+		closed.assign(prm.size(), 0);
+	}
+
+	std::vector<Node> RoadmapSearch::plan(const Vector2D & start, const Vector2D & goal)
+	{
+		begin(start, goal);
+		step(SearchBudget());
+		return best_path();
+	}
+
+	void RoadmapSearch::begin(const Vector2D & start, const Vector2D & goal)
+	{
+		// A new stamp invalidates all previous search state without clearing the arrays
+		stamp++;
+		expansions = 0;
+		cost = std::numeric_limits<double>::infinity();
+		status = SearchStatus::InProgress;
+
+		const int start_id = snapper ? snapper->snap(start) : find_nearest_node(start, prm).id;
+		goal_id = snapper ? snapper->snap(goal) : find_nearest_node(goal, prm).id;
+
+		open_list = OpenList();
+		gcost.at(start_id) = 0.0;
+		parent.at(start_id) = -1;
+		opened.at(start_id) = stamp;
+		const double h0 = estimate(start_id);
+		open_list.push(RoadmapEntry{h0, h0, 0.0, start_id});
+
+		// Fall back to the closest expanded vertex if the goal is never reached
+		best_id = start_id;
+		best_h = h0;
+	}
+
+	SearchStatus RoadmapSearch::step(const SearchBudget & budget)
+	{
+		if (status != SearchStatus::InProgress)
+		{
+			return status;
+		}
+
+		BudgetTracker tracker(budget);
+		while (!open_list.empty())
+		{
+			if (tracker.exhausted())
+			{
+				return status;
+			}
+
+			const RoadmapEntry current = open_list.top();
+			open_list.pop();
+
+			if (closed[current.id] == stamp or current.gcost > gcost[current.id])
+			{
+				continue;
+			}
+			closed[current.id] = stamp;
+			expansions++;
+			tracker.count();
+
+			if (current.hcost < best_h)
+			{
+				best_h = current.hcost;
+				best_id = current.id;
+			}
+
+			// END condition
+			if (current.id == goal_id)
+			{
+				if (verbose)
+				{
+					std::cout << "Goal found after " << expansions << " Iterations!" << std::endl;
+				}
+				cost = current.gcost;
+				status = SearchStatus::Done;
+				return status;
+			}
+
+			for (const auto & edge : prm[current.id].edges)
+			{
+				const int next = edge.next_id;
+				if (closed[next] == stamp)
+				{
+					continue;
+				}
+				const double tentative = current.gcost + distance(current.id, next);
+				if (opened[next] != stamp or tentative < gcost[next])
+				{
+					opened[next] = stamp;
+					gcost[next] = tentative;
+					parent[next] = current.id;
+					const double h = estimate(next);
+					open_list.push(RoadmapEntry{tentative + h, h, tentative, next});
+				}
+			}
+		}
+
+		// If we have reached this point, then there was no valid path
+		if (verbose)
+		{
+			std::cout << "No valid path! returning most complete path" << std::endl;
+		}
+		status = SearchStatus::Failed;
+		return status;
+	}
+
+	std::vector<Node> RoadmapSearch::best_path() const
+	{
+		std::vector<Node> path;
+		for (int id = status == SearchStatus::Done ? goal_id : best_id; id != -1; id = parent[id])
+		{
+			Node node;
+			node.vertex = prm.at(id);
+			node.id = id;
+			node.gcost = gcost[id];
+			node.hcost = estimate(id);
+			node.fcost = node.gcost + node.hcost;
+			if (!path.empty())
+			{
+				path.back().parent_id = id;
+			}
+			path.push_back(node);
+		}
+		std::reverse(path.begin(), path.end());
+
+		if (verbose)
+		{
+			std::cout << "The path contains " << path.size() << " Nodes." << std::endl;
+		}
+		return path;
+	}
+
+	SearchStatus RoadmapSearch::return_status() const
+	{
+		return status;
+	}
+
+	double RoadmapSearch::return_cost() const
+	{
+		return cost;
+	}
+
+	int RoadmapSearch::return_expansions() const
+	{
+		return expansions;
+	}
+
+	void RoadmapSearch::set_verbose(const bool & verbose_)
+	{
+		verbose = verbose_;
+	}
+
+	void RoadmapSearch::set_landmarks(const Landmarks * landmarks_)
+	{
+		landmarks = landmarks_;
+	}
+
+	void RoadmapSearch::set_snapper(const RoadmapSnapper * snapper_)
+	{
+		snapper = snapper_;
+	}
+
+	double RoadmapSearch::distance(const int & a, const int & b) const
+	{
+		return map::euclidean_distance(prm[a].coords.x - prm[b].coords.x, prm[a].coords.y - prm[b].coords.y);
+	}
+
+	double RoadmapSearch::estimate(const int & id) const
+	{
+		const double h = distance(id, goal_id);
+		if (landmarks)
+		{
+			return std::max(h, landmarks->lower_bound(id, goal_id));
+		}
+		return h;
+	}
+}
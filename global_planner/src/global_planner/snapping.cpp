@@ -0,0 +1,104 @@
+#include "global_planner/snapping.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace global
+{
+	RoadmapSnapper::RoadmapSnapper(const std::vector<Vertex> & prm_, const std::vector<Obstacle> & obstacles_,
+								   const double & inflate_robot_, const int & candidates_)
+		: prm(prm_), tree(prm_), obstacles(obstacles_), inflate_robot(inflate_robot_), candidates(candidates_)
+	{
+		if (candidates < 1)
+		{
+			throw std::invalid_argument("At least one candidate Vertex is needed\n  where(): RoadmapSnapper::RoadmapSnapper(const std::vector<Vertex> & prm_, const std::vector<Obstacle> & obstacles_, const double & inflate_robot_, const int & candidates_)");
+		}
+
+		for (const auto & obstacle : obstacles)
+		{
+			std::array<double, 4> box = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+										 -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+			for (const auto & v : obstacle.vertices)
+			{
+				box[0] = std::min(box[0], v.x - inflate_robot);
+				box[1] = std::min(box[1], v.y - inflate_robot);
+				box[2] = std::max(box[2], v.x + inflate_robot);
+				box[3] = std::max(box[3], v.y + inflate_robot);
+			}
+			bounds.push_back(box);
+		}
+	}
+
+	int RoadmapSnapper::snap(const Vector2D & position) const
+	{
+		const std::vector<int> nearest = tree.knn(position, candidates);
+		if (nearest.empty())
+		{
+			throw std::runtime_error("Cannot snap to an empty roadmap\n  where(): RoadmapSnapper::snap(const Vector2D & position) const");
+		}
+
+		// Batch the candidates: one box around all their segments selects the obstacles worth checking
+		double min_x = position.x;
+		double min_y = position.y;
+		double max_x = position.x;
+		double max_y = position.y;
+		for (const int id : nearest)
+		{
+			const Vector2D & coords = prm.at(id).coords;
+			min_x = std::min(min_x, coords.x);
+			min_y = std::min(min_y, coords.y);
+			max_x = std::max(max_x, coords.x);
+			max_y = std::max(max_y, coords.y);
+		}
+		std::vector<int> nearby;
+		for (size_t i = 0; i < bounds.size(); i++)
+		{
+			const auto & box = bounds.at(i);
+			if (box[0] <= max_x and box[2] >= min_x and box[1] <= max_y and box[3] >= min_y)
+			{
+				nearby.push_back(static_cast<int>(i));
+			}
+		}
+
+		const Vertex from(position);
+		for (const int id : nearest)
+		{
+			if (segment_free(from, prm.at(id), nearby))
+			{
+				return id;
+			}
+		}
+
+		// Nothing in line of sight: keep the old behaviour and attach to the closest Vertex
+		return nearest.front();
+	}
+
+	const map::KDTree & RoadmapSnapper::return_tree() const
+	{
+		return tree;
+	}
+
+	bool RoadmapSnapper::segment_free(const Vertex & from, const Vertex & to, const std::vector<int> & nearby) const
+	{
+		for (const int i : nearby)
+		{
+			const auto obs_iter = obstacles.begin() + i;
+
+			// Edge on Edge Check
+			if (!map::no_intersect(from, to, obs_iter))
+			{
+				return false;
+			}
+
+			// Edge Near Point Check
+			for (const auto & v : obs_iter->vertices)
+			{
+				if (map::too_close(from, to, Vertex(v), inflate_robot))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -4,6 +4,7 @@
 /// PARAMETERS:
 /// PUBLISHES:
 /// SUBSCRIBES:
+///     move_base_simple/goal (geometry_msgs/PoseStamped): new goal, planned for from the current cell
 /// FUNCTIONS:
 
 #include <ros/ros.h>
@@ -15,8 +16,10 @@
 #include "map/map.hpp"
 #include "map/prm.hpp"
 #include "map/grid.hpp"
+#include "map/snapshot.hpp"
 #include <nav_msgs/OccupancyGrid.h>
 #include "global_planner/incremental.hpp"
+#include "global_planner/executor.hpp"
 
 #include "nuslam/TurtleMap.h"
 
@@ -24,6 +27,7 @@
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
 
 // Used to deal with YAML list of lists
 #include <xmlrpcpp/XmlRpcValue.h> // catkin component
@@ -48,6 +52,16 @@ int main(int argc, char** argv)
     double thresh = 0.01;
     double inflate = 0.1;
     int visibility = 5;
+    // Directory for cached Grid/PRM artifacts (empty disables the cache)
+    std::string cache_dir = "";
+    // Cell storage order: rowmajor, zorder (cache-local neighbours on wide maps) or padded (sentinel border)
+    std::string cell_layout = "rowmajor";
+    // Replanning time per loop iteration in microseconds (0 replans to completion each update)
+    int step_budget_us = 0;
+    // Plan on a worker thread so the loop keeps its rate; new goals cancel stale plans
+    bool async_planning = false;
+    // Keep the open list in a radix heap over fixed-point keys instead of a binary heap
+    bool radix_heap = false;
 
     // store Obstacle(s) here to create Map
     std::vector<map::Obstacle> obstacles_v;
@@ -66,6 +80,11 @@ int main(int argc, char** argv)
     nh_.getParam("scale", SCALE);
     nh_.getParam("resolution", resolution);
     nh_.getParam("visibility", visibility);
+    nh_.getParam("cache_dir", cache_dir);
+    nh_.getParam("cell_layout", cell_layout);
+    nh_.getParam("step_budget_us", step_budget_us);
+    nh_.getParam("async_planning", async_planning);
+    nh_.getParam("radix_heap", radix_heap);
 
     rigid2d::Vector2D start(start_vec.at(0)/SCALE, start_vec.at(1)/SCALE);
     rigid2d::Vector2D goal(goal_vec.at(0)/SCALE, goal_vec.at(1)/SCALE);
@@ -203,7 +222,14 @@ int main(int argc, char** argv)
     map::Grid grid(obstacles_v, inflate);
 
     // Build Map
-    grid.build_map(resolution);
+    grid.build_map(resolution, cache_dir);
+    if (cell_layout == "zorder")
+    {
+      grid.set_layout(map::CellLayout::ZOrder);
+    } else if (cell_layout == "padded")
+    {
+      grid.set_layout(map::CellLayout::Padded);
+    }
 
     ROS_INFO("Grid Built!");
 
@@ -233,10 +259,18 @@ int main(int argc, char** argv)
 
     ROS_INFO("Planning using LPA*!");
     global::LPAstar lpastar(obstacles_v, inflate);
+    lpastar.set_radix_heap(radix_heap);
     lpastar.Initialize(start, goal, grid, resolution);
     lpastar.ComputeShortestPath();
     path = lpastar.return_path();
 
+    // Versions of the FAKE Grid: every update is committed, so planners can read a snapshot while it changes
+    map::VersionedGrid versions(grid, grid.return_fake_grid());
+    // Latest version applied to lpastar by a background plan. Only touched by jobs, which run on the worker
+    // one at a time, so an update dropped by submit() is picked up by the next job's diff
+    std::shared_ptr<const map::GridSnapshot> planned_on = versions.snapshot();
+    const map::CellLayout layout = grid.return_layout();
+
     ros::Rate rate(frequency);
 
     unsigned int path_counter = 0;
@@ -251,6 +285,27 @@ int main(int argc, char** argv)
     // Tells us if path contains obstacles
     bool valid_path = true;
 
+    // A budgeted replan is spread over loop iterations; the previous path is shown until it finishes
+    global::SearchBudget budget;
+    budget.time = std::chrono::microseconds(step_budget_us);
+    bool replanning = false;
+
+    // Runs plans in the background when async_planning is set. Declared after lpastar, so it stops first.
+    global::PlanningExecutor executor;
+    // Whether the robot waits for a background plan
+    bool waiting = false;
+    // ID of the latest background plan for a new goal
+    uint64_t goal_request = 0;
+
+    // New goals (eg: rviz 2D Nav Goal). Handled in the loop, as spinOnce runs this on the same thread.
+    bool new_goal = false;
+    ros::Subscriber goal_sub = nh.subscribe<geometry_msgs::PoseStamped>("move_base_simple/goal", 1,
+      [&goal, &new_goal](const geometry_msgs::PoseStamped::ConstPtr & msg)
+      {
+        goal = rigid2d::Vector2D(msg->pose.position.x, msg->pose.position.y);
+        new_goal = true;
+      });
+
     // Main While
     while (ros::ok())
     {
@@ -307,18 +362,105 @@ int main(int argc, char** argv)
         // Publish Path
         path_pub.publish(path_arr);
 
+        // Background plan finished
+        global::PlanResult result;
+        if (executor.poll(result))
+        {
+          path = result.path;
+          // Read on the worker: a newer request may already be using lpastar
+          valid_path = result.valid;
+          if (result.request == goal_request)
+          {
+            path_counter = 0;
+          }
+          waiting = false;
+        }
+
+        // New goal: plan from the current cell, with what has been seen of the map so far
+        if (new_goal)
+        {
+          new_goal = false;
+          replanning = false;
+          const rigid2d::Vector2D from = path.at(path_counter).cell.center_coords;
+          ROS_INFO("New goal: [%.2f, %.2f]", goal.x, goal.y);
+          if (async_planning)
+          {
+            // Cancels any replan in progress
+            goal_request = executor.submit([&lpastar, &versions, &planned_on, from, goal, layout](const global::CancelToken & token)
+            {
+              planned_on = versions.snapshot();
+              lpastar.Initialize(from, goal, *planned_on, layout);
+              global::step_until_cancelled([&lpastar](const global::SearchBudget & slice)
+              {
+                return lpastar.ComputeShortestPath(slice);
+              }, token);
+              global::PlanResult planned;
+              planned.path = lpastar.return_path();
+              planned.valid = lpastar.return_valid();
+              return planned;
+            });
+            waiting = true;
+          } else
+          {
+            lpastar.Initialize(from, goal, grid, resolution);
+            lpastar.ComputeShortestPath();
+            path = lpastar.return_path();
+            valid_path = lpastar.return_valid();
+            path_counter = 0;
+          }
+        }
+
         // FAKE Update
         updated_nodes.clear();
-        if (path_counter < path.size() - 1 and valid_path)
+        if (waiting)
         {
-          grid.update_grid(path.at(path_counter).cell, visibility);
+          // Keep publishing the current path until the background plan arrives
+        } else if (replanning)
+        {
+          // Resume the budgeted replan
+          if (lpastar.ComputeShortestPath(budget) != global::SearchStatus::InProgress)
+          {
+            replanning = false;
+            path = lpastar.return_path();
+            valid_path = lpastar.return_valid();
+          }
+        } else if (path_counter < path.size() - 1 and valid_path)
+        {
+          const std::vector<map::Cell> changed = grid.update_grid(path.at(path_counter).cell, visibility);
+          versions.commit(changed);
           path_counter++;
           // ROS_INFO("UPDATE NUMBER: %d", path_counter);
-          // LPA* Update
-          updated_nodes = lpastar.SimulateUpdate(grid.return_fake_grid());
-          path = lpastar.return_path();
-          // Stop condition in case of obstacles
-          valid_path = lpastar.return_valid();
+          if (async_planning)
+          {
+            // LPA* Update on the worker thread, which catches up from the version it last planned on
+            executor.submit([&lpastar, &versions, &planned_on](const global::CancelToken & token)
+            {
+              const std::shared_ptr<const map::GridSnapshot> latest = versions.snapshot();
+              lpastar.ApplyUpdate(latest->changes_since(*planned_on));
+              planned_on = latest;
+              global::step_until_cancelled([&lpastar](const global::SearchBudget & slice)
+              {
+                return lpastar.ComputeShortestPath(slice);
+              }, token);
+              global::PlanResult planned;
+              planned.path = lpastar.return_path();
+              planned.valid = lpastar.return_valid();
+              return planned;
+            });
+            waiting = true;
+          } else if (step_budget_us > 0)
+          {
+            // LPA* Update, searching for at most step_budget_us per loop iteration
+            updated_nodes = lpastar.ApplyUpdate(changed);
+            replanning = true;
+          } else
+          {
+            // LPA* Update
+            updated_nodes = lpastar.SimulateUpdate(changed);
+            path = lpastar.return_path();
+            // Stop condition in case of obstacles
+            valid_path = lpastar.return_valid();
+          }
         } else
         {
           // FINAL PATH. INFINITE MARKER DURATION
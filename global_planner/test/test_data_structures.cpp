@@ -0,0 +1,202 @@
+/// \file
+/// \brief Unit tests for the radix heap open list, the path cache and the versioned Grid it is keyed on.
+#include <gtest/gtest.h>
+
+#include "map/grid.hpp"
+#include "map/snapshot.hpp"
+#include "global_planner/path_cache.hpp"
+#include "global_planner/radix_heap.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // \brief a 3.4 x 4.8 m room without obstacles, at 5 cm per cell
+    map::Grid build_room()
+    {
+        const std::vector<std::pair<rigid2d::Vector2D, rigid2d::Vector2D>> walls = {
+            {{0.0, 0.0}, {3.4, 0.0}}, {{3.4, 0.0}, {3.4, 4.8}}, {{3.4, 4.8}, {0.0, 4.8}}, {{0.0, 4.8}, {0.0, 0.0}}};
+        std::vector<map::Obstacle> obstacles;
+        for (const auto & wall : walls)
+        {
+            map::Obstacle obs;
+            obs.vertices = {wall.first, wall.second};
+            obstacles.push_back(obs);
+        }
+        map::Grid grid(obstacles, 0.1);
+        grid.build_map(0.05);
+        return grid;
+    }
+
+    // \brief a straight path along row y from x0 to x1, with row-major Node IDs
+    std::vector<global::Node> row_path(const int & y, const int & x0, const int & x1, const int & width)
+    {
+        std::vector<global::Node> path;
+        for (int x = x0; x <= x1; x++)
+        {
+            global::Node node;
+            node.id = map::grid2rowmajor(x, y, width);
+            path.push_back(node);
+        }
+        return path;
+    }
+
+    // \brief the cell at x, y of grid with another type
+    map::Cell changed_cell(const map::Grid & grid, const int & x, const int & y, const map::CellType & type)
+    {
+        map::Cell cell = grid.return_cell(x, y);
+        cell.celltype = type;
+        return cell;
+    }
+}
+
+TEST(RadixHeapTest, PopsInKeyOrder)
+{
+    global::RadixHeap<int, std::greater<int>> heap;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint64_t> key(0, 1000000);
+
+    std::vector<uint64_t> keys;
+    for (int i = 0; i < 1000; i++)
+    {
+        keys.push_back(key(rng));
+        heap.push(keys.back(), i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    // Monotone use: pops interleaved with pushes no lower than the last popped key
+    std::vector<uint64_t> popped;
+    for (int i = 0; i < 500; i++)
+    {
+        popped.push_back(heap.top_key());
+        heap.pop();
+        const uint64_t pushed = popped.back() + key(rng) % 100;
+        keys.push_back(pushed);
+        heap.push(pushed, i);
+    }
+    while (!heap.empty())
+    {
+        popped.push_back(heap.top_key());
+        heap.pop();
+    }
+
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(popped, keys);
+    EXPECT_EQ(heap.return_rebases(), 0);
+}
+
+TEST(RadixHeapTest, RebasesBelowLastPopped)
+{
+    global::RadixHeap<int, std::greater<int>> heap;
+    heap.push(50, 0);
+    heap.push(70, 1);
+    EXPECT_EQ(heap.top_key(), 50u);
+    heap.pop();
+
+    // Keys lowered between replans: still popped in order, at the cost of one rebase
+    heap.push(10, 2);
+    heap.push(30, 3);
+    EXPECT_EQ(heap.return_rebases(), 1);
+    EXPECT_EQ(heap.top_key(), 10u);
+    heap.pop();
+    EXPECT_EQ(heap.top_key(), 30u);
+    heap.pop();
+    EXPECT_EQ(heap.top_key(), 70u);
+    heap.pop();
+    EXPECT_TRUE(heap.empty());
+}
+
+TEST(RadixHeapTest, BreaksTiesWithComparator)
+{
+    global::RadixHeap<int, std::greater<int>> heap;
+    for (const int value : {4, 1, 3, 0, 2})
+    {
+        heap.push(global::to_fixed_point(1.5), value);
+    }
+    for (int expected = 0; expected < 5; expected++)
+    {
+        EXPECT_EQ(heap.top(), expected);
+        heap.pop();
+    }
+}
+
+TEST(PathCacheTest, InvalidateDropsCrossedPaths)
+{
+    const map::Grid grid = build_room();
+    const int width = grid.return_grid_dimensions().at(0);
+    global::PathCache cache;
+
+    const global::PathKey across{map::grid2rowmajor(10, 20, width), map::grid2rowmajor(40, 20, width), 1};
+    const global::PathKey below{map::grid2rowmajor(10, 5, width), map::grid2rowmajor(40, 5, width), 1};
+    cache.insert(across, 0, row_path(20, 10, 40, width), width);
+    cache.insert(below, 0, row_path(5, 10, 40, width), width);
+    ASSERT_EQ(cache.return_size(), 2);
+
+    // A change away from both paths carries them over to the new epoch
+    EXPECT_EQ(cache.invalidate({changed_cell(grid, 60, 80, map::Occupied)}, 1), 0);
+    EXPECT_TRUE(cache.lookup(across, 1));
+    EXPECT_TRUE(cache.lookup(below, 1));
+
+    // A change on one path only drops that one
+    EXPECT_EQ(cache.invalidate({changed_cell(grid, 25, 20, map::Occupied)}, 2), 1);
+    EXPECT_FALSE(cache.lookup(across, 2));
+    EXPECT_TRUE(cache.lookup(below, 2));
+
+    // Other settings never match
+    EXPECT_FALSE(cache.lookup(global::PathKey{below.start, below.goal, 2}, 2));
+}
+
+TEST(PathCacheTest, InvalidateDropsPathsThatMissedACommit)
+{
+    const map::Grid grid = build_room();
+    const int width = grid.return_grid_dimensions().at(0);
+    global::PathCache cache;
+
+    const global::PathKey key{map::grid2rowmajor(10, 5, width), map::grid2rowmajor(40, 5, width), 1};
+    cache.insert(key, 0, row_path(5, 10, 40, width), width);
+
+    // Epoch 1 was never reported, so its changes may cross the path
+    EXPECT_EQ(cache.invalidate({changed_cell(grid, 60, 80, map::Occupied)}, 2), 1);
+    EXPECT_FALSE(cache.lookup(key, 2));
+    EXPECT_EQ(cache.return_size(), 0);
+}
+
+TEST(VersionedGridTest, CommitSharesUntouchedTiles)
+{
+    const map::Grid grid = build_room();
+    map::VersionedGrid versions(grid);
+
+    const std::shared_ptr<const map::GridSnapshot> first = versions.snapshot();
+    EXPECT_EQ(first->return_epoch(), 0u);
+    const std::vector<int> dims = grid.return_grid_dimensions();
+    const int tiles = first->shared_tiles(*first);
+    ASSERT_EQ(tiles, ((dims.at(0) + map::SNAPSHOT_TILE_SIZE - 1) / map::SNAPSHOT_TILE_SIZE) *
+                     ((dims.at(1) + map::SNAPSHOT_TILE_SIZE - 1) / map::SNAPSHOT_TILE_SIZE));
+
+    // Two cells in the same tile copy only that tile
+    const std::vector<map::Cell> changes = {changed_cell(grid, 20, 20, map::Occupied),
+                                            changed_cell(grid, 21, 20, map::Occupied)};
+    EXPECT_EQ(versions.commit(changes), 1u);
+    const std::shared_ptr<const map::GridSnapshot> second = versions.snapshot();
+    EXPECT_EQ(second->shared_tiles(*first), tiles - 1);
+    EXPECT_EQ(second->celltype(20, 20), map::Occupied);
+    EXPECT_EQ(second->changes_since(*first).size(), 2u);
+
+    // Readers of the first snapshot still see the old types
+    EXPECT_EQ(first->celltype(20, 20), grid.celltype(20, 20));
+
+    // A commit that changes nothing publishes nothing
+    EXPECT_EQ(versions.commit(changes), 1u);
+    EXPECT_EQ(versions.snapshot(), second);
+
+    // A cell in another tile copies that tile, and keeps sharing the first copy
+    EXPECT_EQ(versions.commit({changed_cell(grid, 50, 70, map::Occupied)}), 2u);
+    const std::shared_ptr<const map::GridSnapshot> third = versions.snapshot();
+    EXPECT_EQ(third->shared_tiles(*second), tiles - 1);
+    EXPECT_EQ(third->shared_tiles(*first), tiles - 2);
+    EXPECT_EQ(third->changes_since(*first).size(), 3u);
+}
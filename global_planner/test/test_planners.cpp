@@ -0,0 +1,311 @@
+/// \file
+/// \brief Checks that every grid planner finds paths as short as the 8-connected octile GridSearch (or within
+/// its bound for the suboptimal ones) on a few fixed maps, and that the contraction hierarchy matches A* on a PRM.
+#include <gtest/gtest.h>
+
+#include "map/grid.hpp"
+#include "map/prm.hpp"
+#include "global_planner/grid_search.hpp"
+#include "global_planner/hpa.hpp"
+#include "global_planner/bidirectional.hpp"
+#include "global_planner/arastar.hpp"
+#include "global_planner/hda.hpp"
+#include "global_planner/any_angle.hpp"
+#include "global_planner/contraction.hpp"
+#include "global_planner/roadmap_search.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rigid2d::Vector2D;
+
+namespace
+{
+    constexpr double INFLATE = 0.1;
+    constexpr double RESOLUTION = 0.05;
+    constexpr double TOLERANCE = 1e-6;
+
+    using Query = std::pair<Vector2D, Vector2D>;
+
+    // \brief a fixed map and start/goal pairs in its free space
+    struct TestMap
+    {
+        std::string name;
+        std::vector<map::Obstacle> obstacles;
+        std::vector<Query> queries;
+    };
+
+    // \brief builds obstacles from vertex lists in cells (10 cm each), like map/config/map.yaml
+    std::vector<map::Obstacle> make_obstacles(const std::vector<std::vector<std::pair<double, double>>> & raw)
+    {
+        std::vector<map::Obstacle> obstacles;
+        for (const auto & vertices : raw)
+        {
+            map::Obstacle obs;
+            for (const auto & v : vertices)
+            {
+                obs.vertices.push_back(Vector2D(v.first / 10.0, v.second / 10.0));
+            }
+            obstacles.push_back(obs);
+        }
+        return obstacles;
+    }
+
+    // \brief the map used by the nodes (map/config/map.yaml), a room with staggered walls, and an empty room
+    std::vector<TestMap> test_maps()
+    {
+        const std::vector<std::vector<std::pair<double, double>>> outer_wall = {
+            {{0., 0.}, {34., 0.}}, {{34., 0.}, {34., 48.}}, {{34., 48.}, {0., 48.}}, {{0., 48.}, {0., 0.}}};
+
+        std::vector<std::vector<std::pair<double, double>>> config = {
+            {{12., 6.}, {14.5, 3.5}, {17., 5.5}, {17., 8.5}, {14., 8.}},
+            {{24., 6.}, {26., 3.5}, {31., 7.5}, {24.5, 9.5}},
+            {{34., 26.}, {10., 26.}, {10., 12.}, {34., 12.}},
+            {{0., 26.}, {0., 6.}, {4., 6.}, {4., 26.}},
+            {{4., 32.}, {6., 30.}, {8., 32.}},
+            {{17., 32.}, {18., 30.}, {19., 32.}},
+            {{0., 36.}, {0., 32.}, {29., 32.}, {29., 36.}},
+            {{34., 36.}, {33., 34.}, {34., 32.}},
+            {{6., 44.}, {2., 43.}, {2., 39.}, {6., 38.}, {8., 41.}},
+            {{11., 48.}, {17., 41.}, {14., 48.}},
+            {{30., 48.}, {22., 40.}, {32., 48.}}};
+        config.insert(config.end(), outer_wall.begin(), outer_wall.end());
+
+        std::vector<std::vector<std::pair<double, double>>> walls = {
+            {{0., 14.}, {26., 14.}, {26., 16.}, {0., 16.}},
+            {{8., 30.}, {34., 30.}, {34., 32.}, {8., 32.}}};
+        walls.insert(walls.end(), outer_wall.begin(), outer_wall.end());
+
+        return {
+            {"config", make_obstacles(config),
+             {{Vector2D(0.5, 0.75), Vector2D(3.15, 3.6)}, {Vector2D(1.0, 4.0), Vector2D(3.0, 0.3)},
+              {Vector2D(0.7, 2.8), Vector2D(2.2, 2.9)}}},
+            {"walls", make_obstacles(walls),
+             {{Vector2D(0.5, 0.5), Vector2D(0.5, 4.3)}, {Vector2D(3.0, 0.6), Vector2D(0.6, 2.3)}}},
+            {"empty", make_obstacles(outer_wall),
+             {{Vector2D(0.3, 0.3), Vector2D(3.1, 4.5)}, {Vector2D(2.9, 0.4), Vector2D(0.4, 2.6)}}}};
+    }
+
+    // \brief builds the Grid of a test map
+    map::Grid build_grid(const TestMap & test_map)
+    {
+        map::Grid grid(test_map.obstacles, INFLATE);
+        grid.build_map(RESOLUTION);
+        return grid;
+    }
+
+    // \returns the cost of the 8-connected octile GridSearch, which the other planners are checked against
+    double octile_cost(const map::Grid & grid, const Query & query)
+    {
+        global::GridSearch<map::Grid> search(grid);
+        search.set_verbose(false);
+        search.plan(query.first, query.second);
+        return search.return_cost();
+    }
+
+    // \brief keeps the planners that print progress quiet while a test runs
+    class Silence
+    {
+    public:
+        Silence() : saved(std::cout.rdbuf(nullptr)) {}
+        ~Silence()
+        {
+            std::cout.rdbuf(saved);
+        }
+
+    private:
+        std::streambuf * saved;
+    };
+}
+
+TEST(GridSearchTest, PoliciesMatchOctile)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        for (const Query & query : test_map.queries)
+        {
+            SCOPED_TRACE(test_map.name);
+            const double optimal = octile_cost(grid, query);
+            ASSERT_TRUE(std::isfinite(optimal));
+
+            // Same policies through the radix heap cost the same
+            global::GridSearch<map::Grid, global::Connect8, global::OctileCost, global::RadixOpenList> radix(grid);
+            radix.set_verbose(false);
+            radix.plan(query.first, query.second);
+            EXPECT_NEAR(radix.return_cost(), optimal, TOLERANCE);
+
+            // Weighted costs also open Inflation cells: cheaper at weight 1, dearer as the weight grows
+            global::GridSearch<map::Grid, global::Connect8, global::WeightedCost<1>> unit(grid);
+            global::GridSearch<map::Grid, global::Connect8, global::WeightedCost<4>> weighted(grid);
+            unit.set_verbose(false);
+            weighted.set_verbose(false);
+            unit.plan(query.first, query.second);
+            weighted.plan(query.first, query.second);
+            EXPECT_LE(unit.return_cost(), optimal + TOLERANCE);
+            EXPECT_LE(weighted.return_cost(), optimal + TOLERANCE);
+            EXPECT_GE(weighted.return_cost(), unit.return_cost() - TOLERANCE);
+
+            // Fewer moves can only lengthen paths, more moves can only shorten them
+            global::GridSearch<map::Grid, global::Connect4, global::OctileCost> four(grid);
+            global::GridSearch<map::Grid, global::Connect16, global::OctileCost> sixteen(grid);
+            four.set_verbose(false);
+            sixteen.set_verbose(false);
+            four.plan(query.first, query.second);
+            sixteen.plan(query.first, query.second);
+            EXPECT_GE(four.return_cost(), optimal - TOLERANCE);
+            EXPECT_LE(sixteen.return_cost(), optimal + TOLERANCE);
+        }
+    }
+}
+
+TEST(GridSearchTest, PaddedLayoutMatchesRowMajor)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        map::Grid padded = build_grid(test_map);
+        padded.set_layout(map::CellLayout::Padded);
+        for (const Query & query : test_map.queries)
+        {
+            SCOPED_TRACE(test_map.name);
+            EXPECT_NEAR(octile_cost(padded, query), octile_cost(grid, query), TOLERANCE);
+        }
+    }
+}
+
+TEST(HPAstarTest, WithinBoundOfOctile)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        global::HPAstar hpa(grid, 16);
+        for (const Query & query : test_map.queries)
+        {
+            SCOPED_TRACE(test_map.name);
+            const double optimal = octile_cost(grid, query);
+            Silence silence;
+            hpa.plan(query.first, query.second);
+            // HPA* only crosses clusters at their entrances: usually within a few percent of optimal, more on
+            // short paths detouring to an entrance
+            EXPECT_GE(hpa.return_cost(), optimal - TOLERANCE);
+            EXPECT_LE(hpa.return_cost(), 1.25 * optimal);
+        }
+    }
+}
+
+TEST(BidirectionalAstarTest, MatchesOctile)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        global::BidirectionalAstar bidirectional(test_map.obstacles, INFLATE);
+        for (const Query & query : test_map.queries)
+        {
+            SCOPED_TRACE(test_map.name);
+            const double optimal = octile_cost(grid, query);
+            Silence silence;
+            bidirectional.plan(query.first, query.second, grid, RESOLUTION);
+            EXPECT_NEAR(bidirectional.return_cost(), optimal, TOLERANCE);
+        }
+    }
+}
+
+TEST(ARAstarTest, ReachesOctileWithinBudget)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        global::ARAstar<map::Grid> ara(grid);
+        for (const Query & query : test_map.queries)
+        {
+            SCOPED_TRACE(test_map.name);
+            const double optimal = octile_cost(grid, query);
+            Silence silence;
+            ara.plan(query.first, query.second, std::chrono::seconds(10));
+            EXPECT_NEAR(ara.return_bound(), 1.0, TOLERANCE);
+            EXPECT_NEAR(ara.return_cost(), optimal, TOLERANCE);
+        }
+    }
+}
+
+TEST(ParallelGridSearchTest, MatchesOctile)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        for (const int threads : {1, 4})
+        {
+            global::ParallelGridSearch<map::Grid> hda(grid, threads);
+            hda.set_verbose(false);
+            for (const Query & query : test_map.queries)
+            {
+                SCOPED_TRACE(test_map.name + ", threads: " + std::to_string(threads));
+                const double optimal = octile_cost(grid, query);
+                hda.plan(query.first, query.second);
+                EXPECT_NEAR(hda.return_cost(), optimal, TOLERANCE);
+            }
+        }
+    }
+}
+
+TEST(AnyAngleSearchTest, NoLongerThanOctile)
+{
+    for (const TestMap & test_map : test_maps())
+    {
+        map::Grid grid = build_grid(test_map);
+        for (const bool lazy : {false, true})
+        {
+            global::AnyAngleSearch<map::Grid> any_angle(grid, lazy);
+            any_angle.set_verbose(false);
+            for (const Query & query : test_map.queries)
+            {
+                SCOPED_TRACE(test_map.name + (lazy ? ", Lazy Theta*" : ", Theta*"));
+                const double optimal = octile_cost(grid, query);
+                const std::vector<global::Node> path = any_angle.plan(query.first, query.second);
+                ASSERT_FALSE(path.empty());
+                const Vector2D from = path.front().cell.center_coords;
+                const Vector2D to = path.back().cell.center_coords;
+                // Between the straight line and the 8-connected path
+                EXPECT_LE(any_angle.return_cost(), optimal + TOLERANCE);
+                EXPECT_GE(any_angle.return_cost(), map::euclidean_distance(to.x - from.x, to.y - from.y) - TOLERANCE);
+            }
+        }
+    }
+}
+
+TEST(ContractionHierarchyTest, MatchesRoadmapAstar)
+{
+    // Roadmap paths are not grid paths, so the hierarchy is checked against A* on the same PRM
+    for (const TestMap & test_map : test_maps())
+    {
+        map::PRM prm(test_map.obstacles, INFLATE);
+        int k = 10;
+        prm.build_map(500, k, 0.05);
+        const std::vector<map::Vertex> & roadmap = prm.return_prm();
+
+        global::ContractionHierarchy hierarchy(roadmap);
+        global::RoadmapSearch search(roadmap);
+        search.set_verbose(false);
+        for (const Query & query : test_map.queries)
+        {
+            SCOPED_TRACE(test_map.name);
+            const int s = global::find_nearest_node(query.first, roadmap).id;
+            const int g = global::find_nearest_node(query.second, roadmap).id;
+            Silence silence;
+            search.plan(query.first, query.second);
+            const double cost = hierarchy.query(s, g);
+            if (std::isinf(search.return_cost()))
+            {
+                EXPECT_TRUE(std::isinf(cost));
+            } else
+            {
+                EXPECT_NEAR(cost, search.return_cost(), TOLERANCE);
+            }
+        }
+    }
+}
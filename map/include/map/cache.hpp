@@ -0,0 +1,140 @@
+#ifndef CACHE_INCLUDE_GUARD_HPP
+#define CACHE_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Versioned binary on-disk cache for built Grid and PRM artifacts, loaded through mmap.
+#include <map/map.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace map
+{
+    // Bump whenever the on-disk layout of any artifact changes
+    constexpr uint32_t CACHE_VERSION = 2;
+
+    // \brief kinds of artifacts stored in the cache
+    enum CacheKind : uint32_t {GridArtifact = 1, PRMArtifact = 2};
+
+    // \brief Header at the start of every cache file
+    struct CacheHeader
+    {
+        char magic[4] = {'M', 'P', 'C', 'A'};
+        uint32_t version = CACHE_VERSION;
+        uint32_t kind = 0;
+        uint32_t reserved = 0;
+        // Content hash of obstacles and build parameters
+        uint64_t key = 0;
+        // Number of bytes following the header
+        uint64_t payload_size = 0;
+    };
+
+    // \brief 64-bit FNV-1a hash used to key cached artifacts on obstacles and build parameters
+    class ContentHash
+    {
+    public:
+        // \brief hashes raw bytes
+        void add(const void * data, const size_t & size);
+
+        // \brief hashes a trivially copyable value (int, double...)
+        template<typename T>
+        void add(const T & value)
+        {
+            add(&value, sizeof(T));
+        }
+
+        // \brief hashes every Obstacle vertex in order
+        void add(const std::vector<Obstacle> & obstacles);
+
+        // \returns the hash value
+        uint64_t value() const;
+
+    private:
+        uint64_t hash = 14695981039346656037ULL;
+    };
+
+    // \brief Read-only memory-mapped file. Unmapped on destruction.
+    class MappedFile
+    {
+    public:
+        // \brief maps the whole file. Check is_open() for success.
+        // \param path: the file to map
+        explicit MappedFile(const std::string & path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+
+        // \returns whether the file was mapped
+        bool is_open() const;
+
+        // \returns pointer to the first mapped byte
+        const uint8_t * data() const;
+
+        // \returns number of mapped bytes
+        size_t size() const;
+
+    private:
+        const uint8_t * mapped = nullptr;
+        size_t length = 0;
+    };
+
+    // \brief Sequential, bounds-checked reader over a mapped cache payload
+    class CacheReader
+    {
+    public:
+        // \param data_: first byte of the payload
+        // \param size_: number of bytes in the payload
+        CacheReader(const uint8_t * data_, const size_t & size_);
+
+        // \brief copies the next value out of the payload (no alignment requirement)
+        // \returns false if the payload is exhausted
+        template<typename T>
+        bool read(T & value)
+        {
+            return read(&value, sizeof(T));
+        }
+
+        // \brief copies the next size bytes out of the payload
+        // \returns false if the payload is exhausted
+        bool read(void * out, const size_t & size);
+
+    private:
+        const uint8_t * data;
+        size_t size;
+        size_t offset = 0;
+    };
+
+    // \brief Appends values to a payload buffer
+    template<typename T>
+    void cache_write(std::vector<uint8_t> & payload, const T & value)
+    {
+        const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&value);
+        payload.insert(payload.end(), bytes, bytes + sizeof(T));
+    }
+
+    // \brief builds the cache file name for an artifact
+    // \param dir: cache directory
+    // \param kind: the artifact kind
+    // \param key: content hash of the artifact
+    // \returns dir/<kind>_<key>.bin
+    std::string cache_filename(const std::string & dir, const CacheKind & kind, const uint64_t & key);
+
+    // \brief maps a cache file and validates its header
+    // \param file: the mapped file
+    // \param kind: the expected artifact kind
+    // \param key: the expected content hash
+    // \param reader: set to read the payload if the header matches
+    // \returns whether the file holds a valid artifact of this kind, version and key
+    bool open_cache(const MappedFile & file, const CacheKind & kind, const uint64_t & key, CacheReader & reader);
+
+    // \brief atomically writes a header and payload to disk (write to temporary file, then rename)
+    // \param path: the destination file
+    // \param kind: the artifact kind
+    // \param key: content hash of the artifact
+    // \param payload: artifact bytes
+    // \returns whether the file was written
+    bool write_cache(const std::string & path, const CacheKind & kind, const uint64_t & key, const std::vector<uint8_t> & payload);
+}
+
+#endif
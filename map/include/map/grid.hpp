@@ -4,6 +4,8 @@
 /// \brief GRID Library to build a Probabilistic Roadmap.
 #include <map/map.hpp>
 #include <map/prm.hpp> // to use PRM::too_close method
+#include <map/layout.hpp>
+#include <string>
 
 namespace map
 {
@@ -54,6 +56,13 @@ namespace map
         // \param resolution: determines the grid cell size
         void build_map(const double & resolution);
 
+        // \brief Loads the Grid Map from cache_dir if an artifact with the same obstacles and parameters exists.
+        // Otherwise builds the Grid Map and stores it in cache_dir. An empty cache_dir disables the cache.
+        // \param resolution: determines the grid cell size
+        // \param cache_dir: directory holding cached artifacts
+        // \returns whether the Grid Map was loaded from cache
+        bool build_map(const double & resolution, const std::string & cache_dir);
+
         // \brief converts world coordinates to grid coordinates and returns result
         // \param cell: a grid cell
         // \returns the grid cell's world coordinates
@@ -67,8 +76,43 @@ namespace map
         Vector2D grid2world(const int & i, const int & j, const double & resolution) const;
 
         // \brief Return Grid in row-major order
-        // \returns vector containing grid cells as Cell
-        std::vector<Cell> return_grid() const;
+        // \returns const reference to vector containing grid cells as Cell
+        const std::vector<Cell> & return_grid() const;
+
+        // \brief returns the type of a cell. Reads the compact cell type array, stored in the Grid's CellLayout.
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        CellType celltype(const int & x, const int & y) const
+        {
+            return static_cast<CellType>(types[indexer.index(x, y)]);
+        }
+
+        // \brief sets the storage order of the compact cell type array read by celltype().
+        // Cells returned by return_grid() stay in row-major order.
+        // \param layout_: the storage order
+        void set_layout(const CellLayout & layout_);
+
+        // \returns the storage order of the compact cell type array
+        CellLayout return_layout() const;
+
+        // \returns the compact cell type array, ordered by return_indexer(). With CellLayout::Padded,
+        // the border holds Occupied sentinels.
+        const std::vector<uint8_t> & return_celltypes() const;
+
+        // \returns the indexer mapping grid coordinates into return_celltypes()
+        const GridIndexer & return_indexer() const;
+
+        // \brief returns the Cell at a grid coordinate
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        const Cell & return_cell(const int & x, const int & y) const;
+
+        // \brief sets the type of a cell in the Grid and its compact cell type array. The FAKE Grid is unchanged.
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \param type: the new cell type
+        // \returns the updated Cell, to pass on to planners (eg: HPAstar::update)
+        const Cell & set_celltype(const int & x, const int & y, const CellType & type);
 
         // \brief populates Occupancy Grid with values for visualization
         // \param map: the Occupancy Grid map to populate
@@ -87,11 +131,12 @@ namespace map
         // \brief Increment fake copy of grid for simulated updates
         // \param current_cell: the cell from which we simulate the update
         // \param visibility: size of bounding box used for update (can vary each iteration if desired)
-        void update_grid(const Cell & cc, const int & visibility);
+        // \returns the cells whose type changed, to commit to a VersionedGrid
+        std::vector<Cell> update_grid(const Cell & cc, const int & visibility);
 
         // \brief Return FAKE (simulated increment) Grid in row-major order
-        // \returns vector containing grid cells as Cell
-        std::vector<Cell> return_fake_grid() const;
+        // \returns const reference to vector containing grid cells as Cell
+        const std::vector<Cell> & return_fake_grid() const;
 
         // \brief populates Occupancy Grid with FAKE values for visualization
         // \param map: the Occupancy Grid map to populate
@@ -109,7 +154,17 @@ namespace map
         friend bool too_close(const Vertex & E1, const Vertex & E2, const Vertex & P0, const double & inflate_robot);
 
     private:
+        // \brief assigns grid indeces to cells and creates fake_grid. Used after cells are labelled.
+        void index_cells();
+
+        // \brief copies cell types into the compact array in the current layout
+        void pack_types();
+
         std::vector<Cell> cells;
+        // Cell types in layout order, for cache-friendly neighbour checks
+        std::vector<uint8_t> types;
+        CellLayout layout = CellLayout::RowMajor;
+        GridIndexer indexer;
         std::vector<Cell> fake_grid;
         std::vector<double> xcells;
         std::vector<double> ycells;
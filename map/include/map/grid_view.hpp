@@ -0,0 +1,107 @@
+#ifndef GRID_VIEW_INCLUDE_GUARD_HPP
+#define GRID_VIEW_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Shared-memory Grid snapshots: a server that publishes an immutable Grid into POSIX shared memory,
+/// and a read-only view that planners attach to without copying the cells.
+#include <map/grid.hpp>
+#include <cstdint>
+#include <string>
+
+namespace map
+{
+    using rigid2d::Vector2D;
+
+    // Bump whenever the shared memory layout changes
+    constexpr uint32_t SHARED_GRID_VERSION = 1;
+
+    // \brief Header at the start of the shared memory object.
+    // Followed by xcells (width doubles), ycells (height doubles) and one CellType byte per cell in row-major order.
+    struct SharedGridHeader
+    {
+        // Written last by the server, so readers never see a partial snapshot
+        char magic[4] = {0, 0, 0, 0};
+        uint32_t version = SHARED_GRID_VERSION;
+        int32_t width = 0;
+        int32_t height = 0;
+        double resolution = 0.0;
+        // Total size of the shared memory object in bytes
+        uint64_t size = 0;
+    };
+
+    /// \brief Publishes an immutable snapshot of a Grid into POSIX shared memory.
+    /// The shared memory object is unlinked when the server is destroyed.
+    class GridServer
+    {
+    public:
+        // \brief copies the Grid cell types into a new shared memory object
+        // \param name_: shared memory object name (eg: "/planning_grid")
+        // \param grid: the built Grid to publish
+        GridServer(const std::string & name_, const Grid & grid);
+
+        ~GridServer();
+
+        GridServer(const GridServer &) = delete;
+        GridServer & operator=(const GridServer &) = delete;
+
+    private:
+        std::string name;
+        void * mapped = nullptr;
+        size_t length = 0;
+    };
+
+    /// \brief Read-only Grid attached to a snapshot published by GridServer. Cells are built on demand,
+    /// so many planners on one host share a single copy of the map.
+    class GridView
+    {
+    public:
+        // \brief attaches to a published snapshot. Throws std::runtime_error if it does not exist or is invalid.
+        // \param name: shared memory object name used by the GridServer
+        explicit GridView(const std::string & name);
+
+        ~GridView();
+
+        GridView(const GridView &) = delete;
+        GridView & operator=(const GridView &) = delete;
+
+        // \returns the width and height of the grid in cells
+        std::vector<int> return_grid_dimensions() const;
+
+        // \returns the grid cell size
+        double return_resolution() const;
+
+        // \returns the world coordinates of the grid's bottom-left corner
+        Vector2D return_origin() const;
+
+        // \brief returns the type of a cell
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        CellType celltype(const int & x, const int & y) const;
+
+        // \brief builds the Cell at a grid coordinate
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \returns the Cell, including its index and type
+        Cell return_cell(const int & x, const int & y) const;
+
+        // \brief converts world coordinates to grid coordinates. Same convention as Grid::world2grid.
+        // \param cell: a grid cell
+        // \returns the grid cell's Index
+        Index world2grid(const Cell & cell) const;
+
+        // \brief populates Occupancy Grid with values for visualization
+        // \param map: the Occupancy Grid map to populate
+        void occupancy_grid(std::vector<int8_t> & map) const;
+
+    private:
+        const uint8_t * mapped = nullptr;
+        size_t length = 0;
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        const double * xcells = nullptr;
+        const double * ycells = nullptr;
+        const uint8_t * types = nullptr;
+    };
+}
+
+#endif
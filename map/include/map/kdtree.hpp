@@ -0,0 +1,62 @@
+#ifndef KDTREE_INCLUDE_GUARD_HPP
+#define KDTREE_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Static 2-d tree over roadmap Vertices for nearest neighbour queries in O(log n) instead of a linear scan.
+#include <map/prm.hpp>
+
+namespace map
+{
+    using rigid2d::Vector2D;
+
+    // \brief point stored in the KDTree
+    struct KDPoint
+    {
+        Vector2D coords;
+        // Vertex ID (or position in the input for plain points)
+        int id;
+    };
+
+    /// \brief balanced 2-d tree, stored implicitly: the median of each range of points splits it, alternating
+    /// between x and y with depth, so no child pointers are needed.
+    class KDTree
+    {
+    public:
+        // \brief empty tree
+        KDTree() = default;
+
+        // \brief builds the tree over plain points, identified by their position in points
+        // \param points_: the points
+        explicit KDTree(const std::vector<Vector2D> & points_);
+
+        // \brief builds the tree over roadmap Vertices, identified by their IDs
+        // \param prm: the roadmap
+        explicit KDTree(const std::vector<Vertex> & prm);
+
+        // \brief finds the k points closest to a position
+        // \param position: the query coordinates
+        // \param k: number of points wanted
+        // \returns the IDs of up to k points, closest first
+        std::vector<int> knn(const Vector2D & position, const int & k) const;
+
+        // \brief finds the point closest to a position
+        // \param position: the query coordinates
+        // \returns its ID, -1 if the tree is empty
+        int nearest(const Vector2D & position) const;
+
+        // \returns the number of points in the tree
+        int return_size() const;
+
+    private:
+        // \brief orders points[lo, hi) so that each range's median splits it
+        void build(const int & lo, const int & hi, const int & depth);
+
+        // \brief visits the range [lo, hi), nearest side first, keeping the k best in a max-heap of
+        // (squared distance, ID)
+        void search(const int & lo, const int & hi, const int & depth, const Vector2D & position, const int & k,
+                    std::vector<std::pair<double, int>> & best) const;
+
+        std::vector<KDPoint> points;
+    };
+}
+
+#endif
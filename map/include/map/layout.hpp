@@ -0,0 +1,216 @@
+#ifndef LAYOUT_INCLUDE_GUARD_HPP
+#define LAYOUT_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Cell storage layouts for grids: row-major, Z-order (Morton) blocks so that vertical neighbours
+/// are close in memory, row-major with a sentinel border for bounds-check-free neighbour iteration,
+/// or tile-major so that each 64x64 tile is one contiguous run of storage.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace map
+{
+    // \brief storage order of per-cell data.
+    // RowMajor: x + y * width (same as grid2rowmajor).
+    // ZOrder: 16x16 blocks in row-major order, Morton order inside each block.
+    // Padded: row-major with a one-cell border around the grid. Border slots hold blocked sentinels,
+    // so every cell's 8 neighbours are valid storage indices.
+    // Tiled: 64x64 tiles in row-major order, row-major inside each tile (the tiles of TiledGrid).
+    enum class CellLayout {RowMajor, ZOrder, Padded, Tiled};
+
+    // \brief grid coordinate offset to a neighbouring cell
+    struct GridOffset
+    {
+        int dx;
+        int dy;
+    };
+
+    // 4-connected neighbour offsets
+    constexpr std::array<GridOffset, 4> OFFSETS_4 = {{{-1, 0}, {0, -1}, {0, 1}, {1, 0}}};
+
+    // 8-connected neighbour offsets, in the order the planners have always visited the 3x3 block
+    constexpr std::array<GridOffset, 8> OFFSETS_8 = {{{-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
+                                                     {0, 1}, {1, -1}, {1, 0}, {1, 1}}};
+
+    // ZOrder blocks are 1 << ZORDER_BLOCK_SHIFT cells wide (16)
+    constexpr int ZORDER_BLOCK_SHIFT = 4;
+    constexpr int ZORDER_BLOCK_SIZE = 1 << ZORDER_BLOCK_SHIFT;
+    constexpr int ZORDER_BLOCK_MASK = ZORDER_BLOCK_SIZE - 1;
+
+    // Tiled blocks are 1 << TILED_BLOCK_SHIFT cells wide (64)
+    constexpr int TILED_BLOCK_SHIFT = 6;
+    constexpr int TILED_BLOCK_SIZE = 1 << TILED_BLOCK_SHIFT;
+    constexpr int TILED_BLOCK_MASK = TILED_BLOCK_SIZE - 1;
+
+    // \brief spreads the lower 16 bits of v so that bit i moves to bit 2i
+    constexpr uint32_t morton_spread(uint32_t v)
+    {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    // \brief inverse of morton_spread: gathers the even bits of v
+    constexpr uint32_t morton_compact(uint32_t v)
+    {
+        v &= 0x55555555;
+        v = (v | (v >> 1)) & 0x33333333;
+        v = (v | (v >> 2)) & 0x0f0f0f0f;
+        v = (v | (v >> 4)) & 0x00ff00ff;
+        v = (v | (v >> 8)) & 0x0000ffff;
+        return v;
+    }
+
+    // \brief interleaves the bits of x and y (x in the even bits). x, y < 65536.
+    // \returns the Morton code of (x, y)
+    constexpr uint32_t morton_encode(const uint32_t x, const uint32_t y)
+    {
+        return morton_spread(x) | (morton_spread(y) << 1);
+    }
+
+    // \brief splits a Morton code back into x and y
+    // \param code: the Morton code
+    // \param x: set to the x coordinate
+    // \param y: set to the y coordinate
+    inline void morton_decode(const uint32_t & code, int & x, int & y)
+    {
+        x = static_cast<int>(morton_compact(code));
+        y = static_cast<int>(morton_compact(code >> 1));
+    }
+
+    /// \brief Maps grid coordinates to storage indices for a CellLayout. ZOrder and Tiled storage are padded to whole blocks,
+    /// so size() may exceed width * height; padding slots are never returned by index().
+    class GridIndexer
+    {
+    public:
+        GridIndexer() = default;
+
+        // \param width_: number of cells along x
+        // \param height_: number of cells along y
+        // \param layout_: storage order
+        GridIndexer(const int & width_, const int & height_, const CellLayout & layout_)
+        {
+            width = width_;
+            height = height_;
+            layout = layout_;
+            blocks_x = (width + ZORDER_BLOCK_MASK) >> ZORDER_BLOCK_SHIFT;
+            tiles_x = (width + TILED_BLOCK_MASK) >> TILED_BLOCK_SHIFT;
+            stride = layout == CellLayout::Padded ? width + 2 : width;
+        }
+
+        // \brief storage index of a cell
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        int index(const int & x, const int & y) const
+        {
+            if (layout == CellLayout::RowMajor)
+            {
+                return x + y * width;
+            } else if (layout == CellLayout::Padded)
+            {
+                return (x + 1) + (y + 1) * stride;
+            } else if (layout == CellLayout::Tiled)
+            {
+                const int tile = (y >> TILED_BLOCK_SHIFT) * tiles_x + (x >> TILED_BLOCK_SHIFT);
+                return (tile << (2 * TILED_BLOCK_SHIFT)) | ((y & TILED_BLOCK_MASK) << TILED_BLOCK_SHIFT) |
+                       (x & TILED_BLOCK_MASK);
+            }
+            const int block = (y >> ZORDER_BLOCK_SHIFT) * blocks_x + (x >> ZORDER_BLOCK_SHIFT);
+            return (block << (2 * ZORDER_BLOCK_SHIFT)) |
+                   static_cast<int>(morton_encode(x & ZORDER_BLOCK_MASK, y & ZORDER_BLOCK_MASK));
+        }
+
+        // \brief grid coordinates of a storage index
+        // \param idx: storage index returned by index()
+        // \param x: set to the x-coordinate of the grid cell
+        // \param y: set to the y-coordinate of the grid cell
+        void coords(const int & idx, int & x, int & y) const
+        {
+            if (layout == CellLayout::RowMajor)
+            {
+                x = idx % width;
+                y = idx / width;
+                return;
+            } else if (layout == CellLayout::Padded)
+            {
+                x = idx % stride - 1;
+                y = idx / stride - 1;
+                return;
+            } else if (layout == CellLayout::Tiled)
+            {
+                const int tile = idx >> (2 * TILED_BLOCK_SHIFT);
+                x = ((tile % tiles_x) << TILED_BLOCK_SHIFT) | (idx & TILED_BLOCK_MASK);
+                y = ((tile / tiles_x) << TILED_BLOCK_SHIFT) | ((idx >> TILED_BLOCK_SHIFT) & TILED_BLOCK_MASK);
+                return;
+            }
+            const int block = idx >> (2 * ZORDER_BLOCK_SHIFT);
+            morton_decode(static_cast<uint32_t>(idx & ((1 << (2 * ZORDER_BLOCK_SHIFT)) - 1)), x, y);
+            x += (block % blocks_x) << ZORDER_BLOCK_SHIFT;
+            y += (block / blocks_x) << ZORDER_BLOCK_SHIFT;
+        }
+
+        // \returns the number of storage slots needed, including padding
+        size_t size() const
+        {
+            if (layout == CellLayout::RowMajor)
+            {
+                return static_cast<size_t>(width) * height;
+            } else if (layout == CellLayout::Padded)
+            {
+                return static_cast<size_t>(stride) * (height + 2);
+            } else if (layout == CellLayout::Tiled)
+            {
+                const size_t tiles_y = (height + TILED_BLOCK_MASK) >> TILED_BLOCK_SHIFT;
+                return static_cast<size_t>(tiles_x) * tiles_y * TILED_BLOCK_SIZE * TILED_BLOCK_SIZE;
+            }
+            const size_t blocks_y = (height + ZORDER_BLOCK_MASK) >> ZORDER_BLOCK_SHIFT;
+            return static_cast<size_t>(blocks_x) * blocks_y * ZORDER_BLOCK_SIZE * ZORDER_BLOCK_SIZE;
+        }
+
+        // \brief storage index differences to the 8 neighbours, in OFFSETS_8 order. Not valid for ZOrder or Tiled.
+        // With Padded, idx + offset is a valid storage index for every cell idx.
+        std::array<int, 8> neighbour_offsets() const
+        {
+            std::array<int, 8> offsets;
+            for (size_t k = 0; k < OFFSETS_8.size(); k++)
+            {
+                offsets[k] = OFFSETS_8[k].dx + OFFSETS_8[k].dy * stride;
+            }
+            return offsets;
+        }
+
+        // \returns number of cells along x
+        int return_width() const
+        {
+            return width;
+        }
+
+        // \returns number of cells along y
+        int return_height() const
+        {
+            return height;
+        }
+
+        // \returns the storage order
+        CellLayout return_layout() const
+        {
+            return layout;
+        }
+
+    private:
+        int width = 0;
+        int height = 0;
+        // Number of ZOrder blocks along x
+        int blocks_x = 0;
+        // Number of Tiled blocks along x
+        int tiles_x = 0;
+        // Row length in storage (RowMajor and Padded)
+        int stride = 0;
+        CellLayout layout = CellLayout::RowMajor;
+    };
+}
+
+#endif
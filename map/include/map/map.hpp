@@ -5,6 +5,7 @@
 /// NOTE: rigid2d is from turtlebot3_from_scratch (tb3 in nuturtle.rosinstall)
 #include <rigid2d/rigid2d.hpp>
 #include <vector>
+#include <array>
 #include <eigen3/Eigen/Dense>
 
 namespace map
@@ -41,15 +42,15 @@ namespace map
         Map(const std::vector<Obstacle> & obstacles_, const double inflate_robot_);
 
         /// \brief return vector of obstacles
-        /// \returns vector of Obstacle
-        std::vector<Obstacle> return_obstacles();
+        /// \returns const reference to vector of Obstacle
+        const std::vector<Obstacle> & return_obstacles() const;
 
         /// \brief assigns the map space to map_extent in absolute(x,y).
         void find_map_extent();
 
         // \brief return map bounds
-        // \returns std::vector<Vector2D> containing minimum and maximum bounds respectively
-        std::vector<Vector2D> return_map_bounds();
+        // \returns std::array<Vector2D, 2> containing minimum and maximum bounds respectively (no allocation)
+        std::array<Vector2D, 2> return_map_bounds() const;
 
 
     // protected instead of private so that child Class can access
@@ -5,6 +5,7 @@
 #include <map/map.hpp>
 #include <unordered_set>
 #include <unordered_map>
+#include <string>
 
 namespace map
 {
@@ -16,7 +17,7 @@ namespace map
         // init to -1 for error checking
         int next_id = -1;
         // Euclidean Distance between Nodes (Vertices)
-        int distance;
+        double distance = 0.0;
     };
 
     struct Vertex
@@ -70,6 +71,15 @@ namespace map
         // \param thresh: Euclidean Distance Threshold for valid Edge.
         void build_map(const int & n, int & k, const double & thresh);
 
+        // \brief Loads the Roadmap from cache_dir if an artifact with the same obstacles and parameters exists.
+        // Otherwise builds the Roadmap and stores it in cache_dir. An empty cache_dir disables the cache.
+        // \param n: number of nodes to put in the Roadmap.
+        // \param k: number of closest neighbours to examine for each configuration.
+        // \param thresh: Euclidean Distance Threshold for valid Edge.
+        // \param cache_dir: directory holding cached artifacts
+        // \returns whether the Roadmap was loaded from cache
+        bool build_map(const int & n, int & k, const double & thresh, const std::string & cache_dir);
+
         // \brief Sample free space Q for configurations q. Steps 3-8 of algorithm.
         // \param n: number of nodes to put in the Roadmap.
         void sample_configurations(const int & n);
@@ -118,9 +128,16 @@ namespace map
         // \param inflate_robot: approximate robot radius used for collision checking.
         friend bool too_close(const Vertex & E1, const Vertex & E2, const Vertex & P0, const double & inflate_robot);
 
+        // \brief Sparsifies the Roadmap (SPARS-style). Keeps guard Vertices for coverage and connectivity,
+        // then adds back the Edges/Vertices needed to keep paths within the stretch factor of the dense Roadmap.
+        // NOTE: Vertex IDs are re-assigned so that ID = position in vector still holds.
+        // \param stretch: maximum ratio between sparse and dense path lengths across each dense Edge (>= 1)
+        // \param delta: visibility range of a guard Vertex, used for coverage
+        void sparsify(const double & stretch, const double & delta);
+
         // \brief Return Probabilistic Road Map
-        // \returns Probabilistic Road Map 
-        std::vector<Vertex> return_prm();
+        // \returns const reference to Probabilistic Road Map
+        const std::vector<Vertex> & return_prm() const;
     private:
         // Hash Table
         std::vector<Vertex> configurations;
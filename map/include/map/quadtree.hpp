@@ -0,0 +1,120 @@
+#ifndef QUADTREE_INCLUDE_GUARD_HPP
+#define QUADTREE_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Multi-resolution Grid: a region quadtree over the Grid cells whose homogeneous quads are merged
+/// into single leaves, so open areas are covered by a few large cells and cluttered areas stay fine-grained.
+#include <map/grid.hpp>
+#include <cstdint>
+
+namespace map
+{
+    using rigid2d::Vector2D;
+
+    // \brief a leaf of the QuadTree: a square block of Grid cells sharing one CellType
+    struct QuadLeaf
+    {
+        // Grid coordinates of the bottom-left cell
+        int x;
+        int y;
+        // Side length in cells (power of 2)
+        int size;
+        CellType celltype;
+        // IDs of the Free leaves sharing an edge or a corner with this one (Free leaves only)
+        std::vector<int> neighbours;
+    };
+
+    // \brief internal node of the QuadTree
+    struct QuadNode
+    {
+        int x;
+        int y;
+        int size;
+        // Index of the first of 4 contiguous children (-1 for leaves).
+        // Children are ordered (low x, low y), (high x, low y), (low x, high y), (high x, high y).
+        int first_child = -1;
+        // Index into the leaves (-1 for internal nodes and quads outside the grid)
+        int leaf = -1;
+        // CellType of a leaf. Internal nodes and quads outside the grid use values past Free.
+        uint8_t type = 0;
+    };
+
+    /// \brief stores Obstacle(s) to construct a quadtree over the Grid cells. Inherits from Map in map.hpp.
+    /// Leaves cover exactly the cells Grid would build at the same resolution, with the same labels.
+    class QuadTree : public Map
+    {
+        // Inherits Constructors
+        using Map::Map;
+
+    public:
+
+        // \brief Constructs the quadtree. Quads away from every obstacle become Free leaves without labelling
+        // their cells, and quads whose 4 children are leaves of the same type are merged.
+        // \param resolution: size of the smallest leaf
+        void build_map(const double & resolution);
+
+        // \brief finds the leaf containing a grid cell
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \returns the leaf ID
+        int locate(const int & x, const int & y) const;
+
+        // \brief finds the leaf containing world coordinates. Same convention as Grid::world2grid.
+        // \param coords: the world coordinates
+        // \returns the leaf ID
+        int world2leaf(const Vector2D & coords) const;
+
+        // \brief returns the type of a cell
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        CellType celltype(const int & x, const int & y) const;
+
+        // \brief builds a Cell covering a whole leaf: coords is its bottom-left corner and resolution its side length
+        // \param id: the leaf ID
+        // \returns the Cell, indexed by the leaf's bottom-left grid cell
+        Cell return_leaf_cell(const int & id) const;
+
+        // \returns the world coordinates of the centre of a leaf
+        Vector2D leaf_center(const int & id) const;
+
+        // \returns the leaves
+        const std::vector<QuadLeaf> & return_leaves() const;
+
+        // \brief returns the width and height of the grid in cells
+        // \returns int vector containing width and height respectively.
+        std::vector<int> return_grid_dimensions() const;
+
+        // \returns the smallest leaf size
+        double return_resolution() const;
+
+        // \returns the world coordinates of the grid's bottom-left corner
+        Vector2D return_origin() const;
+
+        // \brief populates Occupancy Grid with values for visualization
+        // \param map: the Occupancy Grid map to populate
+        void occupancy_grid(std::vector<int8_t> & map) const;
+
+    private:
+        // \brief builds the subtree of a quad, merging homogeneous children
+        void build_quad(const int & id);
+
+        // \brief fills in the neighbours of a Free leaf
+        void link_leaf(const int & id);
+
+        // \brief labels one cell the same way Grid::build_map does
+        CellType label_cell(const int & x, const int & y) const;
+
+        // \brief whether the cell centres of a block may lie within inflate_robot of an obstacle (bounding box test)
+        bool near_obstacle(const int & x, const int & y, const int & size) const;
+
+        int width = 0;
+        int height = 0;
+        double resolution = 0.0;
+        std::vector<double> xcells;
+        std::vector<double> ycells;
+        // Tree nodes, root first
+        std::vector<QuadNode> nodes;
+        std::vector<QuadLeaf> leaves;
+    };
+}
+
+#endif
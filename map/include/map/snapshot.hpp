@@ -0,0 +1,125 @@
+#ifndef SNAPSHOT_INCLUDE_GUARD_HPP
+#define SNAPSHOT_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Versioned Grid with tile-level copy-on-write. Writers publish new snapshots while readers keep
+/// planning on the reference-counted snapshot they hold.
+#include <map/grid.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace map
+{
+    using rigid2d::Vector2D;
+
+    // Side length of a copy-on-write tile in cells
+    constexpr int SNAPSHOT_TILE_SIZE = 32;
+
+    // \brief square block of cell types. Tiles are shared between snapshots until a write touches them.
+    struct GridTile
+    {
+        std::array<uint8_t, SNAPSHOT_TILE_SIZE * SNAPSHOT_TILE_SIZE> types;
+    };
+
+    /// \brief Immutable version of a Grid. Exposes the same grid index API as Grid and GridView,
+    /// so planners search it directly.
+    class GridSnapshot
+    {
+    public:
+        // \returns the version number of this snapshot. Increases by one with every commit.
+        uint64_t return_epoch() const;
+
+        // \returns the width and height of the grid in cells
+        std::vector<int> return_grid_dimensions() const;
+
+        // \returns the grid cell size
+        double return_resolution() const;
+
+        // \returns the world coordinates of the grid's bottom-left corner
+        Vector2D return_origin() const;
+
+        // \brief returns the type of a cell
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        CellType celltype(const int & x, const int & y) const
+        {
+            const GridTile & tile = *tiles[(y / SNAPSHOT_TILE_SIZE) * tiles_x + x / SNAPSHOT_TILE_SIZE];
+            return static_cast<CellType>(tile.types[(y % SNAPSHOT_TILE_SIZE) * SNAPSHOT_TILE_SIZE + x % SNAPSHOT_TILE_SIZE]);
+        }
+
+        // \brief builds the Cell at a grid coordinate
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \returns the Cell, including its index and type
+        Cell return_cell(const int & x, const int & y) const;
+
+        // \brief converts world coordinates to grid coordinates. Same convention as Grid::world2grid.
+        // \param cell: a grid cell
+        // \returns the grid cell's Index
+        Index world2grid(const Cell & cell) const;
+
+        // \brief populates Occupancy Grid with values for visualization
+        // \param map: the Occupancy Grid map to populate
+        void occupancy_grid(std::vector<int8_t> & map) const;
+
+        // \returns the number of tiles this snapshot shares with other
+        int shared_tiles(const GridSnapshot & other) const;
+
+        // \brief lists the cells whose type differs from an older snapshot of the same VersionedGrid.
+        // Only tiles that are not shared with older are read.
+        // \param older: the older snapshot
+        // \returns the changed cells with their new type and newView set, as Grid::update_grid returns them
+        std::vector<Cell> changes_since(const GridSnapshot & older) const;
+
+    private:
+        friend class VersionedGrid;
+
+        uint64_t epoch = 0;
+        int width = 0;
+        int height = 0;
+        // Number of tiles along x
+        int tiles_x = 0;
+        double resolution = 0.0;
+        // Cell corner coordinates never change, so every snapshot shares them
+        std::shared_ptr<const std::vector<double>> xcells;
+        std::shared_ptr<const std::vector<double>> ycells;
+        // Tiles in row-major order
+        std::vector<std::shared_ptr<const GridTile>> tiles;
+    };
+
+    /// \brief Publishes GridSnapshots. Each commit copies only the tiles containing changed cells,
+    /// so holding and taking snapshots is cheap. Safe to use from several threads.
+    class VersionedGrid
+    {
+    public:
+        // \brief takes the first snapshot (epoch 0) from the cell types of a built Grid
+        // \param grid: the built Grid
+        explicit VersionedGrid(const Grid & grid);
+
+        // \brief takes the first snapshot (epoch 0) of a built Grid with other cell types
+        // \param grid: the built Grid, for the cell coordinates
+        // \param cells: the cell types in row-major order (eg: Grid::return_fake_grid())
+        VersionedGrid(const Grid & grid, const std::vector<Cell> & cells);
+
+        // \returns the latest snapshot. It stays valid and unchanged for as long as the caller holds it.
+        std::shared_ptr<const GridSnapshot> snapshot() const;
+
+        // \brief publishes a new snapshot in which the given cells take their new types
+        // \param changes: cells with updated celltype (eg: the return of Grid::update_grid)
+        // \returns the epoch of the latest snapshot. Unchanged if no cell type changed.
+        uint64_t commit(const std::vector<Cell> & changes);
+
+        // \returns the epoch of the latest snapshot
+        uint64_t return_epoch() const;
+
+    private:
+        // Guards current. Held only to copy or swap the pointer.
+        mutable std::mutex snapshot_mutex;
+        // Serializes commits
+        std::mutex writer_mutex;
+        std::shared_ptr<const GridSnapshot> current;
+    };
+}
+
+#endif
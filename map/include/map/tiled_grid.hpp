@@ -0,0 +1,112 @@
+#ifndef TILED_GRID_INCLUDE_GUARD_HPP
+#define TILED_GRID_INCLUDE_GUARD_HPP
+/// \file
+/// \brief Sparse Grid backend for very large maps. Cells are stored in square tiles that are only allocated
+/// when their cells differ; uniform tiles are stored as a single CellType.
+#include <map/grid.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace map
+{
+    using rigid2d::Vector2D;
+
+    // Tile side length is 1 << TILED_GRID_SHIFT cells (64), the blocks of CellLayout::Tiled
+    constexpr int TILED_GRID_SHIFT = TILED_BLOCK_SHIFT;
+    constexpr int TILED_GRID_TILE_SIZE = 1 << TILED_GRID_SHIFT;
+    constexpr int TILED_GRID_MASK = TILED_GRID_TILE_SIZE - 1;
+
+    // \brief a tile of the TiledGrid. cells is null while every cell has the uniform type.
+    struct GridTileStorage
+    {
+        uint8_t uniform = static_cast<uint8_t>(Free);
+        std::unique_ptr<std::array<uint8_t, TILED_GRID_TILE_SIZE * TILED_GRID_TILE_SIZE>> cells;
+    };
+
+    /// \brief stores Obstacle(s) to construct a sparse tiled Grid. Inherits from Map in map.hpp.
+    /// Same cell labels and coordinates as Grid, and the same grid index API, so planners search it directly.
+    class TiledGrid : public Map
+    {
+        // Inherits Constructors
+        using Map::Map;
+
+    public:
+
+        // \brief Constructs the tiled Grid Map. Tiles away from every obstacle are marked Free without labelling
+        // their cells, and labelled tiles whose cells all share a type are collapsed to that type.
+        // \param resolution: determines the grid cell size
+        void build_map(const double & resolution);
+
+        // \brief returns the type of a cell
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        CellType celltype(const int & x, const int & y) const
+        {
+            const GridTileStorage & tile = tiles[(y >> TILED_GRID_SHIFT) * tiles_x + (x >> TILED_GRID_SHIFT)];
+            if (!tile.cells)
+            {
+                return static_cast<CellType>(tile.uniform);
+            }
+            return static_cast<CellType>((*tile.cells)[((y & TILED_GRID_MASK) << TILED_GRID_SHIFT) | (x & TILED_GRID_MASK)]);
+        }
+
+        // \brief sets the type of a cell, allocating its tile if it was uniform
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \param type: the new cell type
+        void set_celltype(const int & x, const int & y, const CellType & type);
+
+        // \brief builds the Cell at a grid coordinate
+        // \param x: x-coordinate of grid cell
+        // \param y: y-coordinate of grid cell
+        // \returns the Cell, including its index and type
+        Cell return_cell(const int & x, const int & y) const;
+
+        // \brief converts world coordinates to grid coordinates. Same convention as Grid::world2grid.
+        // \param cell: a grid cell
+        // \returns the grid cell's Index
+        Index world2grid(const Cell & cell) const;
+
+        // \brief returns the width and height of the grid in cells
+        // \returns int vector containing width and height respectively.
+        std::vector<int> return_grid_dimensions() const;
+
+        // \returns the grid cell size
+        double return_resolution() const;
+
+        // \returns the world coordinates of the grid's bottom-left corner
+        Vector2D return_origin() const;
+
+        // \brief populates Occupancy Grid with values for visualization, optionally at a coarser resolution so
+        // that very large maps do not need a dense per-cell copy. Uniform tiles are filled without reading cells.
+        // \param map: the Occupancy Grid map to populate, ceil(width / scale) by ceil(height / scale) cells
+        // \param scale: grid cells per map cell along each axis. Each map cell shows the worst type it covers.
+        void occupancy_grid(std::vector<int8_t> & map, const int & scale = 1) const;
+
+        // \returns the number of tiles holding per-cell storage
+        int return_allocated_tiles() const;
+
+        // \returns the total number of tiles
+        int return_total_tiles() const;
+
+    private:
+        // \brief labels one cell the same way Grid::build_map does
+        CellType label_cell(const int & x, const int & y) const;
+
+        // \brief whether the tile's cell centres may lie within inflate_robot of an obstacle (bounding box test)
+        bool near_obstacle(const int & tx, const int & ty) const;
+
+        int width = 0;
+        int height = 0;
+        // Number of tiles along x
+        int tiles_x = 0;
+        double resolution = 0.0;
+        std::vector<double> xcells;
+        std::vector<double> ycells;
+        // Tiles in row-major order
+        std::vector<GridTileStorage> tiles;
+    };
+}
+
+#endif
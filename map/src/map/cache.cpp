@@ -0,0 +1,175 @@
+#include "map/cache.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace map
+{
+	// ContentHash
+	void ContentHash::add(const void * data, const size_t & size)
+	{
+		const uint8_t * bytes = static_cast<const uint8_t *>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	void ContentHash::add(const std::vector<Obstacle> & obstacles)
+	{
+		add(static_cast<uint64_t>(obstacles.size()));
+		for (const auto & obs : obstacles)
+		{
+			add(static_cast<uint64_t>(obs.vertices.size()));
+			for (const auto & v : obs.vertices)
+			{
+				add(v.x);
+				add(v.y);
+			}
+		}
+	}
+
+	uint64_t ContentHash::value() const
+	{
+		return hash;
+	}
+
+	// MappedFile
+	MappedFile::MappedFile(const std::string & path)
+	{
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) == 0 and st.st_size > 0)
+		{
+			void * ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (ptr != MAP_FAILED)
+			{
+				mapped = static_cast<const uint8_t *>(ptr);
+				length = static_cast<size_t>(st.st_size);
+			}
+		}
+		// The mapping stays valid after closing the descriptor
+		close(fd);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (mapped)
+		{
+			munmap(const_cast<uint8_t *>(mapped), length);
+		}
+	}
+
+	bool MappedFile::is_open() const
+	{
+		return mapped != nullptr;
+	}
+
+	const uint8_t * MappedFile::data() const
+	{
+		return mapped;
+	}
+
+	size_t MappedFile::size() const
+	{
+		return length;
+	}
+
+	// CacheReader
+	CacheReader::CacheReader(const uint8_t * data_, const size_t & size_)
+	{
+		data = data_;
+		size = size_;
+	}
+
+	bool CacheReader::read(void * out, const size_t & n)
+	{
+		if (n > size - offset)
+		{
+			return false;
+		}
+		std::memcpy(out, data + offset, n);
+		offset += n;
+		return true;
+	}
+
+	// Helper Functions
+	std::string cache_filename(const std::string & dir, const CacheKind & kind, const uint64_t & key)
+	{
+		char name[64];
+		std::snprintf(name, sizeof(name), "%s_%016llx.bin", kind == GridArtifact ? "grid" : "prm",
+					  static_cast<unsigned long long>(key));
+		return dir + "/" + name;
+	}
+
+	bool open_cache(const MappedFile & file, const CacheKind & kind, const uint64_t & key, CacheReader & reader)
+	{
+		if (!file.is_open() or file.size() < sizeof(CacheHeader))
+		{
+			return false;
+		}
+
+		CacheHeader header;
+		CacheHeader expected;
+		std::memcpy(&header, file.data(), sizeof(CacheHeader));
+
+		if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 or
+			header.version != CACHE_VERSION or header.kind != kind or header.key != key or
+			header.payload_size != file.size() - sizeof(CacheHeader))
+		{
+			return false;
+		}
+
+		reader = CacheReader(file.data() + sizeof(CacheHeader), header.payload_size);
+		return true;
+	}
+
+	bool write_cache(const std::string & path, const CacheKind & kind, const uint64_t & key, const std::vector<uint8_t> & payload)
+	{
+		CacheHeader header;
+		header.kind = kind;
+		header.key = key;
+		header.payload_size = payload.size();
+
+		// Write next to the destination, then rename so readers never map a partial file.
+		// The temporary name is unique, so writers of the same artifact never share a file.
+		std::string tmp_path = path + ".XXXXXX";
+		const int fd = mkstemp(&tmp_path[0]);
+		if (fd < 0)
+		{
+			return false;
+		}
+		// mkstemp creates the file readable by its owner only
+		fchmod(fd, 0644);
+		std::FILE * file = fdopen(fd, "wb");
+		if (!file)
+		{
+			close(fd);
+			std::remove(tmp_path.c_str());
+			return false;
+		}
+
+		bool ok = std::fwrite(&header, sizeof(CacheHeader), 1, file) == 1;
+		if (!payload.empty())
+		{
+			ok = ok and std::fwrite(payload.data(), payload.size(), 1, file) == 1;
+		}
+		ok = (std::fclose(file) == 0) and ok;
+
+		if (!ok or std::rename(tmp_path.c_str(), path.c_str()) != 0)
+		{
+			std::remove(tmp_path.c_str());
+			return false;
+		}
+		return true;
+	}
+}
@@ -1,4 +1,6 @@
 #include "map/grid.hpp"
+#include "map/cache.hpp"
+#include <algorithm>
 
 namespace map
 {
@@ -16,6 +18,9 @@ namespace map
 
 	void Grid::build_map(const double & resolution)
 	{
+		cells.clear();
+		fake_grid.clear();
+
 		// Step 1. divide grid into cells based on resolution and store in class members
 		xcells = arange<double>(map_min.x, map_max.x, resolution);
 		ycells = arange<double>(map_min.y, map_max.y, resolution);
@@ -44,6 +49,97 @@ namespace map
 			}
 		}
 
+		// Step 3. Populate more cell information such as row-major order and grid index
+		index_cells();
+	}
+
+	bool Grid::build_map(const double & resolution, const std::string & cache_dir)
+	{
+		if (cache_dir.empty())
+		{
+			build_map(resolution);
+			return false;
+		}
+
+		// Key on everything that affects cell labels
+		ContentHash hash;
+		hash.add(CACHE_VERSION);
+		hash.add(GridArtifact);
+		hash.add(obstacles);
+		hash.add(inflate_robot);
+		hash.add(resolution);
+		const uint64_t key = hash.value();
+		const std::string path = cache_filename(cache_dir, GridArtifact, key);
+
+		{
+			MappedFile file(path);
+			CacheReader reader(nullptr, 0);
+			if (open_cache(file, GridArtifact, key, reader))
+			{
+				// Payload: nx, ny, xcells, ycells, one CellType byte per cell in row-major order
+				int32_t nx = 0;
+				int32_t ny = 0;
+				bool ok = reader.read(nx) and reader.read(ny) and nx >= 0 and ny >= 0;
+				if (ok)
+				{
+					xcells.resize(nx);
+					ycells.resize(ny);
+					std::vector<uint8_t> types(static_cast<size_t>(nx) * ny);
+					ok = reader.read(xcells.data(), nx * sizeof(double)) and
+						 reader.read(ycells.data(), ny * sizeof(double)) and
+						 reader.read(types.data(), types.size());
+					// A corrupt file must not produce cell types outside the enum
+					ok = ok and std::all_of(types.begin(), types.end(), [](const uint8_t & type) {return type <= Free;});
+
+					if (ok)
+					{
+						cells.clear();
+						fake_grid.clear();
+						cells.reserve(types.size());
+						for (int i = 0; i < ny; i++)
+						{
+							for (int j = 0; j < nx; j++)
+							{
+								Cell cell(Vector2D(xcells.at(j), ycells.at(i)), resolution);
+								cell.celltype = static_cast<CellType>(types.at(cells.size()));
+								cells.push_back(cell);
+							}
+						}
+						index_cells();
+						std::cout << "Loaded Grid from cache: " << path << std::endl;
+						return true;
+					}
+				}
+			}
+		}
+
+		build_map(resolution);
+
+		std::vector<uint8_t> payload;
+		cache_write(payload, static_cast<int32_t>(xcells.size()));
+		cache_write(payload, static_cast<int32_t>(ycells.size()));
+		for (const auto & x : xcells)
+		{
+			cache_write(payload, x);
+		}
+		for (const auto & y : ycells)
+		{
+			cache_write(payload, y);
+		}
+		for (const auto & cell : cells)
+		{
+			cache_write(payload, static_cast<uint8_t>(cell.celltype));
+		}
+
+		if (!write_cache(path, GridArtifact, key, payload))
+		{
+			std::cout << "[WARNING]: Could not write Grid cache: " << path << std::endl;
+		}
+		return false;
+	}
+
+	void Grid::index_cells()
+	{
 		// Populate more cell information such as row-major order and grid index
 		for(unsigned int i = 0; i < cells.size(); i++)
 		{
@@ -66,6 +162,8 @@ namespace map
 			fake_cell.celltype = Free;
 			fake_grid.push_back(fake_cell);
 		}
+
+		pack_types();
 	}
 
 	Index Grid::world2grid(const Cell & cell) const
@@ -118,11 +216,65 @@ namespace map
 		return coord;
 	}
 
-	std::vector<Cell> Grid::return_grid() const
+	const std::vector<Cell> & Grid::return_grid() const
 	{
 		return cells;
 	}
 
+	void Grid::set_layout(const CellLayout & layout_)
+	{
+		layout = layout_;
+		pack_types();
+	}
+
+	CellLayout Grid::return_layout() const
+	{
+		return layout;
+	}
+
+	const std::vector<uint8_t> & Grid::return_celltypes() const
+	{
+		return types;
+	}
+
+	const GridIndexer & Grid::return_indexer() const
+	{
+		return indexer;
+	}
+
+	void Grid::pack_types()
+	{
+		const int width = static_cast<int>(xcells.size());
+		const int height = static_cast<int>(ycells.size());
+		indexer = GridIndexer(width, height, layout);
+
+		// Padding slots (ZOrder) are never read, border slots (Padded) are blocked sentinels
+		types.assign(indexer.size(), static_cast<uint8_t>(Occupied));
+		for (const auto & cell : cells)
+		{
+			types[indexer.index(cell.index.x, cell.index.y)] = static_cast<uint8_t>(cell.celltype);
+		}
+	}
+
+	const Cell & Grid::return_cell(const int & x, const int & y) const
+	{
+		return cells.at(grid2rowmajor(x, y, static_cast<int>(xcells.size())));
+	}
+
+	const Cell & Grid::set_celltype(const int & x, const int & y, const CellType & type)
+	{
+		if (!(x >= 0 and x < static_cast<int>(xcells.size()) and y >= 0 and y < static_cast<int>(ycells.size())))
+		{
+			throw std::invalid_argument("cell coordinates out of bounds!\
+										 \n  where(): Grid::set_celltype(const int & x, const int & y, const CellType & type)");
+		}
+
+		Cell & cell = cells.at(grid2rowmajor(x, y, static_cast<int>(xcells.size())));
+		cell.celltype = type;
+		types[indexer.index(x, y)] = static_cast<uint8_t>(type);
+		return cell;
+	}
+
 	void Grid::occupancy_grid(std::vector<int8_t> & map) const
 	{
 		map.resize(cells.size());
@@ -152,10 +304,11 @@ namespace map
 	}
 
 
-	void Grid::update_grid(const Cell & cc, const int & visibility)
+	std::vector<Cell> Grid::update_grid(const Cell & cc, const int & visibility)
 	{
 
 		std::vector<Cell> cells_to_update = get_neighbours(cc, cells, visibility);
+		std::vector<Cell> changed;
 
 		for (auto iter = cells_to_update.begin(); iter < cells_to_update.end(); iter++)
 		{
@@ -164,15 +317,18 @@ namespace map
 				// std::cout << "NEW OCCUPANCY: " << iter->index.row_major << std::endl;
 				fake_grid.at(iter->index.row_major).celltype = iter->celltype;
 				fake_grid.at(iter->index.row_major).newView = true;
+				changed.push_back(fake_grid.at(iter->index.row_major));
 			} else
 			{
 				fake_grid.at(iter->index.row_major).newView = false;
 			}
 		}
+
+		return changed;
 	}
 
 
-	std::vector<Cell> Grid::return_fake_grid() const
+	const std::vector<Cell> & Grid::return_fake_grid() const
 	{
 		return fake_grid;
 	}
@@ -202,9 +358,10 @@ namespace map
 	{
 		int lower_bound = - visibility;
 		int upper_bound = - lower_bound;
-		int x_max = map.back().index.x;
-		int y_max = map.back().index.y; 
+		int x_max = static_cast<int>(xcells.size()) - 1;
+		int y_max = static_cast<int>(ycells.size()) - 1;
 		std::vector<Cell> neighbours;
+		neighbours.reserve((upper_bound - lower_bound + 1) * (upper_bound - lower_bound + 1) - 1);
 
 		// Evaluate about block. Default is 1 -> 3x3 for 8-connectivity
 		for (int x = lower_bound; x <= upper_bound; x++)
@@ -0,0 +1,231 @@
+#include "map/grid_view.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace map
+{
+	using rigid2d::Vector2D;
+
+	// Shared snapshot magic, written once the payload is complete
+	static const char SHARED_GRID_MAGIC[4] = {'M', 'P', 'G', 'V'};
+
+	// GridServer
+	GridServer::GridServer(const std::string & name_, const Grid & grid)
+	{
+		name = name_;
+
+		const auto dims = grid.return_grid_dimensions();
+		const int width = dims.at(0);
+		const int height = dims.at(1);
+		const auto & cells = grid.return_grid();
+
+		length = sizeof(SharedGridHeader) + (width + height) * sizeof(double) + static_cast<size_t>(width) * height;
+
+		// Replace any stale snapshot with the same name
+		shm_unlink(name.c_str());
+		int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (fd < 0)
+		{
+			throw std::runtime_error("Could not create shared memory object " + name +
+									 "\n  where(): GridServer::GridServer(const std::string & name_, const Grid & grid)");
+		}
+		if (ftruncate(fd, length) != 0)
+		{
+			close(fd);
+			shm_unlink(name.c_str());
+			throw std::runtime_error("Could not size shared memory object " + name +
+									 "\n  where(): GridServer::GridServer(const std::string & name_, const Grid & grid)");
+		}
+		mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (mapped == MAP_FAILED)
+		{
+			mapped = nullptr;
+			shm_unlink(name.c_str());
+			throw std::runtime_error("Could not map shared memory object " + name +
+									 "\n  where(): GridServer::GridServer(const std::string & name_, const Grid & grid)");
+		}
+
+		uint8_t * base = static_cast<uint8_t *>(mapped);
+		SharedGridHeader header;
+		header.width = width;
+		header.height = height;
+		header.resolution = cells.empty() ? 0.0 : cells.front().resolution;
+		header.size = length;
+		std::memcpy(base, &header, sizeof(SharedGridHeader));
+
+		// Cell corner coordinates: first row gives x, first column gives y
+		double * xs = reinterpret_cast<double *>(base + sizeof(SharedGridHeader));
+		double * ys = xs + width;
+		uint8_t * types = reinterpret_cast<uint8_t *>(ys + height);
+		for (int x = 0; x < width; x++)
+		{
+			xs[x] = grid.return_cell(x, 0).coords.x;
+		}
+		for (int y = 0; y < height; y++)
+		{
+			ys[y] = grid.return_cell(0, y).coords.y;
+		}
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				types[grid2rowmajor(x, y, width)] = static_cast<uint8_t>(grid.celltype(x, y));
+			}
+		}
+
+		// Publish: the magic goes in last so readers only ever attach to a complete snapshot
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(base, SHARED_GRID_MAGIC, sizeof(SHARED_GRID_MAGIC));
+
+		// The snapshot is immutable from here on
+		mprotect(mapped, length, PROT_READ);
+	}
+
+	GridServer::~GridServer()
+	{
+		if (mapped)
+		{
+			munmap(mapped, length);
+		}
+		shm_unlink(name.c_str());
+	}
+
+	// GridView
+	GridView::GridView(const std::string & name)
+	{
+		int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+		{
+			throw std::runtime_error("No shared Grid named " + name +
+									 "\n  where(): GridView::GridView(const std::string & name)");
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 or static_cast<size_t>(st.st_size) < sizeof(SharedGridHeader))
+		{
+			close(fd);
+			throw std::runtime_error("Shared Grid " + name + " is too small" +
+									 "\n  where(): GridView::GridView(const std::string & name)");
+		}
+		length = static_cast<size_t>(st.st_size);
+		void * ptr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (ptr == MAP_FAILED)
+		{
+			throw std::runtime_error("Could not map shared Grid " + name +
+									 "\n  where(): GridView::GridView(const std::string & name)");
+		}
+		mapped = static_cast<const uint8_t *>(ptr);
+
+		SharedGridHeader header;
+		std::memcpy(&header, mapped, sizeof(SharedGridHeader));
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		const size_t expected = sizeof(SharedGridHeader) + (header.width + header.height) * sizeof(double) +
+								static_cast<size_t>(header.width) * header.height;
+		if (std::memcmp(header.magic, SHARED_GRID_MAGIC, sizeof(SHARED_GRID_MAGIC)) != 0 or
+			header.version != SHARED_GRID_VERSION or header.width < 0 or header.height < 0 or
+			header.size != length or expected != length)
+		{
+			munmap(const_cast<uint8_t *>(mapped), length);
+			throw std::runtime_error("Shared Grid " + name + " is incomplete or has a different version" +
+									 "\n  where(): GridView::GridView(const std::string & name)");
+		}
+
+		width = header.width;
+		height = header.height;
+		resolution = header.resolution;
+		xcells = reinterpret_cast<const double *>(mapped + sizeof(SharedGridHeader));
+		ycells = xcells + width;
+		types = reinterpret_cast<const uint8_t *>(ycells + height);
+	}
+
+	GridView::~GridView()
+	{
+		munmap(const_cast<uint8_t *>(mapped), length);
+	}
+
+	std::vector<int> GridView::return_grid_dimensions() const
+	{
+		return std::vector<int>{width, height};
+	}
+
+	double GridView::return_resolution() const
+	{
+		return resolution;
+	}
+
+	Vector2D GridView::return_origin() const
+	{
+		if (width == 0 or height == 0)
+		{
+			return Vector2D();
+		}
+		return Vector2D(xcells[0], ycells[0]);
+	}
+
+	CellType GridView::celltype(const int & x, const int & y) const
+	{
+		return static_cast<CellType>(types[grid2rowmajor(x, y, width)]);
+	}
+
+	Cell GridView::return_cell(const int & x, const int & y) const
+	{
+		if (!(x >= 0 and x < width and y >= 0 and y < height))
+		{
+			throw std::invalid_argument("cell coordinates out of bounds!\
+										 \n  where(): GridView::return_cell(const int & x, const int & y)");
+		}
+		Cell cell(Vector2D(xcells[x], ycells[y]), resolution);
+		cell.celltype = celltype(x, y);
+		cell.index.x = x;
+		cell.index.y = y;
+		cell.index.row_major = grid2rowmajor(x, y, width);
+		return cell;
+	}
+
+	Index GridView::world2grid(const Cell & cell) const
+	{
+		// xcells/ycells are evenly spaced, so find the containing cell directly instead of scanning
+		Index index;
+		if (width > 0 and height > 0)
+		{
+			index.x = static_cast<int>(std::floor((cell.center_coords.x - xcells[0]) / resolution));
+			index.y = static_cast<int>(std::floor((cell.center_coords.y - ycells[0]) / resolution));
+		}
+
+		if (!(index.x >= 0 and index.x < width and index.y >= 0 and index.y < height))
+		{
+			throw std::runtime_error("Could not convert from world to grid coordinates!");
+		}
+
+		index.row_major = grid2rowmajor(index.x, index.y, width);
+		return index;
+	}
+
+	void GridView::occupancy_grid(std::vector<int8_t> & map) const
+	{
+		map.resize(static_cast<size_t>(width) * height);
+
+		for(unsigned int i = 0; i < map.size(); i++)
+		{
+			// For each cell type, assign a value to map
+			if (types[i] == Free)
+			{
+				map.at(i) = 0;
+			} else if (types[i] == Inflation)
+			{
+				map.at(i) = 50;
+			} else if (types[i] == Occupied)
+			{
+				map.at(i) = 100;
+			}
+		}
+	}
+}
@@ -0,0 +1,125 @@
+#include "map/kdtree.hpp"
+#include <algorithm>
+
+namespace map
+{
+	namespace
+	{
+		// \returns the coordinate a tree level splits on: x at even depths, y at odd ones
+		double axis_value(const Vector2D & coords, const int & depth)
+		{
+			return depth % 2 == 0 ? coords.x : coords.y;
+		}
+	}
+
+	KDTree::KDTree(const std::vector<Vector2D> & points_)
+	{
+		points.reserve(points_.size());
+		for (size_t i = 0; i < points_.size(); i++)
+		{
+			points.push_back(KDPoint{points_.at(i), static_cast<int>(i)});
+		}
+		build(0, static_cast<int>(points.size()), 0);
+	}
+
+	KDTree::KDTree(const std::vector<Vertex> & prm)
+	{
+		points.reserve(prm.size());
+		for (const auto & vertex : prm)
+		{
+			points.push_back(KDPoint{vertex.coords, vertex.id});
+		}
+		build(0, static_cast<int>(points.size()), 0);
+	}
+
+	std::vector<int> KDTree::knn(const Vector2D & position, const int & k) const
+	{
+		std::vector<std::pair<double, int>> best;
+		if (k > 0)
+		{
+			best.reserve(k);
+			search(0, static_cast<int>(points.size()), 0, position, k, best);
+		}
+
+		std::sort_heap(best.begin(), best.end());
+		std::vector<int> ids;
+		ids.reserve(best.size());
+		for (const auto & candidate : best)
+		{
+			ids.push_back(candidate.second);
+		}
+		return ids;
+	}
+
+	int KDTree::nearest(const Vector2D & position) const
+	{
+		const std::vector<int> ids = knn(position, 1);
+		return ids.empty() ? -1 : ids.front();
+	}
+
+	int KDTree::return_size() const
+	{
+		return static_cast<int>(points.size());
+	}
+
+	void KDTree::build(const int & lo, const int & hi, const int & depth)
+	{
+		if (hi - lo < 2)
+		{
+			return;
+		}
+		const int mid = lo + (hi - lo) / 2;
+		std::nth_element(points.begin() + lo, points.begin() + mid, points.begin() + hi, [&depth](const KDPoint & a, const KDPoint & b)
+		{
+			return axis_value(a.coords, depth) < axis_value(b.coords, depth);
+		});
+		build(lo, mid, depth + 1);
+		build(mid + 1, hi, depth + 1);
+	}
+
+	void KDTree::search(const int & lo, const int & hi, const int & depth, const Vector2D & position, const int & k,
+						std::vector<std::pair<double, int>> & best) const
+	{
+		if (lo >= hi)
+		{
+			return;
+		}
+		const int mid = lo + (hi - lo) / 2;
+		const KDPoint & point = points[mid];
+
+		const double dx = point.coords.x - position.x;
+		const double dy = point.coords.y - position.y;
+		const double d2 = dx * dx + dy * dy;
+		if (static_cast<int>(best.size()) < k)
+		{
+			best.push_back(std::make_pair(d2, point.id));
+			std::push_heap(best.begin(), best.end());
+		} else if (d2 < best.front().first)
+		{
+			std::pop_heap(best.begin(), best.end());
+			best.back() = std::make_pair(d2, point.id);
+			std::push_heap(best.begin(), best.end());
+		}
+
+		// Search the side of the split containing the position first, then the other side only if the
+		// splitting line is closer than the worst point kept
+		const double offset = axis_value(position, depth) - axis_value(point.coords, depth);
+		if (offset < 0.0)
+		{
+			search(lo, mid, depth + 1, position, k, best);
+		} else
+		{
+			search(mid + 1, hi, depth + 1, position, k, best);
+		}
+		if (static_cast<int>(best.size()) < k or offset * offset < best.front().first)
+		{
+			if (offset < 0.0)
+			{
+				search(mid + 1, hi, depth + 1, position, k, best);
+			} else
+			{
+				search(lo, mid, depth + 1, position, k, best);
+			}
+		}
+	}
+}
@@ -39,14 +39,14 @@ namespace map
 		inflate_robot = inflate_robot_;
 	}
 
-	std::vector<Obstacle> Map::return_obstacles()
+	const std::vector<Obstacle> & Map::return_obstacles() const
 	{
 		return obstacles;
 	}
 
 	void Map::find_map_extent()
 	{
-		double x_min, x_max, y_min, y_max = 0;
+		double x_min = 0, x_max = 0, y_min = 0, y_max = 0;
 
 		for (auto obs_iter = obstacles.begin(); obs_iter != obstacles.end(); obs_iter++)
 	    {
@@ -75,13 +75,9 @@ namespace map
 		}
 	}
 
-	std::vector<Vector2D> Map::return_map_bounds()
+	std::array<Vector2D, 2> Map::return_map_bounds() const
 	{
-		std::vector<Vector2D> v;
-		v.push_back(map_min);
-		v.push_back(map_max);
-
-		return v;
+		return std::array<Vector2D, 2>{map_min, map_max};
 	}
 
 
@@ -1,5 +1,8 @@
 #include "map/prm.hpp"
+#include "map/cache.hpp"
 #include "nuslam/ekf.hpp"  // for random number engine
+#include <queue>
+#include <numeric>
 
 namespace map
 {
@@ -69,6 +72,92 @@ namespace map
 	    }
 	}
 
+	bool PRM::build_map(const int & n, int & k, const double & thresh, const std::string & cache_dir)
+	{
+		if (cache_dir.empty())
+		{
+			build_map(n, k, thresh);
+			return false;
+		}
+
+		// Key on everything that affects the Roadmap
+		ContentHash hash;
+		hash.add(CACHE_VERSION);
+		hash.add(PRMArtifact);
+		hash.add(obstacles);
+		hash.add(inflate_robot);
+		hash.add(n);
+		hash.add(std::min(k, n));
+		hash.add(thresh);
+		const uint64_t key = hash.value();
+		const std::string path = cache_filename(cache_dir, PRMArtifact, key);
+
+		{
+			MappedFile file(path);
+			CacheReader reader(nullptr, 0);
+			if (open_cache(file, PRMArtifact, key, reader))
+			{
+				// Payload: num vertices, then per Vertex: x, y, num edges, (next_id, distance) per Edge
+				int32_t num_vertices = 0;
+				bool ok = reader.read(num_vertices) and num_vertices >= 0;
+				std::vector<Vertex> loaded;
+				loaded.reserve(ok ? num_vertices : 0);
+				for (int i = 0; ok and i < num_vertices; i++)
+				{
+					double x = 0.0;
+					double y = 0.0;
+					int32_t num_edges = 0;
+					ok = reader.read(x) and reader.read(y) and reader.read(num_edges) and num_edges >= 0;
+
+					Vertex q(Vector2D(x, y));
+					q.id = i;
+					for (int j = 0; ok and j < num_edges; j++)
+					{
+						int32_t next_id = -1;
+						double distance = 0.0;
+						ok = reader.read(next_id) and reader.read(distance) and next_id >= 0 and next_id < num_vertices;
+						Edge e;
+						e.next_id = next_id;
+						e.distance = distance;
+						q.edges.push_back(e);
+						q.id_set.insert(e.next_id);
+					}
+					loaded.push_back(q);
+				}
+
+				if (ok)
+				{
+					k = std::min(k, n);
+					configurations = loaded;
+					std::cout << "Loaded PRM from cache: " << path << std::endl;
+					return true;
+				}
+			}
+		}
+
+		build_map(n, k, thresh);
+
+		std::vector<uint8_t> payload;
+		cache_write(payload, static_cast<int32_t>(configurations.size()));
+		for (const auto & q : configurations)
+		{
+			cache_write(payload, q.coords.x);
+			cache_write(payload, q.coords.y);
+			cache_write(payload, static_cast<int32_t>(q.edges.size()));
+			for (const auto & e : q.edges)
+			{
+				cache_write(payload, static_cast<int32_t>(e.next_id));
+				cache_write(payload, e.distance);
+			}
+		}
+
+		if (!write_cache(path, PRMArtifact, key, payload))
+		{
+			std::cout << "[WARNING]: Could not write PRM cache: " << path << std::endl;
+		}
+		return false;
+	}
+
 	void PRM::sample_configurations(const int & n)
 	{
 		// MAP EXTENT
@@ -130,6 +219,257 @@ namespace map
 		return knn;
 	}
 
+	// Sparse Roadmap helpers
+	namespace
+	{
+		// \brief disjoint-set forest used to track connected components of guards
+		struct UnionFind
+		{
+			std::vector<int> parent;
+
+			UnionFind(const int & n) : parent(n)
+			{
+				std::iota(parent.begin(), parent.end(), 0);
+			}
+
+			int find(int i)
+			{
+				while (parent.at(i) != i)
+				{
+					// Path halving
+					parent.at(i) = parent.at(parent.at(i));
+					i = parent.at(i);
+				}
+				return i;
+			}
+
+			void unite(const int & a, const int & b)
+			{
+				parent.at(find(a)) = find(b);
+			}
+		};
+
+		// Sparse adjacency stored by dense ID: {neighbour ID, length}
+		using SparseGraph = std::vector<std::vector<std::pair<int, double>>>;
+
+		// \brief Dijkstra on the sparse graph which gives up once the frontier exceeds bound.
+		// \returns shortest distance from src to dst, or infinity if it is larger than bound
+		double bounded_distance(const SparseGraph & graph, const int & src, const int & dst, const double & bound)
+		{
+			std::unordered_map<int, double> dist;
+			std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<>> frontier;
+			dist[src] = 0.0;
+			frontier.push({0.0, src});
+
+			while (!frontier.empty())
+			{
+				auto top = frontier.top();
+				frontier.pop();
+
+				if (top.second == dst)
+				{
+					return top.first;
+				} else if (top.first > bound)
+				{
+					break;
+				} else if (top.first > dist.at(top.second))
+				// Stale entry
+				{
+					continue;
+				}
+
+				for (const auto & edge : graph.at(top.second))
+				{
+					double d = top.first + edge.second;
+					auto search = dist.find(edge.first);
+					if (search == dist.end() or d < search->second)
+					{
+						dist[edge.first] = d;
+						frontier.push({d, edge.first});
+					}
+				}
+			}
+
+			return std::numeric_limits<double>::infinity();
+		}
+
+		void add_sparse_edge(SparseGraph & graph, const int & a, const int & b, const double & length)
+		{
+			if (a == b)
+			{
+				return;
+			}
+			for (const auto & edge : graph.at(a))
+			{
+				if (edge.first == b)
+				{
+					return;
+				}
+			}
+			graph.at(a).push_back({b, length});
+			graph.at(b).push_back({a, length});
+		}
+	}
+
+	void PRM::sparsify(const double & stretch, const double & delta)
+	{
+		if (stretch < 1.0)
+		{
+			throw std::invalid_argument("stretch factor must be >= 1!\
+									 \n  where(): PRM::sparsify(const double & stretch, const double & delta)");
+		}
+
+		const int n = static_cast<int>(configurations.size());
+		auto dist = [&](const int & a, const int & b)
+		{
+			return euclidean_distance(configurations.at(a).coords.x - configurations.at(b).coords.x,
+									  configurations.at(a).coords.y - configurations.at(b).coords.y);
+		};
+
+		// Guards are the dense Vertices kept in the sparse Roadmap
+		std::vector<bool> is_guard(n, false);
+		std::vector<int> guards;
+		// Representative guard of every dense Vertex (a visible guard within delta)
+		std::vector<int> rep(n, -1);
+		SparseGraph graph(n);
+		UnionFind components(n);
+
+		auto add_guard = [&](const int & v)
+		{
+			is_guard.at(v) = true;
+			guards.push_back(v);
+			rep.at(v) = v;
+		};
+
+		// Step 1: Coverage and Connectivity
+		for (int v = 0; v < n; v++)
+		{
+			// Find guards which can see v, closest first
+			std::vector<std::pair<double, int>> visible;
+			for (const auto & g : guards)
+			{
+				double d = dist(v, g);
+				if (d <= delta and no_collision(configurations.at(v), configurations.at(g), inflate_robot))
+				{
+					visible.push_back({d, g});
+				}
+			}
+			std::sort(visible.begin(), visible.end());
+
+			if (visible.empty())
+			// Coverage: nothing sees v, so it becomes a guard
+			{
+				add_guard(v);
+				continue;
+			}
+
+			// Connectivity: v bridges guards in different components
+			std::vector<int> bridges;
+			std::unordered_set<int> seen_components;
+			for (const auto & vis : visible)
+			{
+				if (seen_components.insert(components.find(vis.second)).second)
+				{
+					bridges.push_back(vis.second);
+				}
+			}
+
+			if (bridges.size() > 1)
+			{
+				add_guard(v);
+				for (const auto & g : bridges)
+				{
+					add_sparse_edge(graph, v, g, dist(v, g));
+					components.unite(v, g);
+				}
+			} else
+			{
+				rep.at(v) = visible.front().second;
+			}
+		}
+
+		// Step 2: Path Quality. Every dense Edge u->v must be matched by a sparse path
+		// between their representatives of at most stretch * (|u ru| + |u v| + |v rv|)
+		for (int u = 0; u < n; u++)
+		{
+			for (const auto & edge : configurations.at(u).edges)
+			{
+				const int v = edge.next_id;
+				// Each undirected Edge is stored twice
+				if (v < u)
+				{
+					continue;
+				}
+
+				const int ru = rep.at(u);
+				const int rv = rep.at(v);
+				if (ru == rv)
+				{
+					continue;
+				}
+
+				const double bound = stretch * (dist(u, ru) + dist(u, v) + dist(v, rv));
+				if (bounded_distance(graph, ru, rv, bound) <= bound)
+				{
+					continue;
+				}
+
+				if (no_collision(configurations.at(ru), configurations.at(rv), inflate_robot))
+				// Direct shortcut between the representatives (triangle inequality keeps it within bound)
+				{
+					add_sparse_edge(graph, ru, rv, dist(ru, rv));
+				} else
+				// Otherwise promote the dense Edge itself into the sparse Roadmap
+				{
+					if (!is_guard.at(u))
+					{
+						add_guard(u);
+					}
+					if (!is_guard.at(v))
+					{
+						add_guard(v);
+					}
+					add_sparse_edge(graph, ru, u, dist(ru, u));
+					add_sparse_edge(graph, u, v, dist(u, v));
+					add_sparse_edge(graph, v, rv, dist(v, rv));
+				}
+				components.unite(ru, rv);
+			}
+		}
+
+		// Step 3: Rebuild the Roadmap from the guards. ID = position in vector.
+		std::sort(guards.begin(), guards.end());
+		std::vector<int> new_id(n, -1);
+		for (int i = 0; i < static_cast<int>(guards.size()); i++)
+		{
+			new_id.at(guards.at(i)) = i;
+		}
+
+		std::vector<Vertex> sparse;
+		sparse.reserve(guards.size());
+		int num_edges = 0;
+		for (const auto & g : guards)
+		{
+			Vertex q(configurations.at(g).coords);
+			q.id = new_id.at(g);
+			for (const auto & adj : graph.at(g))
+			{
+				Edge e;
+				e.next_id = new_id.at(adj.first);
+				e.distance = adj.second;
+				q.edges.push_back(e);
+				q.id_set.insert(e.next_id);
+				num_edges++;
+			}
+			sparse.push_back(q);
+		}
+
+		std::cout << "Sparsified Roadmap from " << n << " to " << sparse.size() << " Vertices and "
+				  << num_edges / 2 << " Edges." << std::endl;
+
+		configurations = sparse;
+	}
+
 	bool PRM::edge_valid(const Vertex & q, const Vertex & q_prime, const double & thresh)
 	{
 		// Check if New Edge
@@ -460,7 +800,7 @@ namespace map
 		return shrt;
 	}
 
-	std::vector<Vertex> PRM::return_prm()
+	const std::vector<Vertex> & PRM::return_prm() const
 	{
 		return configurations;
 	}
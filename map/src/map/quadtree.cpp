@@ -0,0 +1,333 @@
+#include "map/quadtree.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace map
+{
+	using rigid2d::Vector2D;
+
+	namespace
+	{
+		// QuadNode types past the CellTypes
+		constexpr uint8_t QUAD_MIXED = 3;
+		constexpr uint8_t QUAD_OUTSIDE = 4;
+	}
+
+	void QuadTree::build_map(const double & resolution_)
+	{
+		resolution = resolution_;
+
+		// Step 1. divide grid into cells based on resolution, exactly like Grid
+		xcells = arange<double>(map_min.x, map_max.x, resolution);
+		ycells = arange<double>(map_min.y, map_max.y, resolution);
+		width = static_cast<int>(xcells.size());
+		height = static_cast<int>(ycells.size());
+
+		// Step 2. Subdivide a power of 2 root quad, merging homogeneous quads on the way back up
+		int root_size = 1;
+		while (root_size < width or root_size < height)
+		{
+			root_size *= 2;
+		}
+		nodes.clear();
+		nodes.push_back(QuadNode{0, 0, root_size, -1, -1, QUAD_MIXED});
+		build_quad(0);
+
+		// Step 3. Number the leaves inside the grid and link the Free ones to their neighbours
+		leaves.clear();
+		int free_leaves = 0;
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			QuadNode & node = nodes.at(i);
+			if (node.first_child == -1 and node.type <= static_cast<uint8_t>(Free))
+			{
+				node.leaf = static_cast<int>(leaves.size());
+				leaves.push_back(QuadLeaf{node.x, node.y, node.size, static_cast<CellType>(node.type), {}});
+				if (node.type == static_cast<uint8_t>(Free))
+				{
+					free_leaves++;
+				}
+			}
+		}
+		for (int id = 0; id < static_cast<int>(leaves.size()); id++)
+		{
+			if (leaves.at(id).celltype == Free)
+			{
+				link_leaf(id);
+			}
+		}
+
+		std::cout << "Quadtree: " << width << "x" << height << " cells in " << leaves.size() << " leaves ("
+				  << free_leaves << " Free)." << std::endl;
+	}
+
+	void QuadTree::build_quad(const int & id)
+	{
+		const int x = nodes.at(id).x;
+		const int y = nodes.at(id).y;
+		const int size = nodes.at(id).size;
+
+		if (x >= width or y >= height)
+		{
+			nodes.at(id).type = QUAD_OUTSIDE;
+			return;
+		}
+
+		// Quads reaching past the grid edge are always split, so leaves never cover cells Grid would not have
+		const bool inside = x + size <= width and y + size <= height;
+		if (inside and !near_obstacle(x, y, size))
+		{
+			nodes.at(id).type = static_cast<uint8_t>(Free);
+			return;
+		} else if (size == 1)
+		{
+			nodes.at(id).type = static_cast<uint8_t>(label_cell(x, y));
+			return;
+		}
+
+		const int half = size / 2;
+		const int first = static_cast<int>(nodes.size());
+		nodes.at(id).first_child = first;
+		nodes.push_back(QuadNode{x, y, half, -1, -1, QUAD_MIXED});
+		nodes.push_back(QuadNode{x + half, y, half, -1, -1, QUAD_MIXED});
+		nodes.push_back(QuadNode{x, y + half, half, -1, -1, QUAD_MIXED});
+		nodes.push_back(QuadNode{x + half, y + half, half, -1, -1, QUAD_MIXED});
+		for (int k = 0; k < 4; k++)
+		{
+			build_quad(first + k);
+		}
+
+		// Merge 4 leaves of the same type. Leaves have no subtrees, so the children are the last nodes.
+		const uint8_t type = nodes.at(first).type;
+		bool merge = type <= static_cast<uint8_t>(Free);
+		for (int k = 0; k < 4; k++)
+		{
+			merge = merge and nodes.at(first + k).first_child == -1 and nodes.at(first + k).type == type;
+		}
+		if (merge)
+		{
+			nodes.resize(first);
+			nodes.at(id).first_child = -1;
+			nodes.at(id).type = type;
+		} else
+		{
+			nodes.at(id).type = QUAD_MIXED;
+		}
+	}
+
+	void QuadTree::link_leaf(const int & id)
+	{
+		const int x = leaves.at(id).x;
+		const int y = leaves.at(id).y;
+		const int size = leaves.at(id).size;
+		std::vector<int> & neighbours = leaves.at(id).neighbours;
+
+		const auto visit = [this, &neighbours](const int & n)
+		{
+			if (leaves.at(n).celltype == Free)
+			{
+				neighbours.push_back(n);
+			}
+		};
+
+		// Rows below and above, corners included. Skip over each neighbour leaf found.
+		for (const int row : {y - 1, y + size})
+		{
+			if (row < 0 or row >= height)
+			{
+				continue;
+			}
+			for (int cx = std::max(x - 1, 0); cx <= std::min(x + size, width - 1);)
+			{
+				const int n = locate(cx, row);
+				visit(n);
+				cx = leaves.at(n).x + leaves.at(n).size;
+			}
+		}
+
+		// Columns left and right
+		for (const int column : {x - 1, x + size})
+		{
+			if (column < 0 or column >= width)
+			{
+				continue;
+			}
+			for (int cy = y; cy < std::min(y + size, height);)
+			{
+				const int n = locate(column, cy);
+				visit(n);
+				cy = leaves.at(n).y + leaves.at(n).size;
+			}
+		}
+
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+	}
+
+	CellType QuadTree::label_cell(const int & x, const int & y) const
+	{
+		const Cell cell(Vector2D(xcells.at(x), ycells.at(y)), resolution);
+
+		// Perform inside-obstacle check for labeling Obstacle
+		if (!not_inside(Vertex(cell.center_coords), obstacles, 0.0))
+		{
+			return Occupied;
+		} else if (!not_inside(Vertex(cell.center_coords), obstacles, inflate_robot))
+		// Perform close-to-obstacle check for labeling Inflation
+		{
+			return Inflation;
+		}
+		return Free;
+	}
+
+	bool QuadTree::near_obstacle(const int & x, const int & y, const int & size) const
+	{
+		// Bounding box of the block's cell centres
+		const int x_last = std::min(width, x + size) - 1;
+		const int y_last = std::min(height, y + size) - 1;
+		const double offset = resolution / 2.0;
+		const double x_min = xcells.at(x) + offset;
+		const double x_max = xcells.at(x_last) + offset;
+		const double y_min = ycells.at(y) + offset;
+		const double y_max = ycells.at(y_last) + offset;
+
+		for (const auto & obs : obstacles)
+		{
+			if (obs.vertices.empty())
+			{
+				continue;
+			}
+
+			// Obstacle bounding box grown by the inflation radius (with margin for the edge distance test)
+			double o_x_min = obs.vertices.front().x;
+			double o_x_max = o_x_min;
+			double o_y_min = obs.vertices.front().y;
+			double o_y_max = o_y_min;
+			for (const auto & v : obs.vertices)
+			{
+				o_x_min = std::min(o_x_min, v.x);
+				o_x_max = std::max(o_x_max, v.x);
+				o_y_min = std::min(o_y_min, v.y);
+				o_y_max = std::max(o_y_max, v.y);
+			}
+			const double margin = inflate_robot + resolution;
+
+			if (x_min <= o_x_max + margin and x_max >= o_x_min - margin and
+				y_min <= o_y_max + margin and y_max >= o_y_min - margin)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int QuadTree::locate(const int & x, const int & y) const
+	{
+		if (!(x >= 0 and x < width and y >= 0 and y < height))
+		{
+			throw std::invalid_argument("cell coordinates out of bounds!\
+										 \n  where(): QuadTree::locate(const int & x, const int & y)");
+		}
+
+		int id = 0;
+		while (nodes[id].first_child != -1)
+		{
+			const int half = nodes[id].size / 2;
+			const int k = (x >= nodes[id].x + half ? 1 : 0) + (y >= nodes[id].y + half ? 2 : 0);
+			id = nodes[id].first_child + k;
+		}
+		return nodes[id].leaf;
+	}
+
+	int QuadTree::world2leaf(const Vector2D & coords) const
+	{
+		// xcells/ycells are evenly spaced, so find the containing cell directly instead of scanning
+		const Cell cell(coords, resolution);
+		int x = -1;
+		int y = -1;
+		if (width > 0 and height > 0)
+		{
+			x = static_cast<int>(std::floor((cell.center_coords.x - xcells.front()) / resolution));
+			y = static_cast<int>(std::floor((cell.center_coords.y - ycells.front()) / resolution));
+		}
+
+		if (!(x >= 0 and x < width and y >= 0 and y < height))
+		{
+			throw std::runtime_error("Could not convert from world to grid coordinates!");
+		}
+		return locate(x, y);
+	}
+
+	CellType QuadTree::celltype(const int & x, const int & y) const
+	{
+		return leaves[locate(x, y)].celltype;
+	}
+
+	Cell QuadTree::return_leaf_cell(const int & id) const
+	{
+		const QuadLeaf & leaf = leaves.at(id);
+		Cell cell(Vector2D(xcells.at(leaf.x), ycells.at(leaf.y)), leaf.size * resolution);
+		cell.celltype = leaf.celltype;
+		cell.index.x = leaf.x;
+		cell.index.y = leaf.y;
+		cell.index.row_major = grid2rowmajor(leaf.x, leaf.y, width);
+		return cell;
+	}
+
+	Vector2D QuadTree::leaf_center(const int & id) const
+	{
+		const QuadLeaf & leaf = leaves.at(id);
+		const double offset = leaf.size * resolution / 2.0;
+		return Vector2D(xcells.at(leaf.x) + offset, ycells.at(leaf.y) + offset);
+	}
+
+	const std::vector<QuadLeaf> & QuadTree::return_leaves() const
+	{
+		return leaves;
+	}
+
+	std::vector<int> QuadTree::return_grid_dimensions() const
+	{
+		return std::vector<int>{width, height};
+	}
+
+	double QuadTree::return_resolution() const
+	{
+		return resolution;
+	}
+
+	Vector2D QuadTree::return_origin() const
+	{
+		if (width == 0 or height == 0)
+		{
+			return Vector2D();
+		}
+		return Vector2D(xcells.front(), ycells.front());
+	}
+
+	void QuadTree::occupancy_grid(std::vector<int8_t> & map) const
+	{
+		map.resize(static_cast<size_t>(width) * height);
+
+		for (const auto & leaf : leaves)
+		{
+			// For each cell type, assign a value to map
+			int8_t value = 0;
+			if (leaf.celltype == Inflation)
+			{
+				value = 50;
+			} else if (leaf.celltype == Occupied)
+			{
+				value = 100;
+			}
+
+			for (int y = leaf.y; y < leaf.y + leaf.size; y++)
+			{
+				for (int x = leaf.x; x < leaf.x + leaf.size; x++)
+				{
+					map.at(grid2rowmajor(x, y, width)) = value;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,268 @@
+#include "map/snapshot.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace map
+{
+	using rigid2d::Vector2D;
+
+	// GridSnapshot
+	uint64_t GridSnapshot::return_epoch() const
+	{
+		return epoch;
+	}
+
+	std::vector<int> GridSnapshot::return_grid_dimensions() const
+	{
+		return std::vector<int>{width, height};
+	}
+
+	double GridSnapshot::return_resolution() const
+	{
+		return resolution;
+	}
+
+	Vector2D GridSnapshot::return_origin() const
+	{
+		if (width == 0 or height == 0)
+		{
+			return Vector2D();
+		}
+		return Vector2D(xcells->front(), ycells->front());
+	}
+
+	Cell GridSnapshot::return_cell(const int & x, const int & y) const
+	{
+		if (!(x >= 0 and x < width and y >= 0 and y < height))
+		{
+			throw std::invalid_argument("cell coordinates out of bounds!\
+										 \n  where(): GridSnapshot::return_cell(const int & x, const int & y)");
+		}
+		Cell cell(Vector2D(xcells->at(x), ycells->at(y)), resolution);
+		cell.celltype = celltype(x, y);
+		cell.index.x = x;
+		cell.index.y = y;
+		cell.index.row_major = grid2rowmajor(x, y, width);
+		return cell;
+	}
+
+	Index GridSnapshot::world2grid(const Cell & cell) const
+	{
+		// xcells/ycells are evenly spaced, so find the containing cell directly instead of scanning
+		Index index;
+		if (width > 0 and height > 0)
+		{
+			index.x = static_cast<int>(std::floor((cell.center_coords.x - xcells->front()) / resolution));
+			index.y = static_cast<int>(std::floor((cell.center_coords.y - ycells->front()) / resolution));
+		}
+
+		if (!(index.x >= 0 and index.x < width and index.y >= 0 and index.y < height))
+		{
+			throw std::runtime_error("Could not convert from world to grid coordinates!");
+		}
+
+		index.row_major = grid2rowmajor(index.x, index.y, width);
+		return index;
+	}
+
+	void GridSnapshot::occupancy_grid(std::vector<int8_t> & map) const
+	{
+		map.resize(static_cast<size_t>(width) * height);
+
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				// For each cell type, assign a value to map
+				const CellType type = celltype(x, y);
+				const int i = grid2rowmajor(x, y, width);
+				if (type == Free)
+				{
+					map.at(i) = 0;
+				} else if (type == Inflation)
+				{
+					map.at(i) = 50;
+				} else if (type == Occupied)
+				{
+					map.at(i) = 100;
+				}
+			}
+		}
+	}
+
+	int GridSnapshot::shared_tiles(const GridSnapshot & other) const
+	{
+		int shared = 0;
+		for (size_t i = 0; i < tiles.size() and i < other.tiles.size(); i++)
+		{
+			if (tiles.at(i) == other.tiles.at(i))
+			{
+				shared++;
+			}
+		}
+		return shared;
+	}
+
+	std::vector<Cell> GridSnapshot::changes_since(const GridSnapshot & older) const
+	{
+		if (older.width != width or older.height != height)
+		{
+			throw std::invalid_argument("snapshots of different grids!\
+										 \n  where(): GridSnapshot::changes_since(const GridSnapshot & older)");
+		}
+
+		std::vector<Cell> changes;
+		for (size_t t = 0; t < tiles.size(); t++)
+		{
+			// Tiles untouched by every commit in between are still shared
+			if (tiles.at(t) == older.tiles.at(t))
+			{
+				continue;
+			}
+
+			const int x0 = static_cast<int>(t % tiles_x) * SNAPSHOT_TILE_SIZE;
+			const int y0 = static_cast<int>(t / tiles_x) * SNAPSHOT_TILE_SIZE;
+			for (int y = y0; y < std::min(y0 + SNAPSHOT_TILE_SIZE, height); y++)
+			{
+				for (int x = x0; x < std::min(x0 + SNAPSHOT_TILE_SIZE, width); x++)
+				{
+					if (celltype(x, y) != older.celltype(x, y))
+					{
+						Cell cell = return_cell(x, y);
+						cell.newView = true;
+						changes.push_back(cell);
+					}
+				}
+			}
+		}
+		return changes;
+	}
+
+	// VersionedGrid
+	VersionedGrid::VersionedGrid(const Grid & grid) : VersionedGrid(grid, grid.return_grid()) {}
+
+	VersionedGrid::VersionedGrid(const Grid & grid, const std::vector<Cell> & cells)
+	{
+		auto first = std::make_shared<GridSnapshot>();
+
+		const auto dims = grid.return_grid_dimensions();
+		first->width = dims.at(0);
+		first->height = dims.at(1);
+		if (cells.size() != static_cast<size_t>(first->width) * first->height)
+		{
+			throw std::invalid_argument("one cell type per grid cell needed!\
+										 \n  where(): VersionedGrid::VersionedGrid(const Grid & grid, const std::vector<Cell> & cells)");
+		}
+		first->tiles_x = (first->width + SNAPSHOT_TILE_SIZE - 1) / SNAPSHOT_TILE_SIZE;
+		const int tiles_y = (first->height + SNAPSHOT_TILE_SIZE - 1) / SNAPSHOT_TILE_SIZE;
+		first->resolution = grid.return_grid().empty() ? 0.0 : grid.return_grid().front().resolution;
+
+		// Cell corner coordinates: first row gives x, first column gives y
+		auto xs = std::make_shared<std::vector<double>>(first->width);
+		auto ys = std::make_shared<std::vector<double>>(first->height);
+		for (int x = 0; x < first->width; x++)
+		{
+			xs->at(x) = grid.return_cell(x, 0).coords.x;
+		}
+		for (int y = 0; y < first->height; y++)
+		{
+			ys->at(y) = grid.return_cell(0, y).coords.y;
+		}
+		first->xcells = xs;
+		first->ycells = ys;
+
+		first->tiles.reserve(static_cast<size_t>(first->tiles_x) * tiles_y);
+		for (int ty = 0; ty < tiles_y; ty++)
+		{
+			for (int tx = 0; tx < first->tiles_x; tx++)
+			{
+				// Cells past the grid edge are never read, mark them Occupied
+				auto tile = std::make_shared<GridTile>();
+				tile->types.fill(static_cast<uint8_t>(Occupied));
+				for (int j = 0; j < SNAPSHOT_TILE_SIZE; j++)
+				{
+					const int y = ty * SNAPSHOT_TILE_SIZE + j;
+					for (int i = 0; i < SNAPSHOT_TILE_SIZE; i++)
+					{
+						const int x = tx * SNAPSHOT_TILE_SIZE + i;
+						if (x < first->width and y < first->height)
+						{
+							tile->types.at(j * SNAPSHOT_TILE_SIZE + i) =
+								static_cast<uint8_t>(cells.at(grid2rowmajor(x, y, first->width)).celltype);
+						}
+					}
+				}
+				first->tiles.push_back(tile);
+			}
+		}
+
+		current = first;
+	}
+
+	std::shared_ptr<const GridSnapshot> VersionedGrid::snapshot() const
+	{
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		return current;
+	}
+
+	uint64_t VersionedGrid::commit(const std::vector<Cell> & changes)
+	{
+		std::lock_guard<std::mutex> writer_lock(writer_mutex);
+
+		// Only commit changes current, so it can be read without snapshot_mutex here
+		const GridSnapshot & base = *current;
+
+		// Copy of the tile table: every tile is still shared with base
+		auto next = std::make_shared<GridSnapshot>(base);
+		next->epoch = base.epoch + 1;
+
+		// Tiles copied by this commit, indexed like tiles
+		std::vector<std::shared_ptr<GridTile>> copied(base.tiles.size());
+		bool modified = false;
+
+		for (const auto & cell : changes)
+		{
+			const int x = cell.index.x;
+			const int y = cell.index.y;
+			if (!(x >= 0 and x < base.width and y >= 0 and y < base.height))
+			{
+				throw std::invalid_argument("cell coordinates out of bounds!\
+											 \n  where(): VersionedGrid::commit(const std::vector<Cell> & changes)");
+			}
+			const int t = (y / SNAPSHOT_TILE_SIZE) * base.tiles_x + x / SNAPSHOT_TILE_SIZE;
+			const int offset = (y % SNAPSHOT_TILE_SIZE) * SNAPSHOT_TILE_SIZE + x % SNAPSHOT_TILE_SIZE;
+			const uint8_t type = static_cast<uint8_t>(cell.celltype);
+
+			// Skip writes that do not change the cell, so untouched tiles stay shared
+			const GridTile & tile = copied.at(t) ? *copied.at(t) : *base.tiles.at(t);
+			if (tile.types.at(offset) == type)
+			{
+				continue;
+			}
+
+			if (!copied.at(t))
+			{
+				// Copy-on-write: first write to this tile in the commit
+				copied.at(t) = std::make_shared<GridTile>(*base.tiles.at(t));
+				next->tiles.at(t) = copied.at(t);
+			}
+			copied.at(t)->types.at(offset) = type;
+			modified = true;
+		}
+
+		if (!modified)
+		{
+			return base.epoch;
+		}
+
+		// Readers holding base keep it alive; new readers get next
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		current = next;
+		return next->epoch;
+	}
+
+	uint64_t VersionedGrid::return_epoch() const
+	{
+		return snapshot()->return_epoch();
+	}
+}
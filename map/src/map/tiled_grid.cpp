@@ -0,0 +1,274 @@
+#include "map/tiled_grid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace map
+{
+	using rigid2d::Vector2D;
+
+	void TiledGrid::build_map(const double & resolution_)
+	{
+		resolution = resolution_;
+
+		// Step 1. divide grid into cells based on resolution, exactly like Grid
+		xcells = arange<double>(map_min.x, map_max.x, resolution);
+		ycells = arange<double>(map_min.y, map_max.y, resolution);
+		width = static_cast<int>(xcells.size());
+		height = static_cast<int>(ycells.size());
+
+		tiles_x = (width + TILED_GRID_MASK) >> TILED_GRID_SHIFT;
+		const int tiles_y = (height + TILED_GRID_MASK) >> TILED_GRID_SHIFT;
+		tiles.clear();
+		tiles.resize(static_cast<size_t>(tiles_x) * tiles_y);
+
+		// Step 2. Only label tiles that an obstacle can reach, the rest stay uniformly Free
+		std::array<uint8_t, TILED_GRID_TILE_SIZE * TILED_GRID_TILE_SIZE> labels;
+		for (int ty = 0; ty < tiles_y; ty++)
+		{
+			for (int tx = 0; tx < tiles_x; tx++)
+			{
+				if (!near_obstacle(tx, ty))
+				{
+					continue;
+				}
+
+				// Cells past the grid edge are never read, copy a real label so they do not break uniformity
+				const int x_end = std::min(width, (tx + 1) * TILED_GRID_TILE_SIZE);
+				const int y_end = std::min(height, (ty + 1) * TILED_GRID_TILE_SIZE);
+				const uint8_t first = static_cast<uint8_t>(label_cell(tx * TILED_GRID_TILE_SIZE, ty * TILED_GRID_TILE_SIZE));
+				labels.fill(first);
+				bool uniform = true;
+
+				for (int y = ty * TILED_GRID_TILE_SIZE; y < y_end; y++)
+				{
+					for (int x = tx * TILED_GRID_TILE_SIZE; x < x_end; x++)
+					{
+						const uint8_t type = static_cast<uint8_t>(label_cell(x, y));
+						labels[((y & TILED_GRID_MASK) << TILED_GRID_SHIFT) | (x & TILED_GRID_MASK)] = type;
+						uniform = uniform and type == first;
+					}
+				}
+
+				GridTileStorage & tile = tiles.at(ty * tiles_x + tx);
+				tile.uniform = first;
+				if (!uniform)
+				{
+					tile.cells.reset(new std::array<uint8_t, TILED_GRID_TILE_SIZE * TILED_GRID_TILE_SIZE>(labels));
+				}
+			}
+		}
+
+		std::cout << "Tiled Grid: " << width << "x" << height << " cells, " << return_allocated_tiles()
+				  << " of " << return_total_tiles() << " tiles allocated." << std::endl;
+	}
+
+	CellType TiledGrid::label_cell(const int & x, const int & y) const
+	{
+		const Cell cell(Vector2D(xcells.at(x), ycells.at(y)), resolution);
+
+		// Perform inside-obstacle check for labeling Obstacle
+		if (!not_inside(Vertex(cell.center_coords), obstacles, 0.0))
+		{
+			return Occupied;
+		} else if (!not_inside(Vertex(cell.center_coords), obstacles, inflate_robot))
+		// Perform close-to-obstacle check for labeling Inflation
+		{
+			return Inflation;
+		}
+		return Free;
+	}
+
+	bool TiledGrid::near_obstacle(const int & tx, const int & ty) const
+	{
+		// Bounding box of the tile's cell centres
+		const int x_last = std::min(width, (tx + 1) * TILED_GRID_TILE_SIZE) - 1;
+		const int y_last = std::min(height, (ty + 1) * TILED_GRID_TILE_SIZE) - 1;
+		const double offset = resolution / 2.0;
+		const double x_min = xcells.at(tx * TILED_GRID_TILE_SIZE) + offset;
+		const double x_max = xcells.at(x_last) + offset;
+		const double y_min = ycells.at(ty * TILED_GRID_TILE_SIZE) + offset;
+		const double y_max = ycells.at(y_last) + offset;
+
+		for (const auto & obs : obstacles)
+		{
+			if (obs.vertices.empty())
+			{
+				continue;
+			}
+
+			// Obstacle bounding box grown by the inflation radius (with margin for the edge distance test)
+			double o_x_min = obs.vertices.front().x;
+			double o_x_max = o_x_min;
+			double o_y_min = obs.vertices.front().y;
+			double o_y_max = o_y_min;
+			for (const auto & v : obs.vertices)
+			{
+				o_x_min = std::min(o_x_min, v.x);
+				o_x_max = std::max(o_x_max, v.x);
+				o_y_min = std::min(o_y_min, v.y);
+				o_y_max = std::max(o_y_max, v.y);
+			}
+			const double margin = inflate_robot + resolution;
+
+			if (x_min <= o_x_max + margin and x_max >= o_x_min - margin and
+				y_min <= o_y_max + margin and y_max >= o_y_min - margin)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void TiledGrid::set_celltype(const int & x, const int & y, const CellType & type)
+	{
+		if (!(x >= 0 and x < width and y >= 0 and y < height))
+		{
+			throw std::invalid_argument("cell coordinates out of bounds!\
+										 \n  where(): TiledGrid::set_celltype(const int & x, const int & y, const CellType & type)");
+		}
+
+		GridTileStorage & tile = tiles[(y >> TILED_GRID_SHIFT) * tiles_x + (x >> TILED_GRID_SHIFT)];
+		if (!tile.cells)
+		{
+			if (tile.uniform == static_cast<uint8_t>(type))
+			{
+				return;
+			}
+			// Split the uniform tile on first write
+			tile.cells.reset(new std::array<uint8_t, TILED_GRID_TILE_SIZE * TILED_GRID_TILE_SIZE>());
+			tile.cells->fill(tile.uniform);
+		}
+		(*tile.cells)[((y & TILED_GRID_MASK) << TILED_GRID_SHIFT) | (x & TILED_GRID_MASK)] = static_cast<uint8_t>(type);
+	}
+
+	Cell TiledGrid::return_cell(const int & x, const int & y) const
+	{
+		if (!(x >= 0 and x < width and y >= 0 and y < height))
+		{
+			throw std::invalid_argument("cell coordinates out of bounds!\
+										 \n  where(): TiledGrid::return_cell(const int & x, const int & y)");
+		}
+		Cell cell(Vector2D(xcells.at(x), ycells.at(y)), resolution);
+		cell.celltype = celltype(x, y);
+		cell.index.x = x;
+		cell.index.y = y;
+		cell.index.row_major = grid2rowmajor(x, y, width);
+		return cell;
+	}
+
+	Index TiledGrid::world2grid(const Cell & cell) const
+	{
+		// xcells/ycells are evenly spaced, so find the containing cell directly instead of scanning
+		Index index;
+		if (width > 0 and height > 0)
+		{
+			index.x = static_cast<int>(std::floor((cell.center_coords.x - xcells.front()) / resolution));
+			index.y = static_cast<int>(std::floor((cell.center_coords.y - ycells.front()) / resolution));
+		}
+
+		if (!(index.x >= 0 and index.x < width and index.y >= 0 and index.y < height))
+		{
+			throw std::runtime_error("Could not convert from world to grid coordinates!");
+		}
+
+		index.row_major = grid2rowmajor(index.x, index.y, width);
+		return index;
+	}
+
+	std::vector<int> TiledGrid::return_grid_dimensions() const
+	{
+		return std::vector<int>{width, height};
+	}
+
+	double TiledGrid::return_resolution() const
+	{
+		return resolution;
+	}
+
+	Vector2D TiledGrid::return_origin() const
+	{
+		if (width == 0 or height == 0)
+		{
+			return Vector2D();
+		}
+		return Vector2D(xcells.front(), ycells.front());
+	}
+
+	void TiledGrid::occupancy_grid(std::vector<int8_t> & map, const int & scale) const
+	{
+		if (scale < 1)
+		{
+			throw std::invalid_argument("scale must be at least 1!\
+										 \n  where(): TiledGrid::occupancy_grid(std::vector<int8_t> & map, const int & scale)");
+		}
+
+		const int map_width = (width + scale - 1) / scale;
+		const int map_height = (height + scale - 1) / scale;
+		map.assign(static_cast<size_t>(map_width) * map_height, 0);
+
+		// Free is 0, Inflation 50 and Occupied 100, so the worst type covered is the largest value
+		const auto value = [](const uint8_t & type) -> int8_t
+		{
+			if (type == Inflation)
+			{
+				return 50;
+			} else if (type == Occupied)
+			{
+				return 100;
+			}
+			return 0;
+		};
+
+		const int tiles_y = tiles_x > 0 ? static_cast<int>(tiles.size()) / tiles_x : 0;
+		for (int ty = 0; ty < tiles_y; ty++)
+		{
+			for (int tx = 0; tx < tiles_x; tx++)
+			{
+				const GridTileStorage & tile = tiles[ty * tiles_x + tx];
+				const int x0 = tx << TILED_GRID_SHIFT;
+				const int y0 = ty << TILED_GRID_SHIFT;
+				const int x1 = std::min(x0 + TILED_GRID_TILE_SIZE, width);
+				const int y1 = std::min(y0 + TILED_GRID_TILE_SIZE, height);
+
+				if (!tile.cells)
+				{
+					const int8_t v = value(tile.uniform);
+					if (v == 0)
+					{
+						continue;
+					}
+					for (int my = y0 / scale; my <= (y1 - 1) / scale; my++)
+					{
+						for (int mx = x0 / scale; mx <= (x1 - 1) / scale; mx++)
+						{
+							int8_t & m = map[grid2rowmajor(mx, my, map_width)];
+							m = std::max(m, v);
+						}
+					}
+					continue;
+				}
+
+				for (int y = y0; y < y1; y++)
+				{
+					for (int x = x0; x < x1; x++)
+					{
+						const int8_t v = value((*tile.cells)[((y & TILED_GRID_MASK) << TILED_GRID_SHIFT) | (x & TILED_GRID_MASK)]);
+						int8_t & m = map[grid2rowmajor(x / scale, y / scale, map_width)];
+						m = std::max(m, v);
+					}
+				}
+			}
+		}
+	}
+
+	int TiledGrid::return_allocated_tiles() const
+	{
+		return static_cast<int>(std::count_if(tiles.begin(), tiles.end(),
+											  [](const GridTileStorage & tile) { return tile.cells != nullptr; }));
+	}
+
+	int TiledGrid::return_total_tiles() const
+	{
+		return static_cast<int>(tiles.size());
+	}
+}
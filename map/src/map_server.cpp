@@ -0,0 +1,120 @@
+/// \file
+/// \brief Builds a Grid once and publishes it into POSIX shared memory, so that planner
+/// processes on this host can attach to it (map::GridView) instead of building their own copy.
+///
+/// PARAMETERS:
+///   obstacles (XmlRpc): triple-nested obstacle list
+///   inflate (double): robot inflation radius
+///   resolution (double): grid cell size
+///   scale (double): obstacle coordinate scale
+///   cache_dir (string): directory for cached Grid artifacts (empty disables the cache)
+///   shm_name (string): name of the shared memory object holding the Grid snapshot
+/// PUBLISHES:
+/// SUBSCRIBES:
+/// FUNCTIONS:
+
+#include <ros/ros.h>
+#include <ros/console.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+#include "map/grid.hpp"
+#include "map/grid_view.hpp"
+
+using rigid2d::Vector2D;
+
+int main(int argc, char** argv)
+{
+  ROS_INFO("STARTING NODE: map_server");
+
+  // Vars
+  double frequency = 1.0;
+  double resolution = 0.01;
+  XmlRpc::XmlRpcValue xml_obstacles;
+
+  // Grid Parameters
+  double inflate = 0.1;
+  double SCALE = 10.0;
+  std::string cache_dir = "";
+  std::string shm_name = "/planning_grid";
+
+  // store Obstacle(s) here to create Map
+  std::vector<map::Obstacle> obstacles_v;
+
+  ros::init(argc, argv, "map_server_node"); // register the node on ROS
+  ros::NodeHandle nh; // get a handle to ROS
+  ros::NodeHandle nh_("~"); // get a handle to ROS
+  // Parameters
+  nh_.getParam("frequency", frequency);
+  nh_.getParam("obstacles", xml_obstacles);
+  nh_.getParam("inflate", inflate);
+  nh_.getParam("resolution", resolution);
+  nh_.getParam("scale", SCALE);
+  nh_.getParam("cache_dir", cache_dir);
+  nh_.getParam("shm_name", shm_name);
+
+  // 'obstacles' is a triple-nested list.
+  // 1st level: obstacle (Obstacle), 2nd level: vertices (std::vector), 3rd level: coordinates (Vector2D)
+
+  // std::vector<Obstacle>
+  if(xml_obstacles.getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    ROS_ERROR("There is no list of obstacles");
+  } else {
+    for(int i = 0; i < xml_obstacles.size(); ++i)
+    {
+      // Obstacle contains std::vector<Vector2D>
+      // create Obstacle with empty vertex vector
+      map::Obstacle obs;
+      if(xml_obstacles[i].getType() != XmlRpc::XmlRpcValue::TypeArray)
+      {
+          ROS_ERROR("obstacles[%d] has no vertices", i);
+      } else {
+          for(int j = 0; j < xml_obstacles[i].size(); ++j)
+          {
+            // Vector2D contains x,y coords
+            if(xml_obstacles[i][j].size() != 2)
+            {
+               ROS_ERROR("Vertex[%d] of obstacles[%d] is not a pair of coordinates", j, i);
+            } else if(
+              xml_obstacles[i][j][0].getType() != XmlRpc::XmlRpcValue::TypeDouble or
+              xml_obstacles[i][j][1].getType() != XmlRpc::XmlRpcValue::TypeDouble)
+            {
+              ROS_ERROR("The coordinates of vertex[%d] of obstacles[%d] are not doubles", j, i);
+            } else {
+              // PASSED ALL THE TESTS: push Vector2D to vertices list in Obstacle object
+              rigid2d::Vector2D vertex(xml_obstacles[i][j][0], xml_obstacles[i][j][1]);
+              // NOTE: SCALE DOWN
+              vertex.x /= SCALE;
+              vertex.y /= SCALE;
+              obs.vertices.push_back(vertex);
+            }
+          }
+      }
+      // push Obstacle object to vector of Object(s) in Map
+      obstacles_v.push_back(obs);
+    }
+  }
+
+  // Initialize Grid
+  map::Grid grid(obstacles_v, inflate);
+
+  // Build Map
+  grid.build_map(resolution, cache_dir);
+
+  ROS_INFO("Grid Built!");
+
+  // Publish the immutable snapshot. It stays alive (and attached planners keep working) until this node exits.
+  map::GridServer server(shm_name, grid);
+
+  ROS_INFO("Serving Grid in shared memory: %s", shm_name.c_str());
+
+  ros::Rate rate(frequency);
+
+  while(ros::ok())
+  {
+    ros::spinOnce();
+    rate.sleep();
+  }
+
+  return 0;
+}
@@ -32,6 +32,8 @@ int main(int argc, char** argv)
   double inflate = 0.1;
   double SCALE = 10.0;
   std::string map_type = "grid_map";
+  // Directory for cached Grid/PRM artifacts (empty disables the cache)
+  std::string cache_dir = "";
 
   // store Obstacle(s) here to create Map
   std::vector<map::Obstacle> obstacles_v;
@@ -46,6 +48,7 @@ int main(int argc, char** argv)
   nh_.getParam("inflate", inflate);
   nh_.getParam("resolution", resolution);
   nh_.getParam("scale", SCALE);
+  nh_.getParam("cache_dir", cache_dir);
 
   ros::Publisher grid_pub = nh.advertise<nav_msgs::OccupancyGrid>("grid_map", 1);
 
@@ -97,7 +100,7 @@ int main(int argc, char** argv)
   map::Grid grid(obstacles_v, inflate);
 
   // Build Map
-  grid.build_map(resolution);
+  grid.build_map(resolution, cache_dir);
 
   ROS_INFO("Grid Built!");
 
@@ -44,6 +44,8 @@ int main(int argc, char** argv)
   double thresh = 0.01;
   double inflate = 0.1;
   std::string map_type = "map";
+  // Directory for cached Grid/PRM artifacts (empty disables the cache)
+  std::string cache_dir = "";
 
   // store Obstacle(s) here to create Map
   std::vector<map::Obstacle> obstacles_v;
@@ -61,6 +63,7 @@ int main(int argc, char** argv)
   nh_.getParam("inflate", inflate);
   nh_.getParam("map_type", map_type);
   nh_.getParam("scale", SCALE);
+  nh_.getParam("cache_dir", cache_dir);
 
   // 'obstacles' is a triple-nested list.
   // 1st level: obstacle (Obstacle), 2nd level: vertices (std::vector), 3rd level: coordinates (Vector2D)
@@ -206,9 +209,9 @@ int main(int argc, char** argv)
   {
     // Build PRM
     map::PRM prm(obstacles_v, inflate);
-    prm.build_map(n, k, thresh);
+    prm.build_map(n, k, thresh, cache_dir);
     // DRAW PRM
-    auto configurations = prm.return_prm();
+    const auto & configurations = prm.return_prm();
     for (auto node_iter = configurations.begin(); node_iter != configurations.end(); node_iter++)
     {
       marker.points.clear();
@@ -228,7 +231,7 @@ int main(int argc, char** argv)
           marker.points.push_back(first_vertex);
 
           // Find Vertex for each ID
-          auto neighbor_iter = configurations.at(*id_iter);
+          const auto & neighbor_iter = configurations.at(*id_iter);
 
           geometry_msgs::Point new_vertex;
           new_vertex.x = neighbor_iter.coords.x;